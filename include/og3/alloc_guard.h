@@ -0,0 +1,88 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The guard needs the allocator hook of HeapStats on native builds.
+#if defined(OG3_ALLOC_GUARD) && !defined(OG3_ALLOC_HOOK)
+#define OG3_ALLOC_HOOK
+#endif
+
+namespace og3 {
+
+class ModuleSystem;
+
+/**
+ * @brief Attributes heap allocations made by the loop after setup to modules and tasks.
+ *
+ * Allocations in loop() fragment the heap of long-running devices. Build with
+ * `-DOG3_ALLOC_GUARD` to have App::setup() arm the guard once modules have started.
+ * From then on, every allocation on the loop thread is counted against the module
+ * update function or task ID running at the time (see DispatchTrace), and logged or
+ * treated as fatal depending on the Action.
+ *
+ * Allocations are seen through the native allocator hook of HeapStats, or on ESP32
+ * through the heap hooks of ESP-IDF, which need CONFIG_HEAP_USE_HOOKS. ESP8266 has no
+ * allocator hook, so there the guard counts nothing. Other threads, such as Executor
+ * workers, are not tracked.
+ *
+ * Without OG3_ALLOC_GUARD nothing calls onAlloc(), and the guard costs nothing.
+ */
+class AllocGuard {
+ public:
+  /** @brief What to do on each allocation after setup. */
+  enum class Action {
+    kCount,  ///< Only count it.
+    kLog,    ///< Count it and log where it happened.
+    kAbort,  ///< Log where it happened, then abort().
+  };
+
+  /** @brief Allocations made by the tasks with one task ID. */
+  struct TaskAllocs {
+    unsigned id;     ///< Task ID (0 for tasks scheduled without one).
+    uint32_t count;  ///< Allocations.
+  };
+
+  /** @brief Number of task IDs counted separately; others share the last entry. */
+  static constexpr std::size_t kMaxTaskIds = 32;
+
+  /**
+   * @brief Starts attributing allocations on the calling (loop) thread, and resets counts.
+   * @param module_system The module system whose dispatch trace names the culprit.
+   */
+  static void arm(ModuleSystem* module_system);
+  /** @brief Stops tracking allocations; the counts are kept. */
+  static void disarm();
+  /** @return true if allocations are being tracked. */
+  static bool armed();
+
+  /** @brief Sets what to do on each allocation (default kLog). */
+  static void setAction(Action action);
+
+  /**
+   * @brief Called by the allocator hook for each allocation.
+   * @param bytes Size of the allocation.
+   */
+  static void onAlloc(std::size_t bytes);
+
+  /** @return Allocations counted since arm(). */
+  static uint32_t total();
+  /** @return Allocations in update functions of the module with the given sorted index. */
+  static uint32_t moduleAllocs(std::size_t sorted_idx);
+  /** @return Allocations while no update function or task was running. */
+  static uint32_t loopAllocs();
+  /** @return Allocations by task ID, in the order the IDs were first seen. */
+  static const std::vector<TaskAllocs>& taskAllocs();
+
+  /**
+   * @brief Logs the allocations of each module and task ID which allocated.
+   * @param num_loops Loop iterations since arm(), to report allocations per loop.
+   */
+  static void logReport(unsigned long num_loops);
+};
+
+}  // namespace og3
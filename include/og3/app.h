@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "og3/alloc_guard.h"
 #include "og3/compiler_definitions.h"
 #include "og3/logger.h"
 #include "og3/module_system.h"
@@ -36,6 +37,11 @@ class App {
     unsigned reserve_tasks = 16;        ///< @brief Initial capacity for scheduled tasks.
     LogType log_type = LogType::kNone;  ///< @brief The type of logger to use.
     String board_name;                  ///< @brief The name of the board/device.
+    unsigned max_idle_msec = 0;         ///< @brief Max sleep in loop() (0: never).
+    unsigned long loop_budget_usec = 0;  ///< @brief Time budget for tasks and updates (0: none).
+    unsigned max_tasks_per_loop = 0;     ///< @brief Max timed tasks per loop (0: no limit).
+    bool loop_stats = false;             ///< @brief Record loop rate and iteration times.
+    unsigned init_workers = 0;           ///< @brief Threads for module init (0: sequential).
 
     /**
      * @brief Sets the initial capacity for the module system.
@@ -64,6 +70,57 @@ class App {
       this->log_type = val;
       return *this;
     }
+    /**
+     * @brief Enables sleeping in loop() until the next task is due.
+     *
+     * Module update functions are only called when loop() wakes, so this bounds
+     * how long polled work (e.g. OTA, DNS in AP mode) may wait.
+     * @param val The longest time to sleep in one loop, or 0 to never sleep.
+     * @return Reference to this Options object for chaining.
+     */
+    Options& withMaxIdleMsec(unsigned val) {
+      this->max_idle_msec = val;
+      return *this;
+    }
+    /**
+     * @brief Bounds the work done by one loop() during bursts of due tasks.
+     *
+     * Tasks::loop() and ModuleSystem::update() each stop after usec microseconds,
+     * and Tasks::loop() after max_tasks tasks, leaving the rest for the next loop.
+     * This keeps polled work such as OTA and DNS responsive after, e.g., a reconnect.
+     * @param usec Time budget in microseconds for each of tasks and updates (0: none).
+     * @param max_tasks Maximum number of timed tasks per loop (0: no limit).
+     * @return Reference to this Options object for chaining.
+     */
+    Options& withLoopBudget(unsigned long usec, unsigned max_tasks = 0) {
+      this->loop_budget_usec = usec;
+      this->max_tasks_per_loop = max_tasks;
+      return *this;
+    }
+    /**
+     * @brief Initializes independent modules concurrently during setup().
+     *
+     * Only modules which opt in with Module::set_concurrent_init() are initialized
+     * concurrently; see ModuleSystem::set_parallel_init().
+     * @param num_workers Number of threads to run init functions on (0 or 1: sequential).
+     * @return Reference to this Options object for chaining.
+     */
+    Options& withParallelInit(unsigned num_workers) {
+      this->init_workers = num_workers;
+      return *this;
+    }
+
+    /**
+     * @brief Records the loop rate, iteration times, and time in module updates and tasks.
+     *
+     * See LoopStats. AppStatus publishes the summary.
+     * @param val true to record loop statistics.
+     * @return Reference to this Options object for chaining.
+     */
+    Options& withLoopStats(bool val = true) {
+      this->loop_stats = val;
+      return *this;
+    }
   };
 
   /**
@@ -71,22 +128,46 @@ class App {
    * @param options Configuration options for the App.
    */
   explicit App(const Options& options);
+#ifdef OG3_ALLOC_GUARD
+  /** @brief Stops tracking allocations, since the guard refers to the ModuleSystem. */
+  ~App() { AllocGuard::disarm(); }
+#endif
 
   /**
    * @brief Initializes the application by setting up the module system.
    *
    * This method should be called once in the Arduino `setup()` function.
+   * With OG3_ALLOC_GUARD, allocations by the loop are tracked from then on (see AllocGuard).
    */
-  void setup() { m_module_system.setup(); }
+  void setup() {
+    m_module_system.setup();
+#ifdef OG3_ALLOC_GUARD
+    AllocGuard::arm(&m_module_system);
+#endif
+  }
 
   /**
    * @brief Runs the main application loop, updating modules and processing tasks.
    *
    * This method should be called repeatedly in the Arduino `loop()` function.
+   * Timed tasks run from the update function of the Tasks module.
+   * If Options::max_idle_msec is set, it then sleeps until the next task is due,
+   * an interrupt event is posted, or Tasks::wake() is called.
+   * With Options::loop_stats, the time of each iteration, not counting the sleep, is
+   * recorded in Tasks::loopStats().
    */
   void loop() {
-    m_module_system.update();
-    m_tasks.loop();
+    LoopStats& loop_stats = m_tasks.loopStats();
+    if (loop_stats.enabled()) {
+      const unsigned long start_usec = micros();
+      m_module_system.update();
+      loop_stats.record(micros() - start_usec);
+    } else {
+      m_module_system.update();
+    }
+    if (m_options.max_idle_msec > 0) {
+      m_tasks.idle(m_options.max_idle_msec);
+    }
   }
 
   /**
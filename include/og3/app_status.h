@@ -5,6 +5,7 @@
 
 #include "og3/app.h"
 #include "og3/compiler_definitions.h"
+#include "og3/heap_stats.h"
 #include "og3/module.h"
 #include "og3/tasks.h"
 #include "og3/variable.h"
@@ -14,10 +15,20 @@ class NetRequest;
 namespace og3 {
 
 class MqttManager;
+class StallWatchdog;
 
 /**
  * @brief A module which sends basic application status (memory available, uptime)
  * via MQTT every couple minutes.
+ *
+ * Memory status comes from HeapStats: free heap, largest free block, fragmentation,
+ * lowest free heap since boot, free loop stack, and allocation counts. If
+ * Tasks::loopStats() is enabled, it also publishes the loop rate and iteration times.
+ *
+ * When built with OG3_TASK_STATS, it also publishes the task lateness and
+ * run-time summary from Tasks::stats(). When built with OG3_MODULE_PROFILE, it
+ * publishes the module timing summary from ModuleSystem::profile(). If the app has a
+ * StallWatchdog, its stall report is sent too.
  */
 class AppStatus : public Module {
  public:
@@ -50,14 +61,24 @@ class AppStatus : public Module {
 
   Tasks* const m_tasks;
   VariableGroup m_vg;
+  HeapStats m_heap;
   FloatVariable m_mem_available;
+  FloatVariable m_mem_largest_block;
+  FloatVariable m_mem_min_available;
+  Variable<unsigned> m_mem_fragmentation;
+  Variable<unsigned> m_stack_free;
+  Variable<unsigned> m_num_allocs;  // Allocated blocks on ESP32.
+  Variable<unsigned> m_num_frees;   // Free blocks on ESP32.
   Variable<unsigned> m_uptime_msec;
   Variable<unsigned> m_num_tasks;
   Variable<unsigned> m_task_capacity;
   Variable<unsigned> m_num_modules;
   Variable<unsigned> m_module_capacity;
+  Variable<unsigned> m_task_deferrals;
+  Variable<unsigned> m_update_deferrals;
   EnumStrVariable<App::LogType> m_log_type;
   MqttManager* m_mqtt_manager = nullptr;
+  StallWatchdog* m_stall_watchdog = nullptr;
 };
 
 }  // namespace og3
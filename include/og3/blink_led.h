@@ -48,6 +48,11 @@ class BlinkLed : public Module {
    */
   void delayedBlink(unsigned msec, uint8_t num = 1);
 
+  /**
+   * @brief Stop any blinking in progress or scheduled, and turn the LED off.
+   */
+  void stop();
+
  private:
   /**
    * @brief Callback for blink scheduling.
@@ -17,3 +17,11 @@
  */
 #define OG3_PRINTF_FORMAT(X)
 #endif
+
+#ifdef NATIVE
+/** @brief Places a function in IRAM so it may run from an interrupt (empty for native). */
+#define OG3_IRAM_ATTR
+#else
+/** @brief Places a function in IRAM so it may run from an interrupt (empty for native). */
+#define OG3_IRAM_ATTR IRAM_ATTR
+#endif
@@ -0,0 +1,82 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace og3 {
+
+/**
+ * @brief Records which callback the loop is running, for another thread to sample.
+ *
+ * ModuleSystem::update() and Tasks::loop() mark the start and end of every callback
+ * they run. This costs a few atomic loads and stores per callback and reads no clock: an
+ * observer such as StallWatchdog samples the trace periodically, and a callback which
+ * is still running with the same sequence number in consecutive samples has been
+ * running for at least the time between them.
+ */
+class DispatchTrace {
+ public:
+  /** @brief What kind of callback is running. */
+  enum class Kind : uint8_t {
+    kNone,    ///< The loop is between callbacks.
+    kUpdate,  ///< A module update function; the ID is the module's sorted index.
+    kTask,    ///< A scheduled task; the ID is its task ID (0 for none).
+  };
+
+  /** @brief A consistent view of the trace. */
+  struct Sample {
+    Kind kind;     ///< What was running.
+    uint32_t id;   ///< Module sorted index or task ID, per kind.
+    uint32_t seq;  ///< Changes each time a callback starts or ends.
+  };
+
+  /** @brief What was running before begin(), to restore with end(). */
+  using Token = uint32_t;
+
+  /**
+   * @brief Marks the start of a callback.
+   *
+   * Callbacks may nest, as tasks do inside the update function of Tasks.
+   * @return What was running before, to pass to end().
+   */
+  Token begin(Kind kind, uint32_t id) {
+    return set((static_cast<uint32_t>(kind) << kKindShift) | (id & kIdMask));
+  }
+  /** @brief Marks the end of the callback started by the begin() which returned prev. */
+  void end(Token prev) { set(prev); }
+
+  /** @return What is running now. */
+  Sample sample() const {
+    uint32_t seq = m_seq.load(std::memory_order_acquire);
+    uint32_t current;
+    // Retry if a callback started or ended between the two loads.
+    while (true) {
+      current = m_current.load(std::memory_order_acquire);
+      const uint32_t seq2 = m_seq.load(std::memory_order_acquire);
+      if (seq2 == seq) {
+        break;
+      }
+      seq = seq2;
+    }
+    return {static_cast<Kind>(current >> kKindShift), current & kIdMask, seq};
+  }
+
+ private:
+  Token set(uint32_t current) {
+    const uint32_t prev = m_current.load(std::memory_order_relaxed);
+    m_current.store(current, std::memory_order_relaxed);
+    m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    return prev;
+  }
+
+  static constexpr unsigned kKindShift = 24;
+  static constexpr uint32_t kIdMask = (1u << kKindShift) - 1;
+
+  std::atomic<uint32_t> m_current{0};  ///< Kind in the top 8 bits, ID in the low 24 bits.
+  std::atomic<uint32_t> m_seq{0};
+};
+
+}  // namespace og3
@@ -0,0 +1,123 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#if defined(NATIVE)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#endif
+
+#include "og3/inline_function.h"
+#include "og3/module.h"
+#include "og3/tasks.h"
+
+namespace og3 {
+
+/**
+ * @brief Runs CPU-heavy work off the loop thread, with completion callbacks on the loop.
+ *
+ * Executor has the same runAt()/runIn() interface as Tasks, but each task has two
+ * callbacks: `work`, which runs on a worker, and `done`, which runs afterwards on the
+ * loop thread. Use it for work that would otherwise delay time-critical tasks, such as
+ * serializing a large VariableGroup or computing a CRC over a packet. Work must not
+ * touch state which the loop uses without synchronization; pass the results to `done`.
+ *
+ * On native builds the workers are std::threads. On ESP32 they are FreeRTOS tasks,
+ * pinned to the core which does not run loop() on dual-core chips. On ESP8266, which
+ * has no threads, work runs on the loop when it is due, immediately followed by done.
+ *
+ * Jobs are held in a fixed table of kMaxJobs slots, so scheduling work never allocates.
+ * Workers signal completion with Tasks::wake(), and the executor's update function
+ * runs completion callbacks in the next loop. That update function is disabled while
+ * no jobs are pending.
+ */
+class Executor : public Module {
+ public:
+  static const char kName[];  ///< @brief "executor"
+  /** @brief Maximum number of jobs scheduled, queued or awaiting completion. */
+  static constexpr std::size_t kMaxJobs = 8;
+  /** @brief Maximum number of worker threads. */
+  static constexpr std::size_t kMaxWorkers = 4;
+
+  /**
+   * @brief Constructs an Executor and starts its workers.
+   * @param tasks The Tasks module which schedules jobs and wakes the loop.
+   * @param num_workers Number of worker threads, up to kMaxWorkers.
+   */
+  explicit Executor(Tasks* tasks, std::size_t num_workers = 1);
+  Executor(const Executor&) = delete;
+  ~Executor();
+
+  /**
+   * @brief Schedules work to run on a worker at an absolute time.
+   * @param msec Time (millis) to hand the work to a worker.
+   * @param work The callback to run on a worker.
+   * @param done Optional callback to run on the loop thread after work finishes.
+   * @param id Optional task ID; a job with the same ID which has not started is replaced.
+   * @return false if all job slots are in use or the task queue is full.
+   */
+  bool runAt(unsigned long msec, TaskThunk work, TaskThunk done = nullptr, unsigned id = 0);
+  /** @brief Schedules work to run on a worker after a delay from now (see runAt()). */
+  bool runIn(unsigned long msec, TaskThunk work, TaskThunk done = nullptr, unsigned id = 0);
+
+  /** @return The number of worker threads (0 if work runs on the loop). */
+  std::size_t numWorkers() const { return m_num_workers; }
+  /** @return The number of jobs which have not yet completed. */
+  std::size_t pending() const;
+
+  /** @brief Runs completion callbacks of finished jobs. Called from loop(). */
+  void loop();
+
+ private:
+  enum class JobState : uint8_t {
+    kFree,       ///< Unused slot.
+    kScheduled,  ///< Waiting in Tasks for its start time.
+    kQueued,     ///< Waiting for a worker.
+    kRunning,    ///< Running on a worker.
+    kDone,       ///< Waiting for loop() to run its completion callback.
+  };
+  struct Job {
+    TaskThunk work;
+    TaskThunk done;
+    unsigned id = 0;
+    TaskHandle task;  ///< The task which submits the job, while kScheduled.
+    std::atomic<JobState> state{JobState::kFree};
+  };
+
+  void freeJob(Job* job);
+  void submit(Job* job);
+  void runJob(Job* job);
+  void workerMain();
+
+  Tasks* m_tasks;
+  ModuleSystem::UpdateId m_update = 0;
+  Job m_jobs[kMaxJobs];
+  std::size_t m_num_workers = 0;
+  std::atomic<uint32_t> m_num_completed{0};  ///< Incremented by workers.
+  uint32_t m_num_reaped = 0;                 ///< Completions run by loop().
+
+#if defined(NATIVE)
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  Job* m_ready[kMaxJobs] = {};  ///< Ring of jobs waiting for a worker.
+  std::size_t m_ready_head = 0;
+  std::size_t m_ready_count = 0;
+  bool m_stopping = false;
+  std::thread m_workers[kMaxWorkers];
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  QueueHandle_t m_ready = nullptr;  ///< Queue of Job pointers waiting for a worker.
+  TaskHandle_t m_workers[kMaxWorkers] = {};
+  static void workerTask(void* executor);
+#endif
+};
+
+}  // namespace og3
@@ -56,10 +56,12 @@ class HAApp : public WebApp {
    * @brief Publishes a group of variables to MQTT.
    * @param vg The VariableGroup to publish.
    * @param flags Filter flags for variable selection.
+   * @param mode Whether to send all variables, or skip unchanged ones.
    * @return true if publishing was successful.
    */
-  bool mqttSend(const VariableGroup& vg, unsigned flags = VariableBase::kNoPublish) {
-    return mqtt_manager().mqttSend(vg, flags);
+  bool mqttSend(const VariableGroup& vg, unsigned flags = VariableBase::kNoPublish,
+                MqttManager::SendMode mode = MqttManager::SendMode::kAll) {
+    return mqtt_manager().mqttSend(vg, flags, mode);
   }
 
   /** @return Reference to the MQTT manager. */
@@ -0,0 +1,47 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstdint>
+
+namespace og3 {
+
+/**
+ * @brief A snapshot of heap and loop-stack health.
+ *
+ * Sources by platform:
+ *  - ESP32: heap_caps for the 8-bit heap, and the stack high-water mark of the calling task.
+ *  - ESP8266: ESP.getHeapStats(), and the free continuation (loop) stack.
+ *  - Native: glibc mallinfo2(). The largest free block is the releasable top of the heap,
+ *    a lower bound. There is no stack high-water mark.
+ *
+ * The allocation counts come from an allocator hook on native builds, which counts
+ * malloc() and free() calls, compiled in with `-DOG3_ALLOC_HOOK`; without it, and on
+ * ESP32 and ESP8266, they are zero. ESP32 instead reports how many blocks are allocated
+ * and free right now, from heap_caps.
+ */
+struct HeapStats {
+  uint32_t free_bytes = 0;          ///< Free heap.
+  uint32_t largest_free_block = 0;  ///< Largest block which could be allocated.
+  uint32_t min_free_bytes = 0;      ///< Lowest free heap seen since boot.
+  uint8_t fragmentation_pct = 0;    ///< 100 * (1 - largest_free_block / free_bytes).
+  uint32_t stack_free_bytes = 0;    ///< Lowest free space seen on the loop stack.
+  uint32_t num_allocs = 0;          ///< Allocations since boot.
+  uint32_t num_frees = 0;           ///< Frees since boot.
+  uint32_t allocated_blocks = 0;    ///< Blocks allocated now (ESP32 only).
+  uint32_t free_blocks = 0;         ///< Free blocks now (ESP32 only).
+
+  /**
+   * @brief Reads the current values. Call from the loop task for the stack high-water mark.
+   *
+   * Where the platform does not track the lowest free heap, min_free_bytes is the lowest
+   * value seen by earlier calls on this object.
+   */
+  void read();
+
+  /** @return true if allocations are counted on this platform and build. */
+  static bool countsAllocations();
+};
+
+}  // namespace og3
@@ -19,6 +19,13 @@ namespace og3::html {
  */
 void escape(String* out_str, const char* in_str);
 
+/**
+ * @brief Writes the escaped value of a variable, as formatted by VariableBase::formatTo().
+ * @param out_str The output HTML string.
+ * @param var The variable whose value to write.
+ */
+void writeValueInto(String* out_str, const VariableBase& var);
+
 /**
  * @brief Writes a single table row for a variable.
  * @param out_str The output HTML string.
@@ -0,0 +1,134 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace og3 {
+
+template <typename Signature, std::size_t kCapacity>
+class InlineFunction;
+
+/**
+ * @brief A move-only callable wrapper which stores its target inline, never on the heap.
+ *
+ * InlineFunction is a replacement for std::function for callbacks that are created and
+ * destroyed in `loop()`, such as scheduled tasks. The callable (typically a lambda) is
+ * constructed directly in a fixed-size buffer inside the object. A callable which does not fit
+ * in kCapacity bytes is rejected at compile time rather than falling back to a heap allocation.
+ *
+ * @tparam R Return type.
+ * @tparam Args Argument types.
+ * @tparam kCapacity Size of the inline storage in bytes.
+ */
+template <typename R, typename... Args, std::size_t kCapacity>
+class InlineFunction<R(Args...), kCapacity> {
+ public:
+  /** @brief The size of the inline storage in bytes. */
+  static constexpr std::size_t kStorageSize = kCapacity;
+
+  /** @brief Constructs an empty InlineFunction. */
+  InlineFunction() = default;
+  /** @brief Constructs an empty InlineFunction. */
+  InlineFunction(std::nullptr_t) {}  // NOLINT(runtime/explicit)
+
+  /**
+   * @brief Constructs an InlineFunction holding a copy of (or moving) a callable.
+   * @param fn A callable with a signature compatible with R(Args...).
+   */
+  template <typename F, typename = std::enable_if_t<
+                            !std::is_same<std::decay_t<F>, InlineFunction>::value &&
+                            !std::is_same<std::decay_t<F>, std::nullptr_t>::value>>
+  InlineFunction(F&& fn) {  // NOLINT(runtime/explicit)
+    using Fn = std::decay_t<F>;
+    static_assert(sizeof(Fn) <= kCapacity, "Callable is too large for InlineFunction storage");
+    static_assert(alignof(Fn) <= alignof(Storage), "Callable alignment is too strict");
+    if constexpr (std::is_pointer<Fn>::value) {
+      if (!fn) {
+        return;
+      }
+    }
+    new (&m_storage) Fn(std::forward<F>(fn));
+    m_ops = &Ops<Fn>::kOps;
+  }
+
+  InlineFunction(InlineFunction&& other) noexcept { moveFrom(&other); }
+  InlineFunction(const InlineFunction&) = delete;
+
+  ~InlineFunction() { reset(); }
+
+  InlineFunction& operator=(InlineFunction&& other) noexcept {
+    if (this != &other) {
+      reset();
+      moveFrom(&other);
+    }
+    return *this;
+  }
+  InlineFunction& operator=(const InlineFunction&) = delete;
+  InlineFunction& operator=(std::nullptr_t) {
+    reset();
+    return *this;
+  }
+
+  /** @return true if a callable is stored. */
+  explicit operator bool() const { return m_ops != nullptr; }
+
+  /** @brief Invokes the stored callable, which must not be empty. */
+  R operator()(Args... args) const {
+    return m_ops->invoke(const_cast<Storage*>(&m_storage), std::forward<Args>(args)...);
+  }
+
+  /** @brief Destroys the stored callable, leaving this empty. */
+  void reset() {
+    if (m_ops) {
+      m_ops->destroy(&m_storage);
+      m_ops = nullptr;
+    }
+  }
+
+ private:
+  using Storage = std::aligned_storage_t<kCapacity, alignof(std::max_align_t)>;
+
+  // Type-erased operations on the stored callable, one static table per callable type.
+  struct OpsTable {
+    R (*invoke)(void* fn, Args&&... args);
+    void (*move)(void* dest, void* src);
+    void (*destroy)(void* fn);
+  };
+
+  template <typename Fn>
+  struct Ops {
+    static R invoke(void* fn, Args&&... args) {
+      return (*static_cast<Fn*>(fn))(std::forward<Args>(args)...);
+    }
+    static void move(void* dest, void* src) {
+      new (dest) Fn(std::move(*static_cast<Fn*>(src)));
+      static_cast<Fn*>(src)->~Fn();
+    }
+    static void destroy(void* fn) { static_cast<Fn*>(fn)->~Fn(); }
+    static constexpr OpsTable kOps{&invoke, &move, &destroy};
+  };
+
+  void moveFrom(InlineFunction* other) {
+    if (other->m_ops) {
+      other->m_ops->move(&m_storage, &other->m_storage);
+      m_ops = other->m_ops;
+      other->m_ops = nullptr;
+    }
+  }
+
+  Storage m_storage;
+  const OpsTable* m_ops = nullptr;
+};
+
+/** @brief Inline storage size for scheduled task callbacks (e.g. `[this, id]` lambdas). */
+constexpr std::size_t kTaskThunkCapacity = 24;
+
+/** @brief Allocation-free callback type used by the task scheduler. */
+using TaskThunk = InlineFunction<void(), kTaskThunkCapacity>;
+
+}  // namespace og3
@@ -0,0 +1,83 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace og3 {
+
+/** @brief Function called from loop() for an event posted by an interrupt handler. */
+using IsrEventFn = void (*)(void* ctx);
+
+/** @brief An event posted from interrupt context, to be handled in loop(). */
+struct IsrEvent {
+  IsrEventFn fn = nullptr;  ///< The function to call.
+  void* ctx = nullptr;      ///< Argument passed to fn.
+  unsigned long msec = 0;   ///< Time (millis) at which the event was posted.
+};
+
+/**
+ * @brief A fixed-capacity, lock-free, multi-producer single-consumer event queue.
+ *
+ * Interrupt handlers (or other threads) post() small POD events which the main loop
+ * drains with pop(). It is a bounded ring of cells with per-cell sequence numbers (after
+ * Dmitry Vyukov's bounded MPMC queue), so producers never block and never allocate.
+ * When the queue is full, post() fails and the event is counted in dropped().
+ *
+ * On ESP8266, which has no compare-and-swap instruction, producers claim a cell with
+ * interrupts masked instead.
+ */
+class IsrEventQueue {
+ public:
+  /**
+   * @brief Constructs an IsrEventQueue.
+   * @param capacity The number of events which may be pending; rounded up to a power of two.
+   */
+  explicit IsrEventQueue(std::size_t capacity);
+  IsrEventQueue(const IsrEventQueue&) = delete;
+
+  /**
+   * @brief Posts an event. Safe to call from interrupt handlers and from multiple threads.
+   * @param fn The function to call from loop().
+   * @param ctx Argument passed to fn.
+   * @param msec Timestamp to record with the event.
+   * @return false if the queue was full and the event was dropped.
+   */
+  bool post(IsrEventFn fn, void* ctx, unsigned long msec);
+
+  /**
+   * @brief Takes the oldest event from the queue. Must only be called from one thread.
+   * @param event Filled in with the event.
+   * @return false if no event is ready.
+   */
+  bool pop(IsrEvent* event);
+
+  /** @return true if no event is ready for pop(). Must only be called by the consumer. */
+  bool empty() const {
+    const Cell& cell = m_cells[m_dequeue_pos & m_mask];
+    return cell.seq.load(std::memory_order_acquire) != m_dequeue_pos + 1;
+  }
+
+  /** @return The maximum number of pending events. */
+  std::size_t capacity() const { return m_cells.size(); }
+  /** @return The number of events dropped because the queue was full. */
+  uint32_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+ private:
+  struct Cell {
+    std::atomic<uint32_t> seq{0};
+    IsrEvent event;
+  };
+
+  std::vector<Cell> m_cells;
+  const uint32_t m_mask;
+  std::atomic<uint32_t> m_enqueue_pos{0};
+  uint32_t m_dequeue_pos = 0;
+  std::atomic<uint32_t> m_dropped{0};
+};
+
+}  // namespace og3
@@ -0,0 +1,84 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+
+namespace og3 {
+
+class TextBufferBase;
+
+/**
+ * @brief Writes JSON text straight into a fixed-size character buffer.
+ *
+ * There is no document tree and no heap allocation: values are appended as they are
+ * written. When the buffer is too small the text is cut off, but length() keeps counting,
+ * as snprintf() does, so the caller can tell the output was truncated and how much room
+ * it would have needed. The text in the buffer is always NUL-terminated.
+ *
+ * The writer does not check structure; the caller writes the separators, as
+ * VariableGroup::writeJson() does.
+ */
+class JsonWriter {
+ public:
+  /**
+   * @brief Constructs a writer into a caller-provided buffer.
+   * @param buffer The target buffer.
+   * @param size Size of the buffer in bytes, including the terminating NUL.
+   */
+  JsonWriter(char* buffer, std::size_t size);
+  /**
+   * @brief Constructs a writer which appends to a TextBuffer.
+   *
+   * Call TextBufferBase::extend(length()) when done, so the text buffer counts the
+   * appended text.
+   */
+  explicit JsonWriter(TextBufferBase* out);
+
+  /** @brief Appends text as is. */
+  void raw(const char* text, std::size_t len);
+  /** @brief Appends a NUL-terminated text as is. */
+  void raw(const char* text);
+  /** @brief Appends one character. */
+  void raw(char c);
+
+  /** @brief Appends a quoted and escaped JSON string. */
+  void string(const char* text);
+  /** @brief Appends true or false. */
+  void value(bool val) { val ? raw("true", 4) : raw("false", 5); }
+  /** @brief Appends an integer. */
+  void value(int val) { value(static_cast<long long>(val)); }
+  /** @brief Appends an integer. */
+  void value(unsigned val) { value(static_cast<unsigned long long>(val)); }
+  /** @brief Appends an integer. */
+  void value(long val) { value(static_cast<long long>(val)); }
+  /** @brief Appends an integer. */
+  void value(unsigned long val) { value(static_cast<unsigned long long>(val)); }
+  /** @brief Appends an integer. */
+  void value(long long val);
+  /** @brief Appends an integer. */
+  void value(unsigned long long val);
+  /**
+   * @brief Appends a number with a fixed number of decimals; NaN and infinity as null.
+   * @param val The number.
+   * @param decimals Digits after the decimal point.
+   */
+  void value(double val, unsigned decimals);
+  /** @brief Appends null. */
+  void null() { raw("null", 4); }
+
+  /** @return Length of the full text written, which exceeds size() - 1 if truncated. */
+  std::size_t length() const { return m_len; }
+  /** @return Size of the buffer, including the terminating NUL. */
+  std::size_t size() const { return m_size; }
+  /** @return true if the text did not fit into the buffer. */
+  bool truncated() const { return m_size == 0 || m_len >= m_size; }
+
+ private:
+  char* m_buffer;
+  std::size_t m_size;
+  std::size_t m_len = 0;
+};
+
+}  // namespace og3
@@ -0,0 +1,58 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace og3 {
+
+/**
+ * @brief A fixed-size histogram with power-of-two buckets.
+ *
+ * Bucket 0 counts zeros and bucket b counts values in [2^(b-1), 2^b - 1]; the last
+ * bucket also counts everything larger. Percentiles are reported as the upper bound
+ * of the bucket they fall in (clamped to the largest value seen), so they are accurate
+ * to within a factor of two. Adding a value is O(1) and never allocates.
+ *
+ * Bucket counts are 16 bits. When one would overflow, all counts are halved, so the
+ * histogram slowly favors recent values instead of saturating.
+ */
+class LogHistogram {
+ public:
+  /** @brief Number of buckets. Values of 2^22 and over share the last bucket. */
+  static constexpr std::size_t kNumBuckets = 24;
+
+  /** @brief Adds a value to the histogram. */
+  void add(uint32_t value);
+
+  /** @brief Clears the histogram. */
+  void reset();
+
+  /** @return The number of values in the histogram. */
+  uint32_t count() const { return m_count; }
+  /** @return The largest value added since the last reset(). */
+  uint32_t max() const { return m_max; }
+  /** @return The number of values in a bucket. */
+  uint16_t bucketCount(std::size_t bucket) const { return m_buckets[bucket]; }
+
+  /**
+   * @brief Estimates a percentile.
+   * @param percent The percentile, from 0 to 100.
+   * @return The upper bound of the bucket containing the percentile, or 0 if empty.
+   */
+  uint32_t percentile(unsigned percent) const;
+
+  /** @return The index of the bucket which counts value. */
+  static std::size_t bucketFor(uint32_t value);
+  /** @return The largest value counted by a bucket (except the unbounded last bucket). */
+  static uint32_t bucketMax(std::size_t bucket);
+
+ private:
+  uint16_t m_buckets[kNumBuckets] = {};
+  uint32_t m_count = 0;
+  uint32_t m_max = 0;
+};
+
+}  // namespace og3
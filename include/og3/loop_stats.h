@@ -0,0 +1,82 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstdint>
+
+#include "og3/log_histogram.h"
+#include "og3/variable.h"
+
+namespace og3 {
+
+/**
+ * @brief Loop rate, iteration time and where the loop spends its time.
+ *
+ * When enabled (App::Options::withLoopStats()), App::loop() records the time of
+ * each iteration's ModuleSystem::update(), and Tasks::loop() the part of it spent
+ * running timed tasks. That is four calls to micros() per loop. Over each window,
+ * iteration times are kept in a LogHistogram and the rest is summed.
+ *
+ * update() summarizes the window into a VariableGroup, which AppStatus publishes, and
+ * starts a new window: loops per second, the longest iteration in the window, p50/p99
+ * iteration time, and the share of time spent in module updates and in tasks. A loop
+ * rate which collapses is an early sign of a sluggish device.
+ */
+class LoopStats {
+ public:
+  /**
+   * @brief Constructs a LoopStats object.
+   * @param name Name of the VariableGroup for the summary.
+   */
+  explicit LoopStats(const char* name = "loop_stats");
+  LoopStats(const LoopStats&) = delete;
+
+  /** @brief Enables or disables recording. */
+  void setEnabled(bool enabled) { m_enabled = enabled; }
+  /** @return true if loops are being recorded. */
+  bool enabled() const { return m_enabled; }
+
+  /**
+   * @brief Records one loop iteration.
+   * @param update_usec Microseconds spent in ModuleSystem::update(), including tasks.
+   */
+  void record(unsigned long update_usec);
+  /** @brief Adds time spent in Tasks::loop() during the current iteration. */
+  void addTasksUsec(unsigned long usec) { m_window_tasks_usec += usec; }
+
+  /**
+   * @brief Updates the summary variables from the current window and starts a new one.
+   * @param now_msec The current time (millis).
+   */
+  void update(unsigned long now_msec);
+  /** @brief Starts a new window without updating the summary variables. */
+  void reset(unsigned long now_msec);
+
+  /** @return Histogram of iteration times in the current window, in microseconds. */
+  const LogHistogram& latency() const { return m_latency; }
+  /** @return Iterations in the current window. */
+  uint32_t windowLoops() const { return m_window_loops; }
+
+  /** @return Summary variables: loop rate, max/p50/p99 iteration time, time shares. */
+  const VariableGroup& variables() const { return m_vg; }
+
+ private:
+  bool m_enabled = false;
+  LogHistogram m_latency;
+  unsigned long m_window_start_msec = 0;
+  uint32_t m_window_loops = 0;
+  uint32_t m_window_max_usec = 0;
+  uint64_t m_window_update_usec = 0;
+  uint64_t m_window_tasks_usec = 0;
+
+  VariableGroup m_vg;
+  FloatVariable m_loop_rate;
+  Variable<unsigned> m_loop_max;
+  Variable<unsigned> m_loop_p50;
+  Variable<unsigned> m_loop_p99;
+  FloatVariable m_modules_pct;
+  FloatVariable m_tasks_pct;
+};
+
+}  // namespace og3
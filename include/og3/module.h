@@ -68,10 +68,33 @@ class Module {
   void add_start_fn(const Thunk& thunk);
 
   /**
-   * @brief Registers a function to be called in every iteration of the main loop.
+   * @brief Registers a function to be called in iterations of the main loop.
+   *
+   * By default the function is called in every iteration. Functions which only need
+   * polling at some rate should pass a minimum interval, and functions which are only
+   * needed in some states can be disabled with set_update_enabled() in the others.
    * @param thunk The callback function.
+   * @param interval_msec Minimum milliseconds between calls (0: every iteration).
+   * @return An ID for set_update_enabled().
+   */
+  ModuleSystem::UpdateId add_update_fn(const Thunk& thunk, unsigned interval_msec = 0);
+
+  /**
+   * @brief Registers a plain function and context pointer to be called in the main loop.
+   *
+   * This is like the Thunk version above, without the indirection of a std::function.
+   * @param fn The callback function, called with ctx.
+   * @param ctx The context pointer passed to fn.
+   * @param interval_msec Minimum milliseconds between calls (0: every iteration).
+   * @return An ID for set_update_enabled().
    */
-  void add_update_fn(const Thunk& thunk);
+  ModuleSystem::UpdateId add_update_fn(ModuleSystem::UpdateFn fn, void* ctx,
+                                       unsigned interval_msec = 0);
+
+  /** @brief Enables or disables one of this module's update functions. */
+  void set_update_enabled(ModuleSystem::UpdateId id, bool enabled) {
+    m_module_system->set_update_enabled(id, enabled);
+  }
 
   /**
    * @brief Adds an HTML button snippet to a String body.
@@ -81,6 +104,9 @@ class Module {
    */
   void add_html_button(String* body, const char* title, const char* url) const;
 
+  /** @return Whether init callbacks of this module may run alongside those of others. */
+  bool concurrent_init() const { return m_concurrent_init; }
+
   /**
    * @brief Retrieves the sorted index of this module within the ModuleSystem.
    * @return The sorted index.
@@ -101,6 +127,18 @@ class Module {
     m_module_system->add_requirement(this, name, reinterpret_cast<void**>(ptr));
   }
 
+  /**
+   * @brief Lets the init callbacks of this module run at the same time as those of other
+   * opted-in modules at the same dependency depth, when parallel init is enabled (see
+   * ModuleSystem::set_parallel_init()).
+   *
+   * Only opt in if the callbacks share no unsynchronized state with other modules: they
+   * must not register callbacks with other modules (e.g. WifiManager::addConnectCallback()),
+   * read or write config files, schedule tasks or log.
+   * @param val Whether init callbacks may run concurrently.
+   */
+  void set_concurrent_init(bool val = true) { m_concurrent_init = val; }
+
   /**
    * @brief Sets the sorted index of this module. Used internally by ModuleSystem.
    * @param idx The sorted index.
@@ -114,6 +152,7 @@ class Module {
   const char* m_name;             ///< @brief Unique name identifying this module instance.
   ModuleSystem* m_module_system;  ///< @brief The ModuleSystem this module is part of.
   bool m_is_ok = false;           ///< @brief Indicates if the module is in a healthy state.
+  bool m_concurrent_init = false;  ///< @brief Whether init may run alongside other modules.
   unsigned m_sorted_idx = 0;      ///< @brief The topological sort index assigned by ModuleSystem.
 };
 
@@ -0,0 +1,101 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "og3/variable.h"
+
+namespace og3 {
+
+/**
+ * @brief CPU time spent in each module's init, start and update callbacks.
+ *
+ * ModuleSystem records every callback it runs here when built with OG3_MODULE_PROFILE
+ * defined; otherwise no timing code is compiled into ModuleSystem at all. For each
+ * module and phase, the number of calls and the total and longest call time in
+ * microseconds are kept. Entries are indexed by Module::sorted_index().
+ *
+ * update() summarizes the entries into a VariableGroup which AppStatus publishes, and
+ * WebApp serves the full table as a /profile page and as JSON at /profile.json.
+ */
+class ModuleProfile {
+ public:
+  /** @brief The module callbacks which are timed. */
+  enum class Phase : uint8_t { kInit, kStart, kUpdate };
+  /** @brief Number of Phase values. */
+  static constexpr std::size_t kNumPhases = 3;
+
+  /** @brief Timing of the callbacks of one module in one phase. */
+  struct Timing {
+    uint32_t count = 0;       ///< Number of calls.
+    uint64_t total_usec = 0;  ///< Total time in the calls.
+    uint32_t max_usec = 0;    ///< Longest call.
+  };
+
+  /** @brief Timings of one module. */
+  struct Entry {
+    const char* name = nullptr;  ///< The module's name.
+    Timing phases[kNumPhases];   ///< Timings indexed by Phase.
+
+    /** @return The timing of one phase. */
+    const Timing& timing(Phase phase) const { return phases[static_cast<int>(phase)]; }
+  };
+
+  /**
+   * @brief Constructs a ModuleProfile.
+   * @param name Name of the VariableGroup for the summary.
+   */
+  explicit ModuleProfile(const char* name = "module_profile");
+  ModuleProfile(const ModuleProfile&) = delete;
+
+  /**
+   * @brief Sets the number of modules, clearing all timings. Called by ModuleSystem::link().
+   * @param num_modules The number of modules.
+   */
+  void setNumModules(std::size_t num_modules);
+  /** @brief Sets the name of the module with the given sorted index. */
+  void setName(std::size_t module_idx, const char* name) { m_entries[module_idx].name = name; }
+
+  /**
+   * @brief Records one callback.
+   * @param module_idx Sorted index of the module which owns the callback.
+   * @param phase The lifecycle phase of the callback.
+   * @param usec Microseconds spent in the callback.
+   */
+  void record(std::size_t module_idx, Phase phase, unsigned long usec);
+
+  /** @return The number of modules profiled. */
+  std::size_t numEntries() const { return m_entries.size(); }
+  /** @return Timings of the module with the given sorted index. */
+  const Entry& entry(std::size_t module_idx) const { return m_entries[module_idx]; }
+
+  /** @brief Updates the summary variables from the entries. */
+  void update();
+  /** @brief Clears the update timings, keeping the init and start timings from boot. */
+  void reset();
+
+  /** @return Summary variables: init and start times, and the slowest update callback. */
+  const VariableGroup& variables() const { return m_vg; }
+
+  /** @brief Appends an HTML table of every module's timings to out_str. */
+  void writeHtmlInto(String* out_str) const;
+  /** @brief Appends a JSON array of every module's timings to out_str. */
+  void writeJsonInto(String* out_str) const;
+
+ private:
+  std::vector<Entry> m_entries;
+
+  VariableGroup m_vg;
+  Variable<unsigned> m_init_usec;
+  Variable<unsigned> m_start_usec;
+  Variable<String> m_slowest_name;
+  Variable<unsigned> m_slowest_usec;
+};
+
+}  // namespace og3
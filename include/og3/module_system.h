@@ -3,11 +3,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <vector>
 
 #include "og3/compiler_definitions.h"
+#include "og3/dispatch_trace.h"
 #include "og3/util.h"
+#ifdef OG3_MODULE_PROFILE
+#include "og3/module_profile.h"
+#endif
 
 namespace og3 {
 
@@ -21,9 +28,27 @@ class Module;
  * The ModuleSystem is central to the og3 application framework, enabling applications to be built
  * from a set of modular, interdependent components. It handles the registration, linking,
  * sorting, and execution of module-defined callbacks across the application's lifecycle.
+ *
+ * When built with OG3_MODULE_PROFILE defined, the time spent in every init, start and
+ * update callback is recorded per module in profile().
  */
 class ModuleSystem {
  public:
+  /** @brief An update callback: a plain function called with its context pointer. */
+  using UpdateFn = void (*)(void* ctx);
+  /** @brief Identifies an update callback, for enabling it or changing its interval. */
+  using UpdateId = uint16_t;
+  /** @brief Maximum number of threads running init callbacks in parallel. */
+  static constexpr unsigned kMaxInitWorkers = 4;
+
+  /** @brief Boot time of one dependency level in a parallel init(). */
+  struct InitLevel {
+    uint16_t level;           ///< Dependency depth: 0 for modules which require no others.
+    uint16_t num_modules;     ///< Number of modules with init callbacks at this depth.
+    uint16_t num_concurrent;  ///< Number of those which were initialized concurrently.
+    uint32_t usec;            ///< Time to initialize the level.
+  };
+
   /**
    * @brief Constructs a ModuleSystem instance.
    *
@@ -56,11 +81,42 @@ class ModuleSystem {
    *
    * This function should be called repeatedly in the main application loop (e.g., Arduino
    * `loop()`). Module update callbacks are invoked in a topologically sorted order.
+   * Disabled callbacks are skipped, as are callbacks with a minimum interval which
+   * ran less than that interval ago.
+   *
+   * With an update budget (set_update_budget()), a call stops once the budget is spent,
+   * and the next call continues with the following callback, round-robin, so that every
+   * callback still runs in turn.
    * @return The number of update callbacks executed, or -1 if the system is not initialized
    * (`!ok()`).
    */
   int update();
 
+  /**
+   * @brief Enables or disables an update callback.
+   * @param id The ID returned when the callback was added.
+   * @param enabled Whether update() calls the callback.
+   */
+  void set_update_enabled(UpdateId id, bool enabled) { update_rec(id).enabled = enabled; }
+  /** @return Whether update() calls the update callback with the given ID. */
+  bool update_enabled(UpdateId id) const { return m_update_fns[m_update_pos[id]].enabled; }
+  /**
+   * @brief Sets the minimum time between calls of an update callback.
+   * @param id The ID returned when the callback was added.
+   * @param interval_msec Minimum milliseconds between calls (0: call on every update()).
+   */
+  void set_update_interval(UpdateId id, unsigned interval_msec);
+
+  /**
+   * @brief Limits the time spent in one call to update().
+   *
+   * At least one update callback always runs per call.
+   * @param max_usec Stop calling update callbacks after this much time (0: no limit).
+   */
+  void set_update_budget(unsigned long max_usec) { m_update_budget_usec = max_usec; }
+  /** @return The number of calls to update() which stopped before running every callback. */
+  unsigned long update_deferrals() const { return m_update_deferrals; }
+
   /**
    * @brief Performs the linking phase of the module lifecycle.
    *
@@ -80,9 +136,30 @@ class ModuleSystem {
    * @brief Executes the initialization callbacks for all registered modules.
    *
    * Callbacks are invoked in a topologically sorted order. Called internally by `setup()`.
+   * With parallel init (set_parallel_init()), modules are grouped by dependency depth,
+   * and the modules of each depth which opted in (Module::set_concurrent_init()) are
+   * initialized concurrently once all modules of lower depths are done.
    */
   void init();
 
+  /**
+   * @brief Runs init callbacks on several threads (std::thread on native, FreeRTOS tasks
+   * on ESP32); on other platforms init stays sequential.
+   *
+   * A module's init callbacks still run in order, after those of every module it requires.
+   * Only modules which opt in with Module::set_concurrent_init() are initialized at the
+   * same time as other modules at the same dependency depth; the init callbacks of the
+   * others run one module at a time on the calling thread, before the concurrent ones.
+   * Work such as probing sensors is what benefits.
+   * @param num_workers Number of threads, including the calling one, up to kMaxInitWorkers
+   *   (0 or 1: sequential).
+   */
+  void set_parallel_init(unsigned num_workers) {
+    m_init_workers = num_workers > kMaxInitWorkers ? kMaxInitWorkers : num_workers;
+  }
+  /** @return The time taken by each dependency level in the last parallel init(). */
+  const std::vector<InitLevel>& init_levels() const { return m_init_levels; }
+
   /**
    * @brief Executes the start callbacks for all registered modules.
    *
@@ -108,6 +185,30 @@ class ModuleSystem {
    */
   size_t module_capacity() const { return m_modules.capacity(); }
 
+  /**
+   * @brief Finds a module by name, comparing the name strings.
+   *
+   * After link(), this is a lookup in a hash table of module names. Before, it is a
+   * linear search.
+   * @param name The name of the module.
+   * @return The module, or nullptr if no module has this name.
+   */
+  Module* find(const char* name) const;
+
+  /**
+   * @brief Finds a module by its sorted index (see Module::sorted_index()), in O(M).
+   * @return The module, or nullptr if the index is out of range or link() has not run.
+   */
+  Module* find_sorted(size_t sorted_idx) const;
+
+  /** @return The record of which update function or task the loop is running. */
+  DispatchTrace& dispatch_trace() { return m_dispatch_trace; }
+
+#ifdef OG3_MODULE_PROFILE
+  /** @return Time spent in the callbacks of each module. */
+  ModuleProfile& profile() { return m_profile; }
+#endif
+
   /**
    * @brief Registers a dependency requirement for a module.
    * @param owner The module declaring the dependency.
@@ -137,10 +238,16 @@ class ModuleSystem {
 
   /**
    * @brief Adds an update callback. Called by Modules during their construction.
-   * @param thunk The callback function.
+   * @param fn The callback function.
+   * @param ctx The context pointer passed to fn.
    * @param mod The module registering the callback.
+   * @param interval_msec Minimum milliseconds between calls (0: call on every update()).
+   * @return The ID of the callback.
    */
-  void add_update_fn(const Thunk& thunk, Module* mod);
+  UpdateId add_update_fn(UpdateFn fn, void* ctx, Module* mod, unsigned interval_msec);
+
+  /** @brief Adds an update callback given as a Thunk (see above). */
+  UpdateId add_update_fn(const Thunk& thunk, Module* mod, unsigned interval_msec);
 
   /**
    * @brief Allows modules to resolve pointers to other modules by name.
@@ -156,11 +263,19 @@ class ModuleSystem {
   bool topological_sort(size_t* sorted_module_indexes);
 
  private:
-  bool topological_sort_internal(std::vector<size_t>* out_sorted_module_indexes);
+  bool topological_sort_internal(std::vector<size_t>* out_sorted_module_indexes,
+                                 std::vector<uint16_t>* out_levels = nullptr);
+  void build_name_table();
 
   Logger** m_logger;     ///< @brief Pointer to the application's Logger pointer.
   bool m_is_ok = false;  ///< @brief Flag indicating the operational status of the ModuleSystem.
   std::vector<Module*> m_modules;  ///< @brief Collection of all registered modules.
+  /// @brief Open-addressed table of module names: module index + 1, or 0 for an empty slot.
+  std::vector<uint16_t> m_name_table;
+  /// @brief Dependency depth of each module, by sorted index.
+  std::vector<uint16_t> m_levels;
+  unsigned m_init_workers = 0;           ///< @brief Threads for a parallel init() (0: none).
+  std::vector<InitLevel> m_init_levels;  ///< @brief Time of each level of a parallel init().
 
   /// @brief Helper struct to pair a Thunk (init, start, update callback) with its owning Module.
   struct ThunkRec {
@@ -168,12 +283,34 @@ class ModuleSystem {
     ThunkRec(const ThunkRec&) = default;
     Thunk fn;     ///< The callback function.
     Module* mod;  ///< The module that owns this callback.
-    bool operator<(const ThunkRec& o) const;
   };
 
-  std::vector<ThunkRec> m_init_fns;    ///< @brief List of all registered init functions.
-  std::vector<ThunkRec> m_start_fns;   ///< @brief List of all registered start functions.
-  std::vector<ThunkRec> m_update_fns;  ///< @brief List of all registered update functions.
+  void call_init(ThunkRec& fn);
+  void init_parallel();
+  void run_init_level(const size_t* runs, size_t num_runs);
+  void init_worker(const size_t* runs, size_t num_runs, std::atomic<size_t>* next);
+
+  /// @brief An entry in the update dispatch table.
+  struct UpdateRec {
+    UpdateFn fn;             ///< The callback function.
+    void* ctx;               ///< Passed to fn.
+    Module* mod;             ///< The module that owns this callback.
+    uint32_t interval_msec;  ///< Minimum time between calls, or 0.
+    uint32_t next_msec;      ///< Earliest time of the next call, if interval_msec > 0.
+    UpdateId id;             ///< Index in m_update_pos.
+    bool enabled;            ///< Whether update() calls fn.
+  };
+  UpdateRec& update_rec(UpdateId id) { return m_update_fns[m_update_pos[id]]; }
+
+  std::vector<ThunkRec> m_init_fns;     ///< @brief List of all registered init functions.
+  std::vector<ThunkRec> m_start_fns;    ///< @brief List of all registered start functions.
+  std::vector<UpdateRec> m_update_fns;  ///< @brief Update dispatch table, in module order.
+  std::vector<UpdateId> m_update_pos;   ///< @brief Position in m_update_fns of each ID.
+  std::deque<Thunk> m_update_thunks;    ///< @brief Contexts of update callbacks added as Thunks.
+  std::size_t m_num_rate_limited = 0;   ///< @brief Update callbacks with a minimum interval.
+  unsigned long m_update_budget_usec = 0;  ///< @brief Time budget of update() (0: none).
+  std::size_t m_update_cursor = 0;         ///< @brief Next update function to run, if budgeted.
+  unsigned long m_update_deferrals = 0;    ///< @brief Calls to update() which ran out of time.
 
   struct RequirementDescriptor {
     Module* owner;
@@ -182,6 +319,10 @@ class ModuleSystem {
   };
   std::vector<RequirementDescriptor> m_pending_requirements;
   std::vector<std::pair<const Module*, const Module*>> m_implicit_deps;
+  DispatchTrace m_dispatch_trace;
+#ifdef OG3_MODULE_PROFILE
+  ModuleProfile m_profile;
+#endif
 };
 
 }  // namespace og3
@@ -16,6 +16,7 @@
 #endif
 
 #include <functional>
+#include <memory>
 
 #include "og3/logger.h"
 #include "og3/module.h"
@@ -52,6 +53,13 @@ class MqttManager : public Module {
     kAdafruitIO,     ///< Compatibility with Adafruit IO feed structure.
   };
 
+  /** @brief Which variables of a group mqttSend() publishes. */
+  enum class SendMode {
+    kAll,        ///< All variables, every time.
+    kIfChanged,  ///< All variables, but only if any changed since the last send.
+    kChanged,    ///< Only the variables which changed since the last send, if any.
+  };
+
   /** @brief Configuration options for the MQTT manager. */
   struct Options {
     Options() {}
@@ -113,12 +121,21 @@ class MqttManager : public Module {
   void mqttSend(const char topic[], const char content[]);
 
   /**
-   * @brief Publishes all variables in a group to their respective topics.
+   * @brief Publishes the variables in a group to the group's topic.
+   *
+   * Sending clears the changed bits of the variables which the flags select (see
+   * VariableGroup::clearChanged()), and with kIfChanged or kChanged nothing is sent
+   * unless one of those variables changed. With
+   * SendMode::kChanged the message holds only some keys, so use it for consumers which
+   * merge partial updates; Home Assistant entities with a value template for each key
+   * expect every key in each message, so prefer kIfChanged for them.
    * @param variables The VariableGroup to publish.
    * @param flags Filter flags for variable selection.
-   * @return true if publishing was successful.
+   * @param mode Whether to send all variables, or skip unchanged ones.
+   * @return true if a message was published.
    */
-  bool mqttSend(const VariableGroup& variables, unsigned flags = VariableBase::kNoPublish);
+  bool mqttSend(const VariableGroup& variables, unsigned flags = VariableBase::kNoPublish,
+                SendMode mode = SendMode::kAll);
 
   /** @brief Callback type for received MQTT messages (topic, payload, len). */
   using MqttMsgCallbackFn = std::function<void(const char*, const char*, size_t)>;
@@ -182,6 +199,8 @@ class MqttManager : public Module {
   EnumStrVariable<ConnectionStatus> m_connected;
 
   String m_will_topic;
+  // mqttSend() writes group JSON here, rather than on the small ESP8266 stack.
+  std::unique_ptr<char[]> m_json_buffer;
 
   std::vector<std::function<void()>> m_connectCallbacks;
   std::vector<std::function<void()>> m_disconnectCallbacks;
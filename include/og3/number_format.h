@@ -0,0 +1,50 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Number formatting and parsing into caller buffers, without printf or the heap.
+ *
+ * The format functions work like snprintf(): they write as much as fits, always
+ * NUL-terminate when len > 0, and return the length of the full text, so the output was
+ * truncated if the result is not less than len.
+ *
+ * The parse functions read text of a given length, which need not be NUL-terminated.
+ * Like sscanf(), they skip leading spaces and stop at the first character which is not
+ * part of the number; they fail if there is no number, or it is out of range.
+ */
+namespace og3 {
+
+/** @brief Copies text into a buffer. */
+std::size_t formatText(char* buf, std::size_t len, const char* text);
+/** @brief Formats an integer in decimal. */
+std::size_t formatUnsigned(char* buf, std::size_t len, unsigned long long val);
+/** @brief Formats an integer in decimal. */
+std::size_t formatInt(char* buf, std::size_t len, long long val);
+/**
+ * @brief Formats a number with a fixed number of decimals, as printf("%.*f") does.
+ *
+ * The number is scaled by 10^decimals and rounded to an integer, which is then written
+ * digit by digit; only numbers which scale to 9e18 or more go through snprintf(). The
+ * rounding may differ from printf() in the last digit for values very close to halfway
+ * between two outputs. A value which rounds to zero is written without a sign, and NaN
+ * and infinity as "nan", "inf" and "-inf".
+ */
+std::size_t formatFixed(char* buf, std::size_t len, double val, unsigned decimals);
+
+/** @brief Parses a decimal integer with an optional sign. */
+bool parseInt(const char* text, std::size_t len, long long* out);
+/** @brief Parses a decimal integer with an optional '+'. */
+bool parseUnsigned(const char* text, std::size_t len, unsigned long long* out);
+/**
+ * @brief Parses a decimal number with an optional sign, fraction and exponent.
+ *
+ * Numbers with at most 15 significant digits and a power of ten of at most 22 are
+ * converted exactly with one multiplication or division; others go through strtod().
+ */
+bool parseDouble(const char* text, std::size_t len, double* out);
+
+}  // namespace og3
@@ -46,8 +46,8 @@ class Pir : public Module {
   /**
    * @brief Registers a callback to be executed when motion is detected.
    *
-   * This sets up a hardware interrupt. The callback is scheduled via the
-   * Tasks system to avoid running complex logic inside the ISR.
+   * This sets up a hardware interrupt for this sensor's pin. The callback is
+   * scheduled via Tasks::run_next() to avoid running complex logic inside the ISR.
    * @param fn The callback function.
    */
   void callOnMotion(const Thunk& fn);
@@ -56,13 +56,14 @@ class Pir : public Module {
   bool haDeclare(HADiscovery* had, JsonObject json);
 
 #ifndef NATIVE
-  static void IRAM_ATTR _onMotion();
+  static void IRAM_ATTR _onMotion(void* pir);
 #endif
-
-  static bool s_interrupt_setup;
+  static void runMotionCallback(void* pir);
 
   HADiscovery* m_ha_discovery = nullptr;
   DIn m_din;
+  Thunk m_motion_callback;
+  bool m_interrupt_setup = false;
 };
 
 }  // namespace og3
@@ -44,13 +44,13 @@ class Relay : public DOut {
   bool turnOn(int on_msec = 0, const std::function<void()>& off_fn = nullptr);
 
   /**
-   * @brief Schedules the relay to turn off.
+   * @brief Schedules the relay to turn off, replacing any earlier scheduled turn-off.
    * @param msec Time from now to turn off.
    * @param fn Optional callback.
    */
   void turnOffIn(int msec, const std::function<void()>& fn = nullptr);
 
-  /** @brief Immediately turns the relay off. */
+  /** @brief Immediately turns the relay off, cancelling any scheduled turn-off. */
   void turnOff();
 
   /** @return true if the relay is currently energized. */
@@ -64,6 +64,7 @@ class Relay : public DOut {
   unsigned long m_last_on_msec = 0;
   std::function<void()> m_off_callback;
   Tasks* m_tasks;
+  TaskHandle m_off_task;
 };
 
 }  // namespace og3
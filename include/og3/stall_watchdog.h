@@ -0,0 +1,166 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#if defined(NATIVE)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+#include <Arduino.h>
+#include <osapi.h>
+#endif
+
+#include "og3/dispatch_trace.h"
+#include "og3/module.h"
+#include "og3/tasks.h"
+#include "og3/variable.h"
+
+namespace og3 {
+
+/**
+ * @brief Detects loop stalls and names the update function or task which caused them.
+ *
+ * A monitor thread samples ModuleSystem::dispatch_trace() every check_msec. When one
+ * callback has been running for warn_msec, the stall is recorded in memory which
+ * survives a reset: RTC memory on ESP32 and ESP8266, or a file on native builds. If the
+ * callback returns, the record is cleared and the stall is logged from the loop as a
+ * near miss.
+ * If instead the hardware watchdog (see Watchdog) resets the board, the next boot
+ * finds the record, logs which module or task stalled and for how long, and publishes
+ * it in variables(), which AppStatus sends with its own.
+ *
+ * Set warn_msec well below the hardware watchdog timeout, so that a stall is recorded
+ * before the reset. ESP8266 has no threads, so there the monitor is an SDK software
+ * timer (os_timer). It only runs when the stalled callback yields, e.g. in delay() or
+ * while waiting on the network. A callback which spins without yielding is reset by the
+ * ESP8266 software watchdog before it can be recorded.
+ */
+class StallWatchdog : public Module {
+ public:
+  static const char kName[];  ///< @brief "stall_watchdog"
+
+  /** @brief Configuration of a StallWatchdog. */
+  struct Options {
+    unsigned warn_msec = 1000;  ///< Record a callback which runs this long.
+    unsigned check_msec = 100;  ///< Sampling period (0: no monitor thread; call check()).
+    const char* path = "og3_stall.bin";  ///< File for the record on native builds.
+    /// First 4-byte block of ESP8266 RTC user memory (0-127) holding the 11-block record.
+    unsigned rtc_block = 116;
+
+    /** @brief Sets how long a callback may run before it is recorded as a stall. */
+    Options& withWarnMsec(unsigned val) {
+      this->warn_msec = val;
+      return *this;
+    }
+    /** @brief Sets the period of the monitor thread (0: call check() directly). */
+    Options& withCheckMsec(unsigned val) {
+      this->check_msec = val;
+      return *this;
+    }
+    /** @brief Sets the file for the record on native builds. */
+    Options& withPath(const char* val) {
+      this->path = val;
+      return *this;
+    }
+    /** @brief Sets where the record is kept in ESP8266 RTC user memory. */
+    Options& withRtcBlock(unsigned val) {
+      this->rtc_block = val;
+      return *this;
+    }
+  };
+
+  /** @brief A stall, as recorded for the next boot. */
+  struct Record {
+    uint32_t magic;       ///< kMagic if the record is valid.
+    uint8_t kind;         ///< DispatchTrace::Kind of the stalled callback.
+    uint8_t reserved[3];  ///< Unused.
+    uint32_t id;          ///< Task ID, for a task.
+    uint32_t stall_msec;  ///< How long the callback had been running.
+    char module[24];      ///< Name of the module (for an update function).
+    uint32_t check;       ///< Checksum of the fields above.
+  };
+
+  /**
+   * @brief Constructs a StallWatchdog and starts its monitor thread.
+   * @param options Thresholds and record location.
+   * @param tasks The Tasks module of the app.
+   */
+  StallWatchdog(const Options& options, Tasks* tasks);
+  StallWatchdog(const StallWatchdog&) = delete;
+  ~StallWatchdog();
+
+  /**
+   * @brief Samples the dispatch trace once. The monitor thread calls this every
+   * check_msec; with check_msec 0 it may be called directly, e.g. from tests.
+   * @param elapsed_msec Time since the previous call.
+   */
+  void check(unsigned elapsed_msec);
+
+  /** @return The number of stalls past warn_msec which recovered since boot. */
+  unsigned nearMisses() const { return m_num_near_misses.load(); }
+  /** @return true if the previous boot ended with a reset during a stall. */
+  bool resetByStall() const { return m_reset_by_stall; }
+  /** @return The stall which preceded the reset, valid if resetByStall(). */
+  const Record& resetRecord() const { return m_reset_record; }
+
+  /** @return Stall statistics: near misses, and the stall before the last reset. */
+  const VariableGroup& variables() const { return m_vg; }
+
+  /** @brief Checksum used to validate records. */
+  static uint32_t checksum(const Record& record);
+  /** @brief Value of Record::magic for valid records. */
+  static constexpr uint32_t kMagic = 0x0637a11u;
+
+ private:
+  void update();
+  void describe(const Record& record, char* out, std::size_t size) const;
+  bool readRecord(Record* record);
+  void writeRecord(const Record& record);
+  void clearRecord();
+
+  const Options m_options;
+  DispatchTrace& m_trace;
+
+  // Monitor state, owned by the monitor thread.
+  uint32_t m_last_seq = 0;
+  unsigned m_stall_msec = 0;
+  bool m_recorded = false;
+  Record m_stall = {};
+
+  // Handed from the monitor to the loop.
+  std::atomic<unsigned> m_num_near_misses{0};
+  std::atomic<bool> m_near_miss_pending{false};
+  Record m_near_miss = {};
+
+  bool m_reset_by_stall = false;
+  Record m_reset_record = {};
+
+  VariableGroup m_vg;
+  Variable<unsigned> m_near_misses_var;
+  Variable<String> m_reset_stall;
+  Variable<unsigned> m_reset_stall_msec;
+
+#if defined(NATIVE)
+  void monitorMain();
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_stopping = false;
+  std::thread m_monitor;
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  static void monitorTask(void* watchdog);
+  TaskHandle_t m_monitor = nullptr;
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  static void monitorTimer(void* watchdog);
+  os_timer_t m_monitor = {};
+  bool m_monitor_armed = false;
+#endif
+};
+
+}  // namespace og3
@@ -0,0 +1,219 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace og3 {
+
+/**
+ * @brief Lists the modules which a static module depends on.
+ *
+ * A module in a StaticModuleSystem declares its dependencies with a member type,
+ * `using Requires = og3::Requires<A, B>;`, and its init() is then called with
+ * references to the A and B instances: `void init(A& a, B& b)`.
+ */
+template <typename... Deps>
+struct Requires {};
+
+namespace static_modules {
+
+/** @brief Index of T in Ts, or kNotFound. */
+constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+
+template <typename T, typename... Ts>
+struct IndexOf : std::integral_constant<std::size_t, kNotFound> {};
+template <typename T, typename... Ts>
+struct IndexOf<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+template <typename T, typename U, typename... Ts>
+struct IndexOf<T, U, Ts...>
+    : std::integral_constant<std::size_t, IndexOf<T, Ts...>::value == kNotFound
+                                              ? kNotFound
+                                              : 1 + IndexOf<T, Ts...>::value> {};
+
+/** @brief M::Requires, or Requires<> if M declares no dependencies. */
+template <typename M, typename = void>
+struct RequiresOf {
+  using type = Requires<>;
+};
+template <typename M>
+struct RequiresOf<M, std::void_t<typename M::Requires>> {
+  using type = typename M::Requires;
+};
+
+/** @brief Whether every dependency of M is listed before M in Mods. */
+template <typename M, typename Req, typename... Mods>
+struct DepsListedBefore;
+template <typename M, typename... Deps, typename... Mods>
+struct DepsListedBefore<M, Requires<Deps...>, Mods...>
+    : std::bool_constant<((IndexOf<Deps, Mods...>::value < IndexOf<M, Mods...>::value) &&
+                          ...)> {};
+
+// Detects the optional init(Deps&...), start() and update() methods of a module.
+template <typename M, typename Req, typename = void>
+struct HasInit : std::false_type {};
+template <typename M, typename... Deps>
+struct HasInit<M, Requires<Deps...>,
+               std::void_t<decltype(std::declval<M&>().init(std::declval<Deps&>()...))>>
+    : std::true_type {};
+template <typename M, typename = void>
+struct HasStart : std::false_type {};
+template <typename M>
+struct HasStart<M, std::void_t<decltype(std::declval<M&>().start())>> : std::true_type {};
+template <typename M, typename = void>
+struct HasUpdate : std::false_type {};
+template <typename M>
+struct HasUpdate<M, std::void_t<decltype(std::declval<M&>().update())>> : std::true_type {};
+
+/** @brief A candidate table entry: a callback, and whether the module has it. */
+template <typename Fn>
+struct Slot {
+  bool used;
+  Fn fn;
+};
+
+/** @brief Copies the used entries of slots into an array of exactly N callbacks. */
+template <std::size_t N, typename Fn, std::size_t M>
+constexpr std::array<Fn, N> compact(const Slot<Fn> (&slots)[M]) {
+  std::array<Fn, N> out{};
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < M; i++) {
+    if (slots[i].used) {
+      out[n++] = slots[i].fn;
+    }
+  }
+  return out;
+}
+
+}  // namespace static_modules
+
+/**
+ * @brief A module system whose modules are fixed at compile time.
+ *
+ * This is an alternative to ModuleSystem for applications which must not allocate while
+ * booting, such as ESP8266 applications where heap fragmentation before setup() matters.
+ * Instead of registering callbacks from constructors, the modules are listed as template
+ * arguments, in dependency order, and stored by value in the StaticModuleSystem. Each
+ * module is a plain class which may have any of these methods:
+ *
+ *  - `void init(Deps&... deps)`, called with its dependencies (see Requires),
+ *  - `void start()`, and
+ *  - `void update()`.
+ *
+ * The init, start and update tables are constexpr arrays of function pointers holding
+ * only the modules which have each method, so setup() and update() need no lookups, no
+ * sorting and no allocation. A module which is listed before one of its dependencies, or
+ * which requires a module not in the list, fails to compile.
+ *
+ * Example:
+ * @code
+ * og3::StaticModuleSystem<Led, Button, Controller> s_modules;  // Controller requires both.
+ * void setup() { s_modules.setup(); }
+ * void loop() { s_modules.update(); }
+ * @endcode
+ */
+template <typename... Mods>
+class StaticModuleSystem {
+ public:
+  static_assert(sizeof...(Mods) > 0, "A StaticModuleSystem needs at least one module.");
+  static_assert((static_modules::DepsListedBefore<
+                     Mods, typename static_modules::RequiresOf<Mods>::type, Mods...>::value &&
+                 ...),
+                "Each module must be listed after the modules it requires.");
+
+  /** @brief A callback in one of the lifecycle tables. */
+  using Fn = void (*)(StaticModuleSystem* modules);
+
+  /** @brief Default-constructs every module. */
+  StaticModuleSystem() = default;
+  /** @brief Constructs each module from the corresponding argument. */
+  explicit StaticModuleSystem(Mods&&... mods) : m_modules(std::move(mods)...) {}
+  StaticModuleSystem(const StaticModuleSystem&) = delete;
+
+  /** @return The number of modules. */
+  static constexpr std::size_t num_modules() { return sizeof...(Mods); }
+
+  /** @return The instance of module type M. */
+  template <typename M>
+  M& get() {
+    return std::get<M>(m_modules);
+  }
+  /** @return The instance of module type M. */
+  template <typename M>
+  const M& get() const {
+    return std::get<M>(m_modules);
+  }
+
+  /** @brief Calls init() then start() of every module which has them, in list order. */
+  void setup() {
+    for (Fn fn : kInitFns) {
+      fn(this);
+    }
+    for (Fn fn : kStartFns) {
+      fn(this);
+    }
+  }
+
+  /** @brief Calls update() of every module which has it, in list order. */
+  void update() {
+    for (Fn fn : kUpdateFns) {
+      fn(this);
+    }
+  }
+
+ private:
+  template <typename M>
+  static void callInit(StaticModuleSystem* self) {
+    self->template initWith<M>(typename static_modules::RequiresOf<M>::type());
+  }
+  template <typename M, typename... Deps>
+  void initWith(Requires<Deps...>) {
+    if constexpr (static_modules::HasInit<M, Requires<Deps...>>::value) {
+      get<M>().init(get<Deps>()...);
+    }
+  }
+  template <typename M>
+  static void callStart(StaticModuleSystem* self) {
+    if constexpr (static_modules::HasStart<M>::value) {
+      self->template get<M>().start();
+    }
+  }
+  template <typename M>
+  static void callUpdate(StaticModuleSystem* self) {
+    if constexpr (static_modules::HasUpdate<M>::value) {
+      self->template get<M>().update();
+    }
+  }
+
+  using Slot = static_modules::Slot<Fn>;
+  static constexpr Slot kInitSlots[] = {
+      {static_modules::HasInit<Mods, typename static_modules::RequiresOf<Mods>::type>::value,
+       &callInit<Mods>}...};
+  static constexpr Slot kStartSlots[] = {
+      {static_modules::HasStart<Mods>::value, &callStart<Mods>}...};
+  static constexpr Slot kUpdateSlots[] = {
+      {static_modules::HasUpdate<Mods>::value, &callUpdate<Mods>}...};
+
+ public:
+  /** @brief init() callbacks, in list order. */
+  static constexpr auto kInitFns = static_modules::compact<(
+      0 + ... +
+      static_modules::HasInit<Mods, typename static_modules::RequiresOf<Mods>::type>::value)>(
+      kInitSlots);
+  /** @brief start() callbacks, in list order. */
+  static constexpr auto kStartFns =
+      static_modules::compact<(0 + ... + static_modules::HasStart<Mods>::value)>(kStartSlots);
+  /** @brief update() callbacks, in list order. */
+  static constexpr auto kUpdateFns =
+      static_modules::compact<(0 + ... + static_modules::HasUpdate<Mods>::value)>(kUpdateSlots);
+
+ private:
+  std::tuple<Mods...> m_modules;
+};
+
+}  // namespace og3
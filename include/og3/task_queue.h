@@ -3,44 +3,99 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstdio>
-#include <functional>
+#include <utility>
 #include <vector>
 
+#include "og3/inline_function.h"
 #include "og3/util.h"
 
 namespace og3 {
 
+/**
+ * @brief What a periodic task does when it runs more than one period late.
+ */
+enum class MissedTicks : uint8_t {
+  kSkip,   ///< Run once, then continue on the period grid; missed ticks are dropped.
+  kBurst,  ///< Run once for every missed tick, back to back, until caught up.
+  kCount,  ///< Run once, like kSkip, reporting the number of elapsed ticks in TimedThunk::ticks.
+};
+
 /**
  * @brief Represents a callback task scheduled for a specific time.
  */
 struct TimedThunk {
-  unsigned long msec = 0;  ///< Time in milliseconds when the task should run.
-  Thunk thunk = nullptr;   ///< The callback function to execute.
-  unsigned id = 0;         ///< Unique identifier for the task (0 for none).
+  unsigned long msec = 0;         ///< Time in milliseconds when the task should run.
+  TaskThunk thunk = nullptr;      ///< The callback function to execute.
+  unsigned id = 0;                ///< Unique identifier for the task (0 for none).
+  unsigned long period_msec = 0;  ///< Period of a repeating task, or 0 for a one-shot task.
+  unsigned ticks = 1;             ///< Set by takeFirst(): periods elapsed (see MissedTicks).
+};
+
+/**
+ * @brief Refers to one scheduled task in a TaskQueue.
+ *
+ * A handle is the task's pool index plus the generation of that pool node. The
+ * generation changes when the node is freed, so once the task has run (for a one-shot
+ * task), been cancelled or been replaced, the handle is stale and matches nothing,
+ * even after the node is reused. The generation is 32 bits wide, so that it does not
+ * wrap around to match a stale handle while one is still held. A default-constructed
+ * handle refers to no task.
+ */
+struct TaskHandle {
+  int16_t index = -1;  ///< Index of the node in the pool, or -1 for none.
+  uint32_t gen = 0;    ///< Generation of the node when the task was scheduled.
+
+  /** @return true if the handle was returned for a scheduled task. */
+  explicit operator bool() const { return index >= 0; }
 };
 
 /**
- * @brief Manages a priority queue of timed callbacks using a fixed-pool doubly-linked list.
+ * @brief Manages a priority queue of timed callbacks using an indexed binary heap.
  *
  * TaskQueue stores callbacks to be executed at specific times. Tasks can
  * optionally have a unique ID; if a new task is added with an existing ID,
  * it replaces the previous one. This implementation avoids runtime memory
- * allocations by using a pre-allocated pool of nodes.
+ * allocations by using a pre-allocated pool of nodes, and by storing callbacks
+ * as TaskThunk objects, which hold their captures inline rather than on the heap.
+ *
+ * Scheduled nodes are ordered in a binary min-heap of pool indexes, and a
+ * fixed-size open-addressed table maps task IDs to pool nodes. Insert, replace
+ * and remove cost O(log N), so the time spent with interrupts disabled in
+ * Tasks stays bounded as the number of scheduled tasks grows.
+ *
+ * Periodic tasks (insertPeriodic()) stay in the queue: when one is taken to
+ * run, it is rearmed in place for its next period, with missed periods after
+ * a stall computed in O(1) according to its MissedTicks policy.
+ *
+ * A task may be given some slack: permission to run up to slack_msec after its
+ * nominal time. The queue uses the slack to coalesce wakeups (see coalesce()), so
+ * tasks whose windows overlap run together instead of each waking the loop.
  */
 class TaskQueue {
  public:
   /** @brief Pointer/Index type for the internal pool. */
   using NodeIdx = int16_t;
   static constexpr NodeIdx kInvalidIdx = -1;
+  /** @brief Most heap nodes coalesce() visits, which bounds its time with interrupts off. */
+  static constexpr std::size_t kMaxCoalesceSteps = 16;
 
-  /** @brief Internal node structure for the doubly-linked list. */
+  /** @brief Internal node structure for the pool. */
   struct Node {
     TimedThunk data;
-    NodeIdx prev = kInvalidIdx;
-    NodeIdx next = kInvalidIdx;
+    uint32_t seq = 0;                 ///< Insertion order, used to run equal-time tasks FIFO.
+    NodeIdx heap_pos = kInvalidIdx;   ///< Position in the heap, or kInvalidIdx if not queued.
+    NodeIdx next_free = kInvalidIdx;  ///< Next node in the free list.
+    uint32_t gen = 0;                 ///< Incremented each time the node is freed.
+    MissedTicks policy = MissedTicks::kSkip;
+    unsigned long due_msec = 0;    ///< Nominal time, before slack; periods step from this.
+    unsigned long slack_msec = 0;  ///< How late the task may run to share a wakeup.
   };
 
+  /** @brief Identifies a periodic task whose callback was lent out by takeFirst(). */
+  using Loan = TaskHandle;
+
   /** @brief Constructs a TaskQueue with a fixed capacity. */
   explicit TaskQueue(std::size_t capacity);
   TaskQueue(const TaskQueue&) = delete;
@@ -56,14 +111,14 @@ class TaskQueue {
   bool full() const { return size() == capacity(); }
 
   /** @return Constant reference to the next task to run. */
-  const TimedThunk& first() const { return m_pool[m_head].data; }
+  const TimedThunk& first() const { return m_pool[m_heap[0]].data; }
   /** @return Reference to the next task to run. */
-  TimedThunk& first() { return m_pool[m_head].data; }
+  TimedThunk& first() { return m_pool[m_heap[0]].data; }
   /** @return Timestamp of the next task, or 0 if empty. */
   unsigned long nextMsec() const { return empty() ? 0 : first().msec; }
 
   /**
-   * @brief Access a task by logical index (O(N)).
+   * @brief Access a task by logical (time-sorted) index (O(N^2)).
    * This is primarily for test compatibility and debugging.
    * @param idx Logical index from 0 to size() - 1.
    * @return Reference to the TimedThunk.
@@ -74,57 +129,153 @@ class TaskQueue {
   /**
    * @brief Schedules a task.
    * @param msec Target system time (millis).
-   * @param t The callback.
+   * @param t The callback, which is moved into the queue.
    * @param id Optional task ID.
-   * @return true if successfully inserted.
+   * @param slack_msec How much later than msec the task may run (see coalesce()).
+   * @return A handle to the task, which is false if the queue was full.
    */
-  bool insert(unsigned long msec, const Thunk& t, unsigned id = 0);
+  TaskHandle insert(unsigned long msec, TaskThunk t, unsigned id = 0,
+                    unsigned long slack_msec = 0);
 
   /**
    * @brief Schedules a task, replacing any existing task with the same ID.
    * @param msec Target system time (millis).
-   * @param t The callback.
+   * @param t The callback, which is moved into the queue.
+   * @param id Task ID.
+   * @param slack_msec How much later than msec the task may run (see coalesce()).
+   * @return A handle to the task, which is false if it could not be inserted.
+   */
+  TaskHandle insertReplace(unsigned long msec, TaskThunk t, unsigned id = 0,
+                           unsigned long slack_msec = 0);
+
+  /**
+   * @brief Schedules a repeating task, replacing any existing task with the same ID.
+   * @param msec Target system time (millis) of the first run.
+   * @param period_msec Time between runs; 0 schedules a one-shot task.
+   * @param t The callback, which is moved into the queue.
    * @param id Task ID.
+   * @param policy What to do about periods missed while the loop was stalled.
+   * @param slack_msec How much later than each nominal run time the task may run.
+   *  Slack does not accumulate: each period is measured from the nominal time.
+   * @return A handle to the task, which stays valid across runs until the task is removed.
+   */
+  TaskHandle insertPeriodic(unsigned long msec, unsigned long period_msec, TaskThunk t,
+                            unsigned id = 0, MissedTicks policy = MissedTicks::kSkip,
+                            unsigned long slack_msec = 0);
+
+  /**
+   * @brief Chooses when to run a task which may run anywhere in [msec, msec + slack_msec].
+   *
+   * If a queued task runs in the window, its time is chosen, so that both tasks run in
+   * one wakeup. The search visits at most kMaxCoalesceSteps heap nodes, skipping the
+   * subtrees which start after the window, and stops at the first task it finds in the
+   * window. Otherwise, the task keeps its own time.
+   * @return The time to run the task; msec if slack_msec is 0 or no task was found.
    */
-  void insertReplace(unsigned long msec, const Thunk& t, unsigned id = 0);
+  unsigned long coalesce(unsigned long msec, unsigned long slack_msec) const;
+
+  /** @return The number of heap nodes visited by the last coalesce() (for tests). */
+  std::size_t coalesceSteps() const { return m_coalesce_steps; }
 
   /**
-   * @brief Removes a task by ID.
+   * @brief Removes a task by ID (O(log N)).
    * @param id The ID to remove.
    * @return true if a task was found and removed.
    */
   bool remove(unsigned id);
 
+  /** @return true if a task with the given ID is scheduled (O(1)). */
+  bool contains(unsigned id) const { return findId(id) != kInvalidIdx; }
+
+  /** @return true if the task referred to by handle is still scheduled (O(1)). */
+  bool pending(TaskHandle handle) const { return nodeOf(handle) != kInvalidIdx; }
+
+  /**
+   * @brief Removes the task referred to by handle. Finding it is O(1); removal is O(log N).
+   * @return true if the task was still scheduled.
+   */
+  bool cancel(TaskHandle handle);
+
+  /**
+   * @brief Moves the task referred to by handle to a new time, keeping its callback,
+   *  ID, slack and period. The handle stays valid.
+   * @return true if the task was still scheduled.
+   */
+  bool reschedule(TaskHandle handle, unsigned long msec);
+
   /**
-   * @brief Executes the next scheduled task if its time has arrived.
+   * @brief Executes the next scheduled task, whatever its time.
    * @return true if a task was executed.
    */
   bool runNext();
 
+  /**
+   * @brief Takes the next scheduled task so that the caller can run it.
+   *
+   * A one-shot task is removed from the queue. A periodic task is rearmed in
+   * place for its next run after now, and its callback is lent to the caller:
+   * pass it back with giveBack() after running it.
+   * @param now The current time, used to compute missed periods.
+   * @param t Receives the task. t->ticks is set as described by MissedTicks.
+   * @param loan Receives what giveBack() needs to return a periodic callback.
+   */
+  void takeFirst(unsigned long now, TimedThunk* t, Loan* loan);
+
+  /**
+   * @brief Returns a periodic task's callback lent out by takeFirst().
+   *
+   * If the task was removed or replaced while its callback ran, the callback is dropped.
+   * @param loan The loan filled in by takeFirst().
+   * @param thunk The callback, which is moved back into the queue.
+   */
+  void giveBack(const Loan& loan, TaskThunk* thunk);
+
   /** @brief Removes the next scheduled task without executing it. */
   void popFirst();
 
-  /** @brief Removes the last scheduled task (the one furthest in the future). */
+  /**
+   * @brief Removes the last scheduled task (the one furthest in the future).
+   * This scans the leaves of the heap (O(N)); it is only needed when the queue is full.
+   */
   void popLast();
 
-  /** @brief Debug utility to print the queue state. */
+  /** @brief Debug utility to print the queue state (in heap order). */
   void show() const;
 
   /** @return Generates a new unique task ID. */
   unsigned getId() { return m_first_id++; }
 
  private:
+  NodeIdx nodeOf(TaskHandle handle) const;
+  TaskHandle handleOf(NodeIdx idx) const;
   NodeIdx allocNode();
   void freeNode(NodeIdx idx);
-  void linkBefore(NodeIdx nodeIdx, NodeIdx beforeIdx);
-  void linkAfter(NodeIdx nodeIdx, NodeIdx afterIdx);
-  void unlink(NodeIdx idx);
+  TaskHandle insertNode(unsigned long msec, TaskThunk* t, unsigned id,
+                        unsigned long period_msec, MissedTicks policy, unsigned long slack_msec);
+  unsigned long coalesceExcept(unsigned long msec, unsigned long slack_msec, NodeIdx self) const;
+
+  // Heap helpers.
+  bool before(NodeIdx a, NodeIdx b) const;
+  void placeAt(std::size_t pos, NodeIdx node);
+  void siftUp(std::size_t pos);
+  void siftDown(std::size_t pos);
+  void removeAt(std::size_t pos);
+  std::size_t lastPos() const;
+  std::size_t rank(NodeIdx node) const;
+
+  // ID index helpers.
+  std::size_t idSlot(unsigned id) const;
+  NodeIdx findId(unsigned id) const;
+  void indexId(NodeIdx node);
+  void unindexId(NodeIdx node);
 
   std::vector<Node> m_pool;
-  NodeIdx m_head = kInvalidIdx;
-  NodeIdx m_tail = kInvalidIdx;
+  std::vector<NodeIdx> m_heap;      ///< Min-heap of pool indexes; the first m_size are valid.
+  std::vector<NodeIdx> m_id_table;  ///< Open-addressed map of task ID -> pool index.
   NodeIdx m_free_head = kInvalidIdx;
   std::size_t m_size = 0;
+  uint32_t m_seq = 0;
+  mutable std::size_t m_coalesce_steps = 0;
 
   unsigned m_first_id = 200;
 };
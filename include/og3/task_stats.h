@@ -0,0 +1,99 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "og3/log_histogram.h"
+#include "og3/variable.h"
+
+namespace og3 {
+
+/**
+ * @brief Scheduling lateness and run-time statistics for tasks, per task ID.
+ *
+ * Tasks records each callback it runs here when built with OG3_TASK_STATS defined.
+ * Lateness is how long after its scheduled time a task started, in milliseconds;
+ * run time is how long the callback took, in microseconds. Both are kept in
+ * LogHistograms, overall and for up to maxTaskIds() task IDs (tasks without an ID
+ * share ID 0). Tasks sizes the table for one entry per task its queue holds, plus ID 0,
+ * so every task queued at once is tracked. Each entry takes about 120 bytes, all
+ * allocated by the constructor. Tasks with IDs beyond the table, such as IDs first seen
+ * after the table filled, are only counted overall. Entries are found through a hash
+ * table of IDs, so recording costs the same for 200 tasks as for 10.
+ *
+ * update() summarizes the histograms into a VariableGroup which AppStatus publishes.
+ */
+class TaskStats {
+ public:
+  /** @brief Default number of task IDs tracked separately. */
+  static constexpr std::size_t kDefaultMaxTaskIds = 16;
+
+  /** @brief Statistics for one task ID. */
+  struct Entry {
+    unsigned id = 0;             ///< The task ID.
+    LogHistogram lateness_msec;  ///< Time from scheduled time to start of the callback.
+    LogHistogram run_usec;       ///< Time spent in the callback.
+  };
+
+  /**
+   * @brief Constructs a TaskStats object.
+   * @param name Name of the VariableGroup for the summary.
+   * @param max_task_ids Number of task IDs tracked separately.
+   */
+  explicit TaskStats(const char* name = "task_stats",
+                     std::size_t max_task_ids = kDefaultMaxTaskIds);
+  TaskStats(const TaskStats&) = delete;
+
+  /**
+   * @brief Records one run of a task.
+   * @param id The task ID (0 for none).
+   * @param lateness_msec Milliseconds from the scheduled time to the start of the run.
+   * @param run_usec Microseconds spent running the callback.
+   */
+  void record(unsigned id, unsigned long lateness_msec, unsigned long run_usec);
+
+  /** @return Statistics for a task ID, or nullptr if it is not tracked. */
+  const Entry* find(unsigned id) const;
+  /** @return The number of task IDs tracked separately. */
+  std::size_t numEntries() const { return m_num_entries; }
+  /** @return The most task IDs which can be tracked separately. */
+  std::size_t maxTaskIds() const { return m_entries.size(); }
+  /** @return Lateness histogram over all tasks. */
+  const LogHistogram& lateness() const { return m_lateness; }
+  /** @return Run-time histogram over all tasks. */
+  const LogHistogram& runtime() const { return m_runtime; }
+
+  /** @brief Updates the summary variables from the histograms. */
+  void update();
+  /** @brief Clears all statistics. */
+  void reset();
+
+  /** @return Summary variables: p50/p99/max lateness and run time, and the slowest task. */
+  const VariableGroup& variables() const { return m_vg; }
+
+ private:
+  std::size_t slotOf(unsigned id) const;
+
+  std::vector<Entry> m_entries;
+  std::size_t m_num_entries = 0;
+  // Open-addressed hash table of entry index + 1 by task ID; 0 marks an empty slot.
+  std::vector<uint16_t> m_index;
+  LogHistogram m_lateness;
+  LogHistogram m_runtime;
+
+  VariableGroup m_vg;
+  Variable<unsigned> m_late_p50;
+  Variable<unsigned> m_late_p99;
+  Variable<unsigned> m_late_max;
+  Variable<unsigned> m_run_p50;
+  Variable<unsigned> m_run_p99;
+  Variable<unsigned> m_run_max;
+  Variable<unsigned> m_slowest_id;
+  Variable<unsigned> m_slowest_usec;
+};
+
+}  // namespace og3
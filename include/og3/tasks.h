@@ -3,8 +3,15 @@
 
 #pragma once
 
+#include <utility>
+
+#include "og3/isr_event_queue.h"
+#include "og3/loop_stats.h"
 #include "og3/module.h"
 #include "og3/task_queue.h"
+#ifdef OG3_TASK_STATS
+#include "og3/task_stats.h"
+#endif
 
 namespace og3 {
 
@@ -14,24 +21,102 @@ namespace og3 {
  * The Tasks module manages a TaskQueue and provides an interface for
  * scheduling one-shot tasks. It integrates with the main application loop
  * to execute tasks whose scheduled time has passed.
+ *
+ * Interrupt handlers hand work to the loop with run_next(), which posts to a
+ * shared lock-free IsrEventQueue that loop() drains before running timed tasks.
+ *
+ * Between loops, idle() can block until the next task is due instead of
+ * spinning. Scheduling an earlier task, run_next() and wake() end the wait early.
+ *
+ * A loop budget (setLoopBudget()) bounds how long one call to loop() may spend on
+ * timed tasks during a burst. Due tasks beyond the budget are left in the queue,
+ * in order, for the next loop, and deferrals() counts the loops which left work.
+ *
+ * When built with OG3_TASK_STATS defined, loop() records the lateness and run
+ * time of each task in stats(), which tracks as many task IDs as the queue holds tasks.
+ * Without it, no measurement code is compiled in.
+ *
+ * When loopStats() is enabled, loop() adds the time it spends to it, and App::loop()
+ * records each iteration there.
  */
 class Tasks : public Module {
  public:
   static const char* kName;  ///< @brief "tasks"
+  /** @brief Number of interrupt events which may be pending between loops. */
+  static constexpr std::size_t kIsrEventCapacity = 16;
 
   /**
-   * @brief Direct way to schedule a task from an interrupt context.
-   * @param thunk The callback to run in the next loop.
+   * @brief Schedules a callback from an interrupt context to run in the next loop.
+   *
+   * This does not allocate or block. Events posted by several interrupts before
+   * the next loop are all run, in order, up to kIsrEventCapacity.
+   * @param fn The function to call from loop().
+   * @param ctx Argument passed to fn.
+   * @return false if the event queue was full and the event was dropped.
    */
-  static void run_next(const Thunk& thunk) { s_run_next = thunk; }
+  static bool run_next(IsrEventFn fn, void* ctx);
+
+  /** @return The number of interrupt events dropped because the queue was full. */
+  static uint32_t isrEventsDropped() { return s_isr_events.dropped(); }
+
+  /**
+   * @brief Ends a wait in idle() early.
+   *
+   * Safe to call from interrupt handlers and from other tasks/threads, such as
+   * network callbacks which change state that loop() should act on.
+   */
+  static void wake();
 
   /** @brief Constructs a Tasks module with a given capacity. */
   Tasks(std::size_t capacity, ModuleSystem* module_system);
 
-  /** @brief Schedules a task to run at an absolute timestamp. */
-  void runAt(unsigned long msec, const Thunk& thunk, unsigned id = 0);
-  /** @brief Schedules a task to run after a delay from now. */
-  void runIn(unsigned long msec, const Thunk& thunk, unsigned id = 0);
+  /**
+   * @brief Schedules a task to run at an absolute timestamp.
+   * @param msec Time (millis) to run the task.
+   * @param thunk The callback.
+   * @param id Task ID, which can be used to replace or cancel the task.
+   * @param slack_msec How much later than msec the task may run, so that it can share
+   *  a wakeup with other tasks (see TaskQueue::coalesce()).
+   * @return A handle for cancel() and reschedule(), which is false if the queue was full.
+   */
+  TaskHandle runAt(unsigned long msec, TaskThunk thunk, unsigned id = 0,
+                   unsigned long slack_msec = 0);
+  /** @brief Schedules a task to run after a delay from now (see runAt()). */
+  TaskHandle runIn(unsigned long msec, TaskThunk thunk, unsigned id = 0,
+                   unsigned long slack_msec = 0);
+
+  /**
+   * @brief Schedules a task to run repeatedly, replacing any task with the same ID.
+   * @param msec Time (millis) of the first run.
+   * @param period_msec Time between runs; 0 runs the task once.
+   * @param thunk The callback.
+   * @param id Task ID, which can be used to replace or cancel the task.
+   * @param policy What to do about periods missed while the loop was stalled.
+   * @param slack_msec How much later than each nominal run time the task may run.
+   * @return A handle which stays valid until the task is cancelled or replaced.
+   */
+  TaskHandle runPeriodicAt(unsigned long msec, unsigned long period_msec, TaskThunk thunk,
+                           unsigned id = 0, MissedTicks policy = MissedTicks::kSkip,
+                           unsigned long slack_msec = 0);
+
+  /**
+   * @brief Cancels a scheduled task.
+   * @return true if the task was still scheduled; false if it already ran or was replaced.
+   */
+  bool cancel(TaskHandle handle);
+  /**
+   * @brief Moves a scheduled task to a new time (millis), keeping its callback.
+   * @return true if the task was still scheduled.
+   */
+  bool reschedule(TaskHandle handle, unsigned long msec);
+  /** @return true if the task is still scheduled. */
+  bool pending(TaskHandle handle) const;
+
+  /**
+   * @return Periods elapsed for the task now running, as reported for
+   *  MissedTicks::kCount tasks (1 for all other tasks).
+   */
+  unsigned currentTicks() const { return m_current_ticks; }
 
   /** @return Generates a unique ID for scheduling related tasks. */
   unsigned getId() { return m_queue.getId(); }
@@ -44,30 +129,79 @@ class Tasks : public Module {
   /** @return Constant reference to the underlying queue. */
   const TaskQueue& queue() const { return m_queue; }
 
+  /** @return Loop rate and iteration-time statistics of the app's loop. */
+  LoopStats& loopStats() { return m_loop_stats; }
+
+#ifdef OG3_TASK_STATS
+  /** @return Lateness and run-time statistics of tasks run by loop(). */
+  TaskStats& stats() { return m_stats; }
+#endif
+
+  /**
+   * @brief Limits the timed tasks run by one call to loop().
+   *
+   * At least one due task always runs, so that the queue makes progress.
+   * @param max_usec Stop running tasks after this much time (0: no limit).
+   * @param max_tasks Stop running tasks after this many (0: no limit).
+   */
+  void setLoopBudget(unsigned long max_usec, unsigned max_tasks);
+  /** @return The number of calls to loop() which left due tasks for the next loop. */
+  unsigned long deferrals() const { return m_deferrals; }
+
   /**
-   * @brief Executes all due tasks. Should be called in loop().
+   * @brief Executes due tasks, within the loop budget. Should be called in loop().
    * @return Number of tasks executed.
    */
   int loop();
 
+  /**
+   * @brief Computes how long the loop may sleep.
+   * @param now The current time (millis).
+   * @param max_msec The maximum value to return.
+   * @return Milliseconds until the next task is due (0 if one is due or an
+   *  interrupt event is pending), capped at max_msec.
+   */
+  unsigned long msecUntilNext(unsigned long now, unsigned long max_msec) const;
+
+  /**
+   * @brief Blocks until the next task is due, wake() is called, or max_msec passes.
+   *
+   * On ESP32 this blocks the loop task on a task notification so the idle task
+   * can run, on ESP8266 it yields to the system with esp_delay(), and on native
+   * it waits on a condition variable.
+   * @param max_msec The longest time to wait.
+   */
+  void idle(unsigned long max_msec);
+
  private:
-  bool getThunk(unsigned long now, Thunk* t);
+  bool getThunk(unsigned long now, TimedThunk* t, TaskQueue::Loan* loan);
+  bool isDue(unsigned long now) const;
+  void giveBack(const TaskQueue::Loan& loan, TaskThunk* thunk);
 
-  static Thunk s_run_next;
+  static IsrEventQueue s_isr_events;
 
+#ifdef OG3_TASK_STATS
+  TaskStats m_stats;
+#endif
   TaskQueue m_queue;
+  unsigned m_current_ticks = 1;
+  unsigned long m_budget_usec = 0;
+  unsigned m_budget_tasks = 0;
+  unsigned long m_deferrals = 0;
+  LoopStats m_loop_stats;
 };
 
 /**
- * @brief Helper for scheduling tasks with a consistent unique ID.
+ * @brief Helper for scheduling a task which replaces its own earlier schedule.
  *
- * This ensures that subsequent calls to `runAt` or `runIn` will replace
- * the previously scheduled task for this specific scheduler instance.
+ * Each call to `runAt` or `runIn` cancels the task previously scheduled by this
+ * TaskIdScheduler, if it has not run yet, using its TaskHandle. Other tasks are never
+ * affected, even when the queue reuses the cancelled task's slot.
  */
 class TaskIdScheduler {
  public:
   /** @brief Constructs a TaskIdScheduler. */
-  explicit TaskIdScheduler(Tasks* tasks) : m_tasks(tasks), m_id(tasks ? tasks->getId() : 0) {}
+  explicit TaskIdScheduler(Tasks* tasks) : m_tasks(tasks) {}
 
   /** @brief Late-initialization of the tasks module pointer. */
   void setTasks(Tasks* tasks) {
@@ -75,27 +209,44 @@ class TaskIdScheduler {
       return;
     }
     m_tasks = tasks;
-    m_id = tasks->getId();
   }
-  /** @brief Schedules the task at an absolute time. */
-  void runAt(unsigned long msec, const Thunk& thunk) {
+  /** @brief Schedules the task at an absolute time, optionally with slack. */
+  void runAt(unsigned long msec, TaskThunk thunk, unsigned long slack_msec = 0) {
+    if (m_tasks) {
+      m_tasks->cancel(m_handle);
+      m_handle = m_tasks->runAt(msec, std::move(thunk), 0, slack_msec);
+    }
+  }
+  /** @brief Schedules the task after a delay, optionally with slack. */
+  void runIn(unsigned long msec, TaskThunk thunk, unsigned long slack_msec = 0) {
     if (m_tasks) {
-      m_tasks->runAt(msec, thunk, m_id);
+      m_tasks->cancel(m_handle);
+      m_handle = m_tasks->runIn(msec, std::move(thunk), 0, slack_msec);
     }
   }
-  /** @brief Schedules the task after a delay. */
-  void runIn(unsigned long msec, const Thunk& thunk) {
+  /** @brief Schedules the task to repeat every period_msec, starting at an absolute time. */
+  void runPeriodicAt(unsigned long msec, unsigned long period_msec, TaskThunk thunk,
+                     MissedTicks policy = MissedTicks::kSkip, unsigned long slack_msec = 0) {
     if (m_tasks) {
-      m_tasks->runIn(msec, thunk, m_id);
+      m_tasks->cancel(m_handle);
+      m_handle =
+          m_tasks->runPeriodicAt(msec, period_msec, std::move(thunk), 0, policy, slack_msec);
     }
   }
+  /**
+   * @brief Cancels the scheduled task.
+   * @return true if it had not run yet.
+   */
+  bool cancel() { return m_tasks && m_tasks->cancel(m_handle); }
+  /** @return true if the task is scheduled and has not run yet. */
+  bool pending() const { return m_tasks && m_tasks->pending(m_handle); }
 
   /** @return Pointer to the associated Tasks module. */
   const Tasks* tasks() const { return m_tasks; }
 
  private:
   Tasks* m_tasks;
-  unsigned m_id;
+  TaskHandle m_handle;
 };
 
 /**
@@ -104,28 +255,53 @@ class TaskIdScheduler {
 class TaskScheduler {
  public:
   /** @brief Constructs a TaskScheduler. */
-  TaskScheduler(const Thunk& thunk, Tasks* tasks) : m_thunk(thunk), m_scheduler(tasks) {}
+  TaskScheduler(TaskThunk thunk, Tasks* tasks) : m_thunk(std::move(thunk)), m_scheduler(tasks) {}
 
   void setTasks(Tasks* tasks) { m_scheduler.setTasks(tasks); }
-  /** @brief Schedules the fixed callback at an absolute time. */
-  void runAt(unsigned long msec) { m_scheduler.runAt(msec, m_thunk); }
-  /** @brief Schedules the fixed callback after a delay. */
-  void runIn(unsigned long msec) { m_scheduler.runIn(msec, m_thunk); }
+  /** @brief Schedules the fixed callback at an absolute time, optionally with slack. */
+  void runAt(unsigned long msec, unsigned long slack_msec = 0) {
+    m_scheduler.runAt(msec, [this]() { m_thunk(); }, slack_msec);
+  }
+  /** @brief Schedules the fixed callback after a delay, optionally with slack. */
+  void runIn(unsigned long msec, unsigned long slack_msec = 0) {
+    m_scheduler.runIn(msec, [this]() { m_thunk(); }, slack_msec);
+  }
+  /** @brief Cancels the scheduled callback. @return true if it had not run yet. */
+  bool cancel() { return m_scheduler.cancel(); }
+  /** @return true if the callback is scheduled and has not run yet. */
+  bool pending() const { return m_scheduler.pending(); }
   const Tasks* tasks() const { return m_scheduler.tasks(); }
 
  private:
-  const Thunk m_thunk;
+  const TaskThunk m_thunk;
   TaskIdScheduler m_scheduler;
 };
 
 /**
  * @brief Automatically reschedules a task to run at fixed intervals.
+ *
+ * The task is a periodic entry in the TaskQueue which is rearmed in place after
+ * each run. If the loop stalls for more than a period, the MissedTicks policy
+ * decides whether missed runs are skipped, run back to back, or counted.
+ *
+ * Giving the task some slack lets each run be delayed by up to slack_msec to share a
+ * wakeup with other tasks. The period is still measured from the nominal run times,
+ * so slack does not make the task drift.
  */
 class PeriodicTaskScheduler {
  public:
-  /** @brief Constructs a PeriodicTaskScheduler. */
-  PeriodicTaskScheduler(unsigned msec_initial, unsigned period_msec, const Thunk& thunk,
-                        Tasks* tasks);
+  /**
+   * @brief Constructs a PeriodicTaskScheduler.
+   * @param msec_initial Delay before the first run.
+   * @param period_msec Time between runs; 0 runs the callback once.
+   * @param thunk The callback.
+   * @param tasks The Tasks module, which may be set later with setTasks().
+   * @param policy What to do about periods missed while the loop was stalled.
+   * @param slack_msec How much later than its nominal time each run may start.
+   */
+  PeriodicTaskScheduler(unsigned msec_initial, unsigned period_msec, TaskThunk thunk,
+                        Tasks* tasks, MissedTicks policy = MissedTicks::kSkip,
+                        unsigned slack_msec = 0);
 
   void setTasks(Tasks* tasks_);
 
@@ -134,15 +310,21 @@ class PeriodicTaskScheduler {
   /** @brief Manually reschedules the next execution after a delay. */
   void runIn(unsigned long msec);
 
+  /**
+   * @return When called from the callback of a MissedTicks::kCount scheduler, the
+   *  number of periods elapsed since the previous run (1 when on time).
+   */
+  unsigned ticks() const;
+
  private:
   void start(unsigned long msec);
-  void cycle();
 
   TaskIdScheduler m_scheduler;
-  const Thunk m_thunk;
+  const TaskThunk m_thunk;
   const unsigned m_initial_msec;
   const unsigned m_period_msec;
-  unsigned m_prev_msec = 0;
+  const MissedTicks m_policy;
+  const unsigned m_slack_msec;
 };
 
 }  // namespace og3
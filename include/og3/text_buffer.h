@@ -34,6 +34,16 @@ class TextBufferBase {
   /** @return Constant pointer to the raw character buffer. */
   const char* text() const { return m_buffer; }
 
+  /** @return Where appended text goes: the end of the text, or of the buffer if full. */
+  char* tail() { return m_buffer + (m_len < m_buffer_len ? m_len : m_buffer_len); }
+  /** @return Bytes left for appending at tail(), including the terminating NUL. */
+  unsigned available() const { return m_len < m_buffer_len ? m_buffer_len - m_len : 0; }
+  /**
+   * @brief Accounts for text written directly at tail(), such as by a JsonWriter.
+   * @param len Length of that text; as with addf(), length() may then exceed size().
+   */
+  void extend(unsigned len) { m_len += len; }
+
   /** @brief Appends a C-string to the buffer. */
   int add(const char* text);
   /** @brief Appends formatted text (printf-style) to the buffer. */
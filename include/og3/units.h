@@ -37,6 +37,7 @@ extern const char kMetersPerSecond[];    ///< "m/s"
 extern const char kKilometersPerHour[];  ///< "km/h"
 extern const char kMilesPerHour[];       ///< "mph"
 extern const char kDecibel[];            ///< "dB"
+extern const char kBytes[];              ///< "B"
 extern const char kKilobytes[];          ///< "kB"
 extern const char kMegabytes[];          ///< "MB"
 
@@ -3,20 +3,18 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <limits>
-#include <map>
+#include <vector>
 
 namespace og3 {
 
-class Module;
-
 /** @brief Type for simple parameterless callbacks. */
 using Thunk = std::function<void()>;
 
-/** @brief Map for retrieving modules by their unique names. */
-using NameToModule = std::map<const char*, Module*>;
-
 /**
  * @brief Checks if timestamp t1 is chronologically before t2, handling 32-bit overflow.
  * @param t1 The earlier timestamp (millis).
@@ -28,4 +26,68 @@ inline bool isBefore(unsigned long t1, unsigned long t2) {
   return d < std::numeric_limits<unsigned long>::max() / 2;
 }
 
+/** @brief FNV-1a hash of a NUL-terminated name. */
+inline uint32_t hashName(const char* name) {
+  uint32_t hash = 2166136261u;
+  for (const char* ch = name; *ch; ch++) {
+    hash = (hash ^ static_cast<uint8_t>(*ch)) * 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * @brief Builds an open-addressed hash table of names, such as those of ModuleSystem and
+ * VariableGroup.
+ *
+ * The table size is a power of two with at most 50% load. Each slot holds the index of
+ * a name plus one, or 0 if it is empty. Of several equal names, only the first is entered.
+ * @param table The table to fill.
+ * @param num_names The number of names.
+ * @param name_of Returns the name at an index.
+ * @param on_duplicate Called with the index of each name which was already entered.
+ */
+template <typename NameOf, typename OnDuplicate>
+void buildNameTable(std::vector<uint16_t>* table, std::size_t num_names, const NameOf& name_of,
+                    const OnDuplicate& on_duplicate) {
+  std::size_t size = 1;
+  while (size < 2 * num_names) {
+    size <<= 1;
+  }
+  table->assign(size, 0);
+  const std::size_t mask = size - 1;
+  for (std::size_t i = 0; i < num_names; i++) {
+    const char* name = name_of(i);
+    std::size_t slot = hashName(name) & mask;
+    for (; (*table)[slot] != 0; slot = (slot + 1) & mask) {
+      if (0 == strcmp(name_of((*table)[slot] - 1), name)) {
+        break;
+      }
+    }
+    if ((*table)[slot] != 0) {
+      on_duplicate(i);
+      continue;
+    }
+    (*table)[slot] = static_cast<uint16_t>(i + 1);
+  }
+}
+
+/**
+ * @brief Looks up a name in a table built by buildNameTable().
+ * @param table The table.
+ * @param name The name to find.
+ * @param name_of Returns the name at an index, as given to buildNameTable().
+ * @return The index of the name plus one, or 0 if it is not in the table.
+ */
+template <typename NameOf>
+uint16_t findInNameTable(const std::vector<uint16_t>& table, const char* name,
+                         const NameOf& name_of) {
+  const std::size_t mask = table.size() - 1;
+  for (std::size_t slot = hashName(name) & mask; table[slot] != 0; slot = (slot + 1) & mask) {
+    if (0 == strcmp(name_of(table[slot] - 1), name)) {
+      return table[slot];
+    }
+  }
+  return 0;
+}
+
 }  // namespace og3
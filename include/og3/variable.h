@@ -6,18 +6,60 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <vector>
 
+#include "og3/json_writer.h"
+#include "og3/number_format.h"
+
+// Native builds keep "flash" tables in ordinary memory.
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_ptr
+#define pgm_read_ptr(addr) (*reinterpret_cast<const void* const*>(addr))
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*reinterpret_cast<const uint16_t*>(addr))
+#endif
+
 namespace og3 {
 
+class TextBufferBase;
 class VariableBase;
 
+/**
+ * @brief The constant metadata of a variable.
+ *
+ * An application can declare the descriptors of a group as a `PROGMEM` table, and
+ * construct its variables with an index into it (see VariableGroup). Such a variable
+ * keeps no metadata in RAM. The strings are not read with the `_P` functions, so they
+ * must be ordinary string literals.
+ *
+ * Variables constructed with their name, units and description get a descriptor in a
+ * RAM table of their group instead.
+ */
+struct VariableDescriptor {
+  const char* name;         ///< Unique name within the group.
+  const char* units;        ///< Units of measurement (can be nullptr).
+  const char* description;  ///< Human-readable description (can be nullptr).
+  uint16_t flags;           ///< Behavioral flags (see VariableBase::Flags).
+  uint16_t decimals;        ///< Decimal places of floating-point variables.
+};
+
 /**
  * @brief A collection of variables that can be managed together.
  *
  * A VariableGroup allows grouped operations on variables, such as loading/saving
  * from configuration files, editing via web forms, or publishing to MQTT.
+ *
+ * The group keeps one "changed" bit per variable, set when the variable's value or
+ * failed state changes (see VariableBase::version()) and cleared by clearChanged().
+ * MqttManager uses these bits to skip publishing groups which have not changed, or to
+ * publish only the changed variables. Variables start out marked as changed.
  */
 class VariableGroup {
  public:
@@ -25,9 +67,25 @@ class VariableGroup {
    * @brief Constructs a VariableGroup.
    * @param name The human-readable name of the group.
    * @param id An optional unique identifier for the group (defaults to name).
-   * @param initial_size Initial capacity for the internal variables vector.
+   * @param initial_size Initial capacity for the internal variables vector, and for the
+   *  RAM copies of the variables' descriptors.
    */
   VariableGroup(const char* name, const char* id = nullptr, size_t initial_size = 16);
+  /**
+   * @brief Constructs a VariableGroup whose variables are described by a table.
+   *
+   * Variables constructed with a descriptor index refer to an entry of this table,
+   * which should be declared `static const ... PROGMEM` so that it stays in flash.
+   * @param name The human-readable name of the group.
+   * @param descriptors The descriptor table.
+   * @param id An optional unique identifier for the group (defaults to name).
+   */
+  template <std::size_t N>
+  VariableGroup(const char* name, const VariableDescriptor (&descriptors)[N],
+                const char* id = nullptr)
+      : m_name(name), m_id(id ? id : name), m_table(descriptors), m_table_size(N) {
+    m_variables.reserve(N);
+  }
   VariableGroup(const VariableGroup&) = delete;
 
   /**
@@ -46,22 +104,109 @@ class VariableGroup {
   /** @return Reference to the list of variables in this group. */
   std::vector<VariableBase*>& variables() { return m_variables; }
 
+  /**
+   * @brief Looks up a descriptor.
+   * @param index An index into the table given to the constructor, or one returned by
+   *  addDescriptor().
+   * @return The descriptor, which may be in flash.
+   */
+  const VariableDescriptor& descriptor(uint16_t index) const {
+    return index & kRamDescriptor ? m_descriptors[index & ~kRamDescriptor] : m_table[index];
+  }
+  /** @return The number of entries in the table given to the constructor. */
+  std::size_t table_size() const { return m_table_size; }
+  /** @return true if index refers to a descriptor of this group. */
+  bool hasDescriptor(uint16_t index) const {
+    return index & kRamDescriptor ? (index & ~kRamDescriptor) < m_descriptors.size()
+                                  : index < m_table_size;
+  }
+  /**
+   * @brief Copies a descriptor into the group's RAM table. Called by VariableBase.
+   * @return The index of the copy, for descriptor().
+   */
+  uint16_t addDescriptor(const VariableDescriptor& descriptor);
+
   /** @return The number of variables in this group marked with the kConfig flag. */
   unsigned num_config() const { return m_num_config; }
+  /** @return The number of variables in this group marked with the kSettable flag. */
+  unsigned num_settable() const { return m_num_settable; }
+
+  /**
+   * @brief Finds a variable by name, comparing the name strings.
+   *
+   * The first call after variables are added builds a hash table of their names, after
+   * which a lookup costs one hash and usually one string comparison.
+   * @param name The name of the variable.
+   * @return The variable, or nullptr if no variable in the group has this name.
+   */
+  VariableBase* find(const char* name) const;
+
+  /** @return true if any variable changed since the last clearChanged(). */
+  bool changed() const;
+  /** @return true if the variable at index changed since the last clearChanged(). */
+  bool changed(std::size_t index) const {
+    return m_changed[index / kBitsPerWord] & (1u << (index % kBitsPerWord));
+  }
+  /**
+   * @brief Marks the variable at index as changed. Called by VariableBase.
+   *
+   * The changed bits record what has been published rather than the values, so
+   * they may be updated through a const group.
+   */
+  void setChanged(std::size_t index) const {
+    m_changed[index / kBitsPerWord] |= 1u << (index % kBitsPerWord);
+  }
+  /**
+   * @return true if a variable which toJson() writes with these flags changed since it
+   *   was last published. Failed variables are not written, so they do not count.
+   */
+  bool changedToPublish(unsigned flags) const;
+  /** @brief Marks every variable as published. */
+  void clearChanged() const;
+  /**
+   * @brief Marks the variables which toJson() includes with these flags as published,
+   * leaving the changed bits of the others (e.g. kNoPublish variables) for later.
+   */
+  void clearChanged(unsigned flags) const;
 
   /**
    * @brief Serializes variables in the group to a JSON object.
    * @param out_json The target JSON object.
    * @param flags Filter flags (e.g., VariableBase::kConfig).
+   * @param changed_only Only include variables which changed since clearChanged().
    */
-  void toJson(JsonObject out_json, unsigned flags) const;
+  void toJson(JsonObject out_json, unsigned flags, bool changed_only = false) const;
 
   /**
    * @brief Serializes the group to a JSON string.
    * @param out_str Pointer to the target String.
    * @param flags Filter flags.
+   * @param changed_only Only include variables which changed since clearChanged().
+   */
+  void toJson(String* out_str, unsigned flags, bool changed_only = false) const;
+
+  /**
+   * @brief Writes the group as a JSON object, without building a JsonDocument.
+   *
+   * Produces the same keys as toJson(), but floating-point values are written with
+   * their decimals(). The quoted keys are prepared on the first call, after which
+   * writing does not allocate.
+   * @param out The target writer.
+   * @param flags Filter flags.
+   * @param changed_only Only include variables which changed since clearChanged().
+   */
+  void writeJson(JsonWriter* out, unsigned flags, bool changed_only = false) const;
+  /**
+   * @brief Writes the group as a JSON object into a caller-provided buffer.
+   * @return Length of the full JSON text; it was truncated if this is not less than size.
+   */
+  std::size_t writeJson(char* buffer, std::size_t size, unsigned flags,
+                        bool changed_only = false) const;
+  /**
+   * @brief Appends the group as a JSON object to a text buffer.
+   * @return true if the JSON text fit into the buffer.
    */
-  void toJson(String* out_str, unsigned flags) const;
+  bool writeJson(TextBufferBase* out, unsigned flags, bool changed_only = false) const;
 
   /**
    * @brief Serializes the group to an output stream.
@@ -72,16 +217,39 @@ class VariableGroup {
 
   /**
    * @brief Updates settable variables in the group from a JSON object.
+   *
+   * Each key of the object is looked up with find(), so the cost follows the size of
+   * the object rather than of the group. Keys which name no settable variable are
+   * ignored.
    * @param obj The source JSON object.
    * @return The number of variables successfully updated.
    */
   unsigned updateFromJson(JsonObjectConst obj);
 
  private:
+  static constexpr std::size_t kBitsPerWord = 32;
+  // Marks descriptor indices into m_descriptors rather than m_table.
+  static constexpr uint16_t kRamDescriptor = 0x8000;
+
+  // Whether toJson() and writeJson() include var with these flags.
+  static bool includes(const VariableBase* var, unsigned flags);
+  void buildJsonKeys() const;
+  void buildNameTable() const;
+
   const char* m_name;
   const char* m_id;
   unsigned m_num_config = 0;
+  unsigned m_num_settable = 0;
   std::vector<VariableBase*> m_variables;
+  const VariableDescriptor* m_table = nullptr;  ///< Descriptor table, usually in flash.
+  std::size_t m_table_size = 0;
+  std::vector<VariableDescriptor> m_descriptors;  ///< Descriptors of the other variables.
+  mutable std::vector<uint32_t> m_changed;        ///< One bit per variable.
+  // The quoted key and colon of each variable, `"name":`, back to back, and where each ends.
+  mutable std::vector<char> m_json_keys;
+  mutable std::vector<uint16_t> m_json_key_ends;
+  // Open-addressed hash table of variable index + 1 by name; 0 marks an empty slot.
+  mutable std::vector<uint16_t> m_name_table;
 };
 
 /**
@@ -104,6 +272,12 @@ class VariableBase {
    */
   VariableBase(const char* name_, const char* units_, const char* description_, unsigned flags_,
                VariableGroup& group);
+  /**
+   * @brief Constructs a VariableBase described by an entry of the group's descriptor table.
+   * @param descriptor Index into the table given to the VariableGroup constructor.
+   * @param group The VariableGroup this variable belongs to.
+   */
+  VariableBase(uint16_t descriptor, VariableGroup& group);
 
   virtual ~VariableBase() = default;
 
@@ -116,6 +290,27 @@ class VariableBase {
    */
   virtual bool fromString(const String& val) = 0;
 
+  /**
+   * @brief Formats the value as string() does, into a caller buffer, like snprintf().
+   *
+   * The default copies string(); the variable types of this library override it so that
+   * formatting does not allocate.
+   * @param buf The target buffer.
+   * @param len Size of the buffer, including the terminating NUL.
+   * @return Length of the full text; it was truncated if this is not less than len.
+   */
+  virtual std::size_t formatTo(char* buf, std::size_t len) const;
+  /**
+   * @brief Sets the value from text, as fromString() does.
+   *
+   * The default passes a String to fromString(); the number types of this library
+   * override it with parsers which neither allocate nor use sscanf().
+   * @param text The source text, which need not be NUL-terminated.
+   * @param len Length of the text.
+   * @return true if conversion was successful.
+   */
+  virtual bool parse(const char* text, std::size_t len);
+
   /**
    * @brief Adds the variable's value to a JSON object.
    * @param doc The target JSON object.
@@ -127,6 +322,14 @@ class VariableBase {
    * @return true if update was successful.
    */
   virtual bool fromJson(JsonVariantConst val) = 0;
+  /**
+   * @brief Writes the variable's value, as toJson() would store it, to a JsonWriter.
+   *
+   * The default writes string() as a JSON string; the variable types of this library
+   * override it so that writing does not allocate.
+   * @param out The target writer.
+   */
+  virtual void writeJsonValue(JsonWriter* out) const;
 
   /** @return HTML snippet for an input field in a web form. */
   virtual String formEntry() const;
@@ -140,20 +343,38 @@ class VariableBase {
   };
 
   /** @return The unique name of the variable. */
-  const char* name() const { return m_name; }
+  const char* name() const { return readString(&descriptor().name); }
   /** @return The units of measurement. */
-  const char* units() const { return m_units; }
+  const char* units() const { return readString(&descriptor().units); }
   /** @return The human-readable description. */
-  const char* description() const { return m_description; }
+  const char* description() const { return readString(&descriptor().description); }
   /** @return Description if available, otherwise the name. */
   const char* human_str() const {
-    return m_description && m_description[0] ? description() : name();
+    const char* desc = description();
+    return desc && desc[0] ? desc : name();
   }
+  /** @return This variable's descriptor, which may be in flash. */
+  const VariableDescriptor& descriptor() const { return m_group.descriptor(m_descriptor); }
   /** @return Reference to the owning VariableGroup. */
   const VariableGroup& group() const { return m_group; }
+  /** @return The position of this variable in its group. */
+  uint16_t index() const { return m_index; }
+  /**
+   * @brief Counts changes to the value or failed state.
+   *
+   * Assignments which do not change the value leave the version alone. Changes made
+   * through the non-const value() accessors are not seen; call setChanged() after them.
+   * @return The version, which wraps around after 65535 changes.
+   */
+  uint16_t version() const { return m_version; }
+  /** @brief Bumps the version and marks the variable as changed in its group. */
+  void setChanged() {
+    m_version += 1;
+    m_group.setChanged(m_index);
+  }
 
   /** @return Current behavioral flags. */
-  unsigned flags() const { return m_flags; }
+  unsigned flags() const { return pgm_read_word(&descriptor().flags); }
   /** @return true if the kSettable flag is set. */
   bool settable() const { return testFlag(Flags::kSettable); }
   /** @return true if the kConfig flag is set. */
@@ -165,16 +386,27 @@ class VariableBase {
   /** @return true if the variable is in a failed/invalid state. */
   bool failed() const { return m_failed; }
   /** @brief Marks the variable as failed or healthy. */
-  void setFailed(bool failed = true) { m_failed = failed; }
+  void setFailed(bool failed = true) {
+    if (failed != m_failed) {
+      m_failed = failed;
+      setChanged();
+    }
+  }
+
+ protected:
+  /** @brief Constructs a VariableBase with a copy of descriptor in the group's RAM table. */
+  VariableBase(const VariableDescriptor& descriptor, VariableGroup& group);
 
  private:
-  bool testFlag(Flags flag) const { return m_flags & static_cast<unsigned>(flag); }
+  static const char* readString(const char* const* field) {
+    return static_cast<const char*>(pgm_read_ptr(field));
+  }
+  bool testFlag(Flags flag) const { return flags() & static_cast<unsigned>(flag); }
 
-  const char* m_name;
-  const char* m_units;
-  const char* m_description;
-  const unsigned m_flags;
   const VariableGroup& m_group;
+  uint16_t m_index;
+  uint16_t m_descriptor;
+  uint16_t m_version = 0;
   bool m_failed = false;
 };
 
@@ -185,13 +417,13 @@ class FloatVariableBase : public VariableBase {
  public:
   FloatVariableBase(const char* name_, const char* units_, const char* description_,
                     unsigned flags_, unsigned decimals_, VariableGroup& group)
-      : VariableBase(name_, units_, description_, flags_, group), m_decimals(decimals_) {}
+      : VariableBase({name_, units_, description_, static_cast<uint16_t>(flags_),
+                      static_cast<uint16_t>(decimals_)},
+                     group) {}
+  FloatVariableBase(uint16_t descriptor, VariableGroup& group) : VariableBase(descriptor, group) {}
 
   /** @return Number of decimal places to use for display/serialization. */
-  unsigned decimals() const { return m_decimals; }
-
- private:
-  const unsigned m_decimals;
+  unsigned decimals() const { return pgm_read_word(&descriptor().decimals); }
 };
 
 /**
@@ -203,10 +435,16 @@ class Variable : public VariableBase {
   Variable(const char* name_, const T& value, const char* units_, const char* description_,
            unsigned flags_, VariableGroup& group)
       : VariableBase(name_, units_, description_, flags_, group), m_value(value) {}
+  /** @brief Constructs a variable described by entry descriptor of the group's table. */
+  Variable(uint16_t descriptor, const T& value, VariableGroup& group)
+      : VariableBase(descriptor, group), m_value(value) {}
   String string() const override;
   bool fromString(const String&) override;
+  std::size_t formatTo(char* buf, std::size_t len) const override;
+  bool parse(const char* text, std::size_t len) override;
   void toJson(JsonObject doc) override;
   bool fromJson(JsonVariantConst json) override;
+  void writeJsonValue(JsonWriter* out) const override { out->value(m_value); }
 
   /** @return Constant reference to the underlying value. */
   const T& value() const { return m_value; }
@@ -214,12 +452,20 @@ class Variable : public VariableBase {
   T& value() { return m_value; }
   /** @brief Assignment operator that also clears the failed state. */
   Variable<T>& operator=(const T& value) {
-    m_value = value;
+    setValue(value);
     setFailed(false);
     return *this;
   }
 
  protected:
+  /** @brief Sets the value, marking the variable changed if it differs. */
+  void setValue(const T& value) {
+    if (!(m_value == value)) {
+      m_value = value;
+      setChanged();
+    }
+  }
+
   T m_value;
 };
 
@@ -233,10 +479,20 @@ class FloatingPointVariable : public FloatVariableBase {
                         const char* description_, unsigned flags_, unsigned decimals_,
                         VariableGroup& group)
       : FloatVariableBase(name_, units_, description_, flags_, decimals_, group), m_value(value) {}
+  /** @brief Constructs a variable described by entry descriptor of the group's table. */
+  FloatingPointVariable(uint16_t descriptor, const T& value, VariableGroup& group)
+      : FloatVariableBase(descriptor, group), m_value(value) {}
   String string() const override;
-  bool fromString(const String&) override;
+  bool fromString(const String& value) override { return parse(value.c_str(), value.length()); }
+  std::size_t formatTo(char* buf, std::size_t len) const override {
+    return formatFixed(buf, len, m_value, decimals());
+  }
+  bool parse(const char* text, std::size_t len) override;
   void toJson(JsonObject doc) override;
   bool fromJson(JsonVariantConst json) override;
+  void writeJsonValue(JsonWriter* out) const override {
+    out->value(static_cast<double>(m_value), decimals());
+  }
 
   /** @return Constant reference to the underlying value. */
   const T& value() const { return m_value; }
@@ -244,12 +500,20 @@ class FloatingPointVariable : public FloatVariableBase {
   T& value() { return m_value; }
   /** @brief Assignment operator that also clears the failed state. */
   FloatingPointVariable<T>& operator=(const T& value) {
-    m_value = value;
+    setValue(value);
     setFailed(false);
     return *this;
   }
 
  protected:
+  /** @brief Sets the value, marking the variable changed if it differs. */
+  void setValue(const T& value) {
+    if (m_value != value) {
+      m_value = value;
+      setChanged();
+    }
+  }
+
   T m_value;
 };
 
@@ -261,6 +525,7 @@ class EnumVariableBase : public VariableBase {
   EnumVariableBase(const char* name_, const char* description_, unsigned flags_,
                    VariableGroup& group)
       : VariableBase(name_, nullptr /*units_*/, description_, flags_, group) {}
+  EnumVariableBase(uint16_t descriptor, VariableGroup& group) : VariableBase(descriptor, group) {}
 };
 
 /**
@@ -270,11 +535,16 @@ class EnumStrVariableBase : public EnumVariableBase {
  public:
   EnumStrVariableBase(const char* name_, int value, const char* description_, unsigned num_values,
                       const char* value_names[], unsigned flags_, VariableGroup& group);
+  EnumStrVariableBase(uint16_t descriptor, int value, unsigned num_values,
+                      const char* value_names[], VariableGroup& group);
 
   String string() const override;
-  bool fromString(const String& value) override;
+  bool fromString(const String& value) override { return parse(value.c_str(), value.length()); }
+  std::size_t formatTo(char* buf, std::size_t len) const override;
+  bool parse(const char* text, std::size_t len) override;
   bool fromJson(JsonVariantConst json) override;
   void toJson(JsonObject doc) override;
+  void writeJsonValue(JsonWriter* out) const override;
   String formEntry() const override;
 
   /** @return Total number of possible enum values. */
@@ -283,6 +553,14 @@ class EnumStrVariableBase : public EnumVariableBase {
   const char** value_names() const { return m_value_names; }
 
  protected:
+  /** @brief Sets the value, marking the variable changed if it differs. */
+  void setValue(int value) {
+    if (m_value != value) {
+      m_value = value;
+      setChanged();
+    }
+  }
+
   const unsigned m_num_values;
   const char** m_value_names;
   int m_value;
@@ -297,14 +575,21 @@ class EnumVariable : public EnumVariableBase {
   EnumVariable(const char* name_, const T& value, const char* description_, unsigned flags_,
                VariableGroup& group)
       : EnumVariableBase(name_, description_, flags_, group), m_value(value) {}
+  /** @brief Constructs a variable described by entry descriptor of the group's table. */
+  EnumVariable(uint16_t descriptor, const T& value, VariableGroup& group)
+      : EnumVariableBase(descriptor, group), m_value(value) {}
   String string() const override { return String(static_cast<int>(value())); }
-  bool fromString(const String& value) override {
-    int ival = -1;
-    setFailed(1 != sscanf(value.c_str(), "%d", &ival));
+  bool fromString(const String& value) override { return parse(value.c_str(), value.length()); }
+  std::size_t formatTo(char* buf, std::size_t len) const override {
+    return formatInt(buf, len, static_cast<int>(m_value));
+  }
+  bool parse(const char* text, std::size_t len) override {
+    long long ival = 0;
+    setFailed(!parseInt(text, len, &ival) || ival < INT_MIN || ival > INT_MAX);
     if (failed()) {
       return false;
     }
-    m_value = static_cast<T>(ival);
+    setValue(static_cast<T>(ival));
     return true;
   }
   void toJson(JsonObject json) override {
@@ -316,19 +601,28 @@ class EnumVariable : public EnumVariableBase {
     if (!json.is<int>()) {
       return false;
     }
-    m_value = static_cast<T>(json.as<int>());
+    setValue(static_cast<T>(json.as<int>()));
     return true;
   }
+  void writeJsonValue(JsonWriter* out) const override { out->value(static_cast<int>(m_value)); }
 
   const T& value() const { return m_value; }
   T& value() { return m_value; }
   EnumVariable<T>& operator=(const T& value) {
-    m_value = value;
+    setValue(value);
     setFailed(false);
     return *this;
   }
 
  protected:
+  /** @brief Sets the value, marking the variable changed if it differs. */
+  void setValue(const T& value) {
+    if (m_value != value) {
+      m_value = value;
+      setChanged();
+    }
+  }
+
   T m_value;
 };
 
@@ -342,22 +636,27 @@ class EnumStrVariable : public EnumStrVariableBase {
                   const char* value_names[], unsigned flags_, VariableGroup& group)
       : EnumStrVariableBase(name_, static_cast<int>(value), description_,
                             static_cast<unsigned>(max_value) + 1, value_names, flags_, group) {}
+  /** @brief Constructs a variable described by entry descriptor of the group's table. */
+  EnumStrVariable(uint16_t descriptor, const T& value, const T& max_value,
+                  const char* value_names[], VariableGroup& group)
+      : EnumStrVariableBase(descriptor, static_cast<int>(value),
+                            static_cast<unsigned>(max_value) + 1, value_names, group) {}
   const T value() const { return static_cast<T>(m_value); }
   T value() { return static_cast<T>(m_value); }
   EnumStrVariable<T>& operator=(const T value) {
-    m_value = static_cast<int>(value);
+    setValue(static_cast<int>(value));
     setFailed(false);
     return *this;
   }
 };
 
-template <>
-inline String FloatingPointVariable<float>::string() const {
-  return String(m_value, decimals());
-}
-template <>
-inline String FloatingPointVariable<double>::string() const {
-  return String(m_value, decimals());
+template <typename T>
+inline String FloatingPointVariable<T>::string() const {
+  char text[32];
+  if (formatTo(text, sizeof(text)) >= sizeof(text)) {
+    return String(m_value, decimals());
+  }
+  return String(text);
 }
 template <>
 inline String Variable<String>::string() const {
@@ -369,42 +668,90 @@ inline String Variable<T>::string() const {
 }
 
 template <>
-inline bool FloatingPointVariable<float>::fromString(const String& value) {
-  setFailed(1 != sscanf(value.c_str(), "%g", &m_value));
+inline void Variable<String>::writeJsonValue(JsonWriter* out) const {
+  out->string(m_value.c_str());
+}
+
+template <typename T>
+inline bool FloatingPointVariable<T>::parse(const char* text, std::size_t len) {
+  double val = 0;
+  setFailed(!parseDouble(text, len, &val));
+  if (!failed()) {
+    setValue(static_cast<T>(val));
+  }
   return !failed();
 }
+
+template <typename T>
+inline std::size_t Variable<T>::formatTo(char* buf, std::size_t len) const {
+  return VariableBase::formatTo(buf, len);
+}
 template <>
-inline bool FloatingPointVariable<double>::fromString(const String& value) {
-  setFailed(1 != sscanf(value.c_str(), "%lg", &m_value));
+inline std::size_t Variable<int>::formatTo(char* buf, std::size_t len) const {
+  return formatInt(buf, len, m_value);
+}
+template <>
+inline std::size_t Variable<unsigned>::formatTo(char* buf, std::size_t len) const {
+  return formatUnsigned(buf, len, m_value);
+}
+template <>
+inline std::size_t Variable<String>::formatTo(char* buf, std::size_t len) const {
+  return formatText(buf, len, m_value.c_str());
+}
+template <>
+inline std::size_t Variable<bool>::formatTo(char* buf, std::size_t len) const {
+  return formatText(buf, len, m_value ? "1" : "0");
+}
+
+template <typename T>
+inline bool Variable<T>::parse(const char* text, std::size_t len) {
+  return VariableBase::parse(text, len);
+}
+template <>
+inline bool Variable<int>::parse(const char* text, std::size_t len) {
+  long long val = 0;
+  setFailed(!parseInt(text, len, &val) || val < INT_MIN || val > INT_MAX);
+  if (!failed()) {
+    setValue(static_cast<int>(val));
+  }
   return !failed();
 }
 template <>
-inline bool Variable<int>::fromString(const String& value) {
-  setFailed(1 != sscanf(value.c_str(), "%d", &m_value));
+inline bool Variable<unsigned>::parse(const char* text, std::size_t len) {
+  unsigned long long val = 0;
+  setFailed(!parseUnsigned(text, len, &val) || val > UINT_MAX);
+  if (!failed()) {
+    setValue(static_cast<unsigned>(val));
+  }
   return !failed();
 }
 template <>
+inline bool Variable<bool>::parse(const char* text, std::size_t len) {
+  setFailed(false);
+  const bool off = len == 0 || (len == 1 && text[0] == '0')         // 0 vs 1
+                   || text[0] == 'f' || text[0] == 'F'              // false vs true
+                   || ((text[0] == 'o' || text[0] == 'O')           // off vs on
+                       && len > 1 && (text[1] == 'f' || text[1] == 'F'));
+  setValue(!off);
+  return true;
+}
+
+template <>
+inline bool Variable<int>::fromString(const String& value) {
+  return parse(value.c_str(), value.length());
+}
+template <>
 inline bool Variable<unsigned>::fromString(const String& value) {
-  setFailed(1 != sscanf(value.c_str(), "%u", &m_value));
-  return !failed();
+  return parse(value.c_str(), value.length());
 }
 template <>
 inline bool Variable<String>::fromString(const String& value) {
-  m_value = value;
+  setValue(value);
   return true;
 }
 template <>
 inline bool Variable<bool>::fromString(const String& value) {
-  setFailed(false);
-  if (value.length() == 0 || value == "0"       // 0 vs 1
-      || value[0] == 'f' || value[0] == 'F'     // false vs true
-      || ((value[0] == 'o' || value[0] == 'O')  // off vs on
-          && (value[1] == 'f' || value[1] == 'F'))) {
-    m_value = false;
-  } else {
-    m_value = true;
-  }
-  return true;
+  return parse(value.c_str(), value.length());
 }
 template <>
 inline bool Variable<bool>::fromJson(JsonVariantConst json) {
@@ -415,7 +762,7 @@ inline bool Variable<bool>::fromJson(JsonVariantConst json) {
     setFailed();
     return false;
   }
-  m_value = json.as<bool>();
+  setValue(json.as<bool>());
   return true;
 }
 
@@ -445,7 +792,7 @@ inline bool Variable<String>::fromJson(JsonVariantConst json) {
   if (!json.is<const char*>()) {
     return false;
   }
-  m_value = json.as<const char*>();
+  setValue(json.as<const char*>());
   return true;
 }
 
@@ -454,7 +801,7 @@ inline bool Variable<T>::fromJson(JsonVariantConst json) {
   if (!json.is<T>()) {
     return false;
   }
-  m_value = json.as<T>();
+  setValue(json.as<T>());
   return true;
 }
 
@@ -464,7 +811,7 @@ inline bool FloatingPointVariable<T>::fromJson(JsonVariantConst json) {
     setFailed();
     return false;
   }
-  m_value = json.as<T>();
+  setValue(json.as<T>());
   return true;
 }
 
@@ -479,8 +826,15 @@ class BoolVariable : public Variable<bool> {
   BoolVariable(const char* name_, const bool value, const char* description_, unsigned flags_,
                VariableGroup& group)
       : Variable<bool>(name_, value, "", description_, flags_, group) {}
+  /** @brief Constructs a variable described by entry descriptor of the group's table. */
+  BoolVariable(uint16_t descriptor, bool value, VariableGroup& group)
+      : Variable<bool>(descriptor, value, group) {}
   String string() const final { return value() ? "true" : "false"; }
+  std::size_t formatTo(char* buf, std::size_t len) const final {
+    return formatText(buf, len, value() ? "true" : "false");
+  }
   void toJson(JsonObject json);
+  void writeJsonValue(JsonWriter* out) const override { out->string(value() ? "true" : "false"); }
   BoolVariable& operator=(bool value);
   String formEntry() const override;
 };
@@ -493,8 +847,15 @@ class BinarySensorVariable : public Variable<bool> {
   BinarySensorVariable(const char* name_, const bool value, const char* description_,
                        VariableGroup& group, bool publish = true)
       : Variable<bool>(name_, value, "", description_, publish ? 0 : kNoPublish, group) {}
+  /** @brief Constructs a variable described by entry descriptor of the group's table. */
+  BinarySensorVariable(uint16_t descriptor, bool value, VariableGroup& group)
+      : Variable<bool>(descriptor, value, group) {}
   String string() const override { return value() ? "ON" : "OFF"; }
+  std::size_t formatTo(char* buf, std::size_t len) const override {
+    return formatText(buf, len, value() ? "ON" : "OFF");
+  }
   void toJson(JsonObject json);
+  void writeJsonValue(JsonWriter* out) const override { out->string(value() ? "ON" : "OFF"); }
   bool fromJson(JsonVariantConst json);
   BinarySensorVariable& operator=(bool value);
 };
@@ -507,7 +868,14 @@ class BinaryCoverSensorVariable : public BinarySensorVariable {
   BinaryCoverSensorVariable(const char* name_, const bool value, const char* description_,
                             VariableGroup& group, bool publish = true)
       : BinarySensorVariable(name_, value, description_, group, publish) {}
+  /** @brief Constructs a variable described by entry descriptor of the group's table. */
+  BinaryCoverSensorVariable(uint16_t descriptor, bool value, VariableGroup& group)
+      : BinarySensorVariable(descriptor, value, group) {}
   String string() const final { return value() ? "open" : "closed"; }
+  std::size_t formatTo(char* buf, std::size_t len) const final {
+    return formatText(buf, len, value() ? "open" : "closed");
+  }
+  void writeJsonValue(JsonWriter* out) const final { out->string(value() ? "open" : "closed"); }
   BinaryCoverSensorVariable& operator=(bool value);
 };
 
@@ -36,6 +36,19 @@ class WebApp : public WifiApp {
   WebButton createRestartButton();
 #endif
 
+#ifdef OG3_MODULE_PROFILE
+  /** @brief Web handler for the table of module callback timings. */
+  NetHandlerStatus handleModuleProfileRequest(NetRequest* request, NetResponse* response);
+  /** @brief Web handler for the module callback timings as JSON. */
+  NetHandlerStatus handleModuleProfileJsonRequest(NetRequest* request, NetResponse* response);
+#ifndef NATIVE
+  /** @return A button linking to the module profile page (kModuleProfileUrl). */
+  WebButton createModuleProfileButton();
+#endif
+  static const char kModuleProfileUrl[];      ///< @brief "/profile"
+  static const char kModuleProfileJsonUrl[];  ///< @brief "/profile.json", served by default.
+#endif
+
  protected:
 #ifndef NATIVE
   WebServer m_web_server;
@@ -128,6 +128,7 @@ class WifiManager : public Module {
 
 #ifndef NATIVE
   std::unique_ptr<DNSServer> m_dns_server;
+  ModuleSystem::UpdateId m_dns_update = 0;
 #endif
   TaskIdScheduler m_scheduler;
   TaskIdScheduler m_sanity_scheduler;
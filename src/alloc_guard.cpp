@@ -0,0 +1,205 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/alloc_guard.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#include "og3/dispatch_trace.h"
+#include "og3/heap_stats.h"
+#include "og3/logger.h"
+#include "og3/module.h"
+#include "og3/module_system.h"
+
+#if defined(NATIVE)
+#include <pthread.h>
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+namespace og3 {
+
+namespace {
+
+using Kind = DispatchTrace::Kind;
+
+struct State {
+  ModuleSystem* module_system = nullptr;
+  std::atomic<bool> armed{false};  // Read by the allocator hook on every thread.
+  bool in_hook = false;            // Allocations made while handling one are not tracked.
+  uint32_t total = 0;
+  uint32_t loop = 0;
+  std::vector<uint32_t> modules;
+  std::vector<AllocGuard::TaskAllocs> tasks;
+#if defined(NATIVE)
+  pthread_t loop_thread;
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  TaskHandle_t loop_task = nullptr;
+#endif
+};
+
+// Created by the first arm() and never freed, so that allocations made while the
+// program exits do not touch destroyed state.
+State* s_state = nullptr;
+AllocGuard::Action s_action = AllocGuard::Action::kLog;
+
+bool onLoopThread(const State& state) {
+#if defined(NATIVE)
+  return pthread_equal(pthread_self(), state.loop_thread);
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  return xTaskGetCurrentTaskHandle() == state.loop_task;
+#else
+  return true;
+#endif
+}
+
+void logAlloc(State& state, std::size_t bytes, const DispatchTrace::Sample& sample) {
+  Logger* log = state.module_system->log();
+  switch (sample.kind) {
+    case Kind::kUpdate: {
+      const Module* module = state.module_system->find_sorted(sample.id);
+      log->logf("Allocated %u bytes after setup in update of '%s'.",
+                static_cast<unsigned>(bytes), module ? module->name() : "?");
+      break;
+    }
+    case Kind::kTask:
+      log->logf("Allocated %u bytes after setup in task %u.", static_cast<unsigned>(bytes),
+                static_cast<unsigned>(sample.id));
+      break;
+    default:
+      log->logf("Allocated %u bytes after setup in loop.", static_cast<unsigned>(bytes));
+      break;
+  }
+}
+
+void countTask(State& state, unsigned id) {
+  for (AllocGuard::TaskAllocs& entry : state.tasks) {
+    if (entry.id == id) {
+      entry.count += 1;
+      return;
+    }
+  }
+  // The table was reserved by arm(), so this does not allocate until it is full.
+  if (state.tasks.size() < AllocGuard::kMaxTaskIds) {
+    state.tasks.push_back({id, 1});
+  } else {
+    state.tasks.back().count += 1;
+  }
+}
+
+}  // namespace
+
+void AllocGuard::arm(ModuleSystem* module_system) {
+  if (!s_state) {
+    s_state = new State();
+  }
+  State& state = *s_state;
+  state.armed = false;
+  state.module_system = module_system;
+  state.total = 0;
+  state.loop = 0;
+  state.modules.assign(module_system->num_modules(), 0);
+  state.tasks.clear();
+  state.tasks.reserve(kMaxTaskIds);
+#if defined(NATIVE)
+  state.loop_thread = pthread_self();
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  state.loop_task = xTaskGetCurrentTaskHandle();
+#endif
+  state.armed = true;
+#if defined(OG3_ALLOC_GUARD) && \
+    (defined(NATIVE) || !(defined(ARDUINO_ARCH_ESP32) || defined(ESP32)))
+  // This also links in the allocator hook, which nothing else may reference.
+  if (!HeapStats::countsAllocations()) {
+    module_system->log()->log("AllocGuard: this platform has no allocator hook.");
+  }
+#endif
+}
+
+void AllocGuard::disarm() {
+  if (s_state) {
+    s_state->armed = false;
+  }
+}
+
+bool AllocGuard::armed() { return s_state && s_state->armed; }
+
+void AllocGuard::setAction(Action action) { s_action = action; }
+
+void AllocGuard::onAlloc(std::size_t bytes) {
+  State* state = s_state;
+  if (!state || !state->armed || state->in_hook || !onLoopThread(*state)) {
+    return;
+  }
+  state->in_hook = true;
+  const DispatchTrace::Sample sample = state->module_system->dispatch_trace().sample();
+  state->total += 1;
+  if (sample.kind == Kind::kUpdate && sample.id < state->modules.size()) {
+    state->modules[sample.id] += 1;
+  } else if (sample.kind == Kind::kTask) {
+    countTask(*state, sample.id);
+  } else {
+    state->loop += 1;
+  }
+  if (s_action != Action::kCount) {
+    logAlloc(*state, bytes, sample);
+  }
+  if (s_action == Action::kAbort) {
+    abort();
+  }
+  state->in_hook = false;
+}
+
+uint32_t AllocGuard::total() { return s_state ? s_state->total : 0; }
+
+uint32_t AllocGuard::moduleAllocs(std::size_t sorted_idx) {
+  return s_state && sorted_idx < s_state->modules.size() ? s_state->modules[sorted_idx] : 0;
+}
+
+uint32_t AllocGuard::loopAllocs() { return s_state ? s_state->loop : 0; }
+
+const std::vector<AllocGuard::TaskAllocs>& AllocGuard::taskAllocs() {
+  static const std::vector<TaskAllocs> s_none;
+  return s_state ? s_state->tasks : s_none;
+}
+
+void AllocGuard::logReport(unsigned long num_loops) {
+  if (!s_state || !s_state->module_system) {
+    return;
+  }
+  State& state = *s_state;
+  const bool was_in_hook = state.in_hook;
+  state.in_hook = true;  // Do not count the report's own allocations.
+  Logger* log = state.module_system->log();
+  const double loops = num_loops ? static_cast<double>(num_loops) : 1.0;
+  log->logf("Allocations after setup: %lu in %lu loops.", static_cast<unsigned long>(state.total),
+            num_loops);
+  for (std::size_t i = 0; i < state.modules.size(); i++) {
+    if (state.modules[i]) {
+      const Module* module = state.module_system->find_sorted(i);
+      log->logf(" update of '%s': %lu (%.4f/loop)", module ? module->name() : "?",
+                static_cast<unsigned long>(state.modules[i]), state.modules[i] / loops);
+    }
+  }
+  for (const TaskAllocs& entry : state.tasks) {
+    log->logf(" task %u: %lu (%.4f/loop)", entry.id, static_cast<unsigned long>(entry.count),
+              entry.count / loops);
+  }
+  if (state.loop) {
+    log->logf(" loop: %lu (%.4f/loop)", static_cast<unsigned long>(state.loop),
+              state.loop / loops);
+  }
+  state.in_hook = was_in_hook;
+}
+
+}  // namespace og3
+
+#if defined(OG3_ALLOC_GUARD) && !defined(NATIVE) && \
+    (defined(ARDUINO_ARCH_ESP32) || defined(ESP32))
+// Called by ESP-IDF after each allocation when built with CONFIG_HEAP_USE_HOOKS.
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  og3::AllocGuard::onAlloc(size);
+}
+#endif
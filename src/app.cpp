@@ -12,6 +12,11 @@ App::App(const Options& options)
       m_logger(options.log_type == LogType::kSerial ? reinterpret_cast<Logger*>(&m_serial_logger)
                                                     : reinterpret_cast<Logger*>(&m_null_logger)),
       m_module_system(&m_logger, options.reserve_num_modules),
-      m_tasks(options.reserve_tasks, &m_module_system) {}
+      m_tasks(options.reserve_tasks, &m_module_system) {
+  m_tasks.setLoopBudget(options.loop_budget_usec, options.max_tasks_per_loop);
+  m_module_system.set_update_budget(options.loop_budget_usec);
+  m_module_system.set_parallel_init(options.init_workers);
+  m_tasks.loopStats().setEnabled(options.loop_stats);
+}
 
 }  // namespace og3
@@ -5,9 +5,12 @@
 
 #include <Arduino.h>
 
+#include <iterator>
+
 #include "og3/html_table.h"
 #include "og3/module_system.h"
 #include "og3/mqtt_manager.h"
+#include "og3/stall_watchdog.h"
 #include "og3/units.h"
 #include "og3/web.h"
 
@@ -18,20 +21,76 @@ const char* AppStatus::kUrl = "/app_status";
 
 namespace {
 const char* kLogTypeNames[]{"None", "Serial", "Udp"};
-}
+
+enum VarIndex : uint16_t {
+  kVarMemAvail,
+  kVarMemLargestBlock,
+  kVarMemMinAvail,
+  kVarMemFragmentation,
+  kVarLoopStackFree,
+  kVarNumAllocs,
+  kVarNumFrees,
+  kVarUptime,
+  kVarNumTasks,
+  kVarTaskCapacity,
+  kVarNumModules,
+  kVarModuleCapacity,
+  kVarTaskDeferrals,
+  kVarUpdateDeferrals,
+  kVarLogType,
+  kVarCount,
+};
+
+const VariableDescriptor s_vars[] PROGMEM = {
+    {"memAvail", units::kKilobytes, "memory available", 0, 1},
+    {"memLargestBlock", units::kKilobytes, "largest free block", 0, 1},
+    {"memMinAvail", units::kKilobytes, "lowest memory available", 0, 1},
+    {"memFragmentation", units::kPercentage, "heap fragmentation", 0, 0},
+    {"loopStackFree", units::kBytes, "lowest free loop stack", 0, 0},
+#if !defined(NATIVE) && (defined(ARDUINO_ARCH_ESP32) || defined(ESP32))
+    // ESP32 counts blocks in use, rather than allocations and frees since boot.
+    {"allocatedBlocks", "", "allocated heap blocks", 0, 0},
+    {"freeBlocks", "", "free heap blocks", 0, 0},
+#else
+    {"numAllocs", "", "heap allocations", 0, 0},
+    {"numFrees", "", "heap frees", 0, 0},
+#endif
+    {"uptime", units::kMilliseconds, "uptime", 0, 0},
+    {"numTasks", "", "num tasks", 0, 0},
+    {"taskCapacity", "", "task capacity", 0, 0},
+    {"numModules", "", "num modules", 0, 0},
+    {"moduleCapacity", "", "module capacity", 0, 0},
+    {"taskDeferrals", "", "loops which deferred due tasks", 0, 0},
+    {"updateDeferrals", "", "loops which deferred updates", 0, 0},
+    {"logType", nullptr, "log type", 0, 0},
+};
+static_assert(std::size(s_vars) == kVarCount, "s_vars must describe each VarIndex");
+}  // namespace
 
 AppStatus::AppStatus(Tasks* tasks, App::LogType log_type)
     : Module(kName, tasks->module_system()),
       m_tasks(tasks),
-      m_vg(kName),
-      m_mem_available("memAvail", 0.0f, units::kKilobytes, "memory available", 0, 1, m_vg),
-      m_uptime_msec("uptime", 0, units::kMilliseconds, "uptime", 0, m_vg),
-      m_num_tasks("numTasks", 0, "", "num tasks", 0, m_vg),
-      m_task_capacity("taskCapacity", 0, "", "task capacity", 0, m_vg),
-      m_num_modules("numModules", 0, "", "num modules", 0, m_vg),
-      m_module_capacity("moduleCapacity", 0, "", "module capacity", 0, m_vg),
-      m_log_type("logType", log_type, "log type", App::LogType::kUdp, kLogTypeNames, 0, m_vg) {
+      m_vg(kName, s_vars),
+      m_mem_available(kVarMemAvail, 0.0f, m_vg),
+      m_mem_largest_block(kVarMemLargestBlock, 0.0f, m_vg),
+      m_mem_min_available(kVarMemMinAvail, 0.0f, m_vg),
+      m_mem_fragmentation(kVarMemFragmentation, 0, m_vg),
+      m_stack_free(kVarLoopStackFree, 0, m_vg),
+      m_num_allocs(kVarNumAllocs, 0, m_vg),
+      m_num_frees(kVarNumFrees, 0, m_vg),
+      m_uptime_msec(kVarUptime, 0, m_vg),
+      m_num_tasks(kVarNumTasks, 0, m_vg),
+      m_task_capacity(kVarTaskCapacity, 0, m_vg),
+      m_num_modules(kVarNumModules, 0, m_vg),
+      m_module_capacity(kVarModuleCapacity, 0, m_vg),
+      m_task_deferrals(kVarTaskDeferrals, 0, m_vg),
+      m_update_deferrals(kVarUpdateDeferrals, 0, m_vg),
+      m_log_type(kVarLogType, log_type, App::LogType::kUdp, kLogTypeNames, m_vg) {
   require(MqttManager::kName, &m_mqtt_manager);
+  // The stall watchdog is optional, so look for it rather than requiring it.
+  add_init_fn([this]() {
+    m_stall_watchdog = static_cast<StallWatchdog*>(module_system()->find(StallWatchdog::kName));
+  });
   add_start_fn([this]() {
     m_tasks->runIn(1, [this]() { read(); });
     m_tasks->runIn(20 * kMsecInSec, [this]() { mqttSend(); });
@@ -40,21 +99,55 @@ AppStatus::AppStatus(Tasks* tasks, App::LogType log_type)
 
 void AppStatus::read() {
   m_uptime_msec = millis();
-#ifndef NATIVE
-  m_mem_available = ESP.getFreeHeap() / 1024.0f;
+  m_heap.read();
+  m_mem_available = m_heap.free_bytes / 1024.0f;
+  m_mem_largest_block = m_heap.largest_free_block / 1024.0f;
+  m_mem_min_available = m_heap.min_free_bytes / 1024.0f;
+  m_mem_fragmentation = m_heap.fragmentation_pct;
+  m_stack_free = m_heap.stack_free_bytes;
+#if !defined(NATIVE) && (defined(ARDUINO_ARCH_ESP32) || defined(ESP32))
+  m_num_allocs = m_heap.allocated_blocks;
+  m_num_frees = m_heap.free_blocks;
+#else
+  m_num_allocs = m_heap.num_allocs;
+  m_num_frees = m_heap.num_frees;
 #endif
   m_num_tasks = m_tasks->size();
   m_task_capacity = m_tasks->capacity();
   m_num_modules = module_system()->num_modules();
   m_module_capacity = module_system()->module_capacity();
-  m_tasks->runIn(2 * kMsecInSec, [this]() { read(); });
+  m_task_deferrals = m_tasks->deferrals();
+  m_update_deferrals = module_system()->update_deferrals();
+  if (m_tasks->loopStats().enabled()) {
+    m_tasks->loopStats().update(millis());
+  }
+#ifdef OG3_TASK_STATS
+  m_tasks->stats().update();
+#endif
+#ifdef OG3_MODULE_PROFILE
+  module_system()->profile().update();
+#endif
+  // Status is not time-critical, so let reads share wakeups with other tasks.
+  m_tasks->runIn(2 * kMsecInSec, [this]() { read(); }, 0, 250);
 }
 
 void AppStatus::mqttSend() {
   if (m_mqtt_manager) {
     m_mqtt_manager->mqttSend(m_vg);
+    if (m_stall_watchdog) {
+      m_mqtt_manager->mqttSend(m_stall_watchdog->variables());
+    }
+    if (m_tasks->loopStats().enabled()) {
+      m_mqtt_manager->mqttSend(m_tasks->loopStats().variables());
+    }
+#ifdef OG3_TASK_STATS
+    m_mqtt_manager->mqttSend(m_tasks->stats().variables());
+#endif
+#ifdef OG3_MODULE_PROFILE
+    m_mqtt_manager->mqttSend(module_system()->profile().variables());
+#endif
   }
-  m_tasks->runIn(10 * kMsecInMin, [this]() { mqttSend(); });
+  m_tasks->runIn(10 * kMsecInMin, [this]() { mqttSend(); }, 0, 5 * kMsecInSec);
 }
 
 }  // namespace og3
@@ -45,6 +45,12 @@ void BlinkLed::delayedBlink(unsigned msec, uint8_t num) {
   m_scheduler.runIn(msec);
 }
 
+void BlinkLed::stop() {
+  m_scheduler.cancel();
+  m_num_blinks = 0;
+  off();
+}
+
 void BlinkLed::blinkCallback() {
   if (m_is_on) {
     off();
@@ -111,15 +111,12 @@ bool ConfigInterface::read_config(VariableGroup& var_group, const char* filename
   log()->debugf("Reading config file '%s'.", fname);
   JsonDocument doc;
   deserializeJson(doc, config_file);
-  for (auto* var : var_group.variables()) {
-    if (!var->config()) {
-      continue;
-    }
-    const JsonVariant val = (doc)[var->name()];
-    if (val.isNull()) {
+  for (JsonPairConst kv : doc.as<JsonObjectConst>()) {
+    VariableBase* var = var_group.find(kv.key().c_str());
+    if (!var || !var->config() || kv.value().isNull()) {
       continue;
     }
-    if (!var->fromJson(val)) {
+    if (!var->fromJson(kv.value())) {
       log()->logf("Failed to read variable '%s' from '%s'.", var->name(), fname);
     }
   }
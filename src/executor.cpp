@@ -0,0 +1,224 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/executor.h"
+
+#include <Arduino.h>
+
+#include <utility>
+
+#include "og3/logger.h"
+
+namespace og3 {
+
+const char Executor::kName[] = "executor";
+
+namespace {
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+constexpr uint32_t kWorkerStackSize = 4096;
+constexpr UBaseType_t kWorkerPriority = 1;
+#if portNUM_PROCESSORS > 1
+// Keep workers off the core which runs loop().
+constexpr BaseType_t kWorkerCore = ARDUINO_RUNNING_CORE == 0 ? 1 : 0;
+#else
+constexpr BaseType_t kWorkerCore = tskNO_AFFINITY;
+#endif
+#endif
+
+}  // namespace
+
+Executor::Executor(Tasks* tasks, std::size_t num_workers)
+    : Module(kName, tasks->module_system()), m_tasks(tasks) {
+  if (num_workers > kMaxWorkers) {
+    num_workers = kMaxWorkers;
+  }
+#if defined(NATIVE)
+  for (std::size_t i = 0; i < num_workers; i++) {
+    m_workers[i] = std::thread([this]() { workerMain(); });
+  }
+  m_num_workers = num_workers;
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  m_ready = xQueueCreate(kMaxJobs, sizeof(Job*));
+  for (std::size_t i = 0; m_ready && i < num_workers; i++) {
+    if (pdPASS != xTaskCreatePinnedToCore(&Executor::workerTask, "og3-executor",
+                                          kWorkerStackSize, this, kWorkerPriority,
+                                          &m_workers[m_num_workers], kWorkerCore)) {
+      break;
+    }
+    m_num_workers += 1;
+  }
+#else
+  (void)num_workers;  // No threads: work runs on the loop.
+#endif
+  // The update function is only enabled while there are jobs to wait for.
+  m_update = add_update_fn([](void* executor) { static_cast<Executor*>(executor)->loop(); }, this);
+  set_update_enabled(m_update, false);
+}
+
+Executor::~Executor() {
+#if defined(NATIVE)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_cv.notify_all();
+  for (std::size_t i = 0; i < m_num_workers; i++) {
+    m_workers[i].join();
+  }
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  for (std::size_t i = 0; i < m_num_workers; i++) {
+    vTaskDelete(m_workers[i]);
+  }
+  if (m_ready) {
+    vQueueDelete(m_ready);
+  }
+#endif
+}
+
+bool Executor::runAt(unsigned long msec, TaskThunk work, TaskThunk done, unsigned id) {
+  // A job with the same ID which is still waiting for its start time is replaced.
+  // Its task is cancelled before its slot is freed, so that it cannot submit the slot
+  // after it is reused.
+  for (Job& job : m_jobs) {
+    if (id != 0 && job.id == id && job.state.load() == JobState::kScheduled) {
+      m_tasks->cancel(job.task);
+      freeJob(&job);
+    }
+  }
+  Job* job = nullptr;
+  for (Job& candidate : m_jobs) {
+    if (candidate.state.load() == JobState::kFree) {
+      job = &candidate;
+      break;
+    }
+  }
+  if (!job) {
+    log()->logf("Failed to schedule executor job (full!) id=%u", id);
+    return false;
+  }
+  job->work = std::move(work);
+  job->done = std::move(done);
+  job->id = id;
+  job->state.store(JobState::kScheduled);
+  job->task = m_tasks->runAt(msec, [this, job]() { submit(job); }, id);
+  if (!job->task) {
+    // Tasks logged that its queue is full.
+    freeJob(job);
+    return false;
+  }
+  set_update_enabled(m_update, true);
+  return true;
+}
+
+bool Executor::runIn(unsigned long msec, TaskThunk work, TaskThunk done, unsigned id) {
+  return runAt(millis() + msec, std::move(work), std::move(done), id);
+}
+
+std::size_t Executor::pending() const {
+  std::size_t count = 0;
+  for (const Job& job : m_jobs) {
+    if (job.state.load() != JobState::kFree) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+void Executor::loop() {
+  if (m_num_completed.load(std::memory_order_acquire) == m_num_reaped) {
+    return;
+  }
+  for (Job& job : m_jobs) {
+    if (job.state.load(std::memory_order_acquire) != JobState::kDone) {
+      continue;
+    }
+    // Free the slot first so that the completion callback can schedule more work.
+    TaskThunk done = std::move(job.done);
+    freeJob(&job);
+    m_num_reaped += 1;
+    if (done) {
+      done();
+    }
+  }
+  if (pending() == 0) {
+    set_update_enabled(m_update, false);
+  }
+}
+
+void Executor::freeJob(Job* job) {
+  job->work.reset();
+  job->done.reset();
+  job->id = 0;
+  job->task = TaskHandle();
+  job->state.store(JobState::kFree);
+}
+
+void Executor::submit(Job* job) {
+  job->task = TaskHandle();
+  job->state.store(JobState::kQueued);
+  if (m_num_workers == 0) {
+    runJob(job);
+    loop();
+    return;
+  }
+#if defined(NATIVE)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready[(m_ready_head + m_ready_count) % kMaxJobs] = job;
+    m_ready_count += 1;
+  }
+  m_cv.notify_one();
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  // The queue holds kMaxJobs entries, so there is always room.
+  xQueueSend(m_ready, &job, 0);
+#endif
+}
+
+void Executor::runJob(Job* job) {
+  job->state.store(JobState::kRunning);
+  if (job->work) {
+    job->work();
+  }
+  job->state.store(JobState::kDone, std::memory_order_release);
+#if defined(NATIVE) || defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  m_num_completed.fetch_add(1, std::memory_order_release);
+#else
+  // Only the loop runs jobs, and ESP8266 has no atomic read-modify-write instructions.
+  m_num_completed.store(m_num_completed.load() + 1);
+#endif
+  Tasks::wake();
+}
+
+void Executor::workerMain() {
+#if defined(NATIVE)
+  while (true) {
+    Job* job = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this]() { return m_stopping || m_ready_count > 0; });
+      if (m_stopping) {
+        return;
+      }
+      job = m_ready[m_ready_head];
+      m_ready_head = (m_ready_head + 1) % kMaxJobs;
+      m_ready_count -= 1;
+    }
+    runJob(job);
+  }
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  while (true) {
+    Job* job = nullptr;
+    if (pdTRUE == xQueueReceive(m_ready, &job, portMAX_DELAY)) {
+      runJob(job);
+    }
+  }
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+// static
+void Executor::workerTask(void* executor) { static_cast<Executor*>(executor)->workerMain(); }
+#endif
+
+}  // namespace og3
@@ -40,6 +40,9 @@ NetHandlerStatus HAApp::handleAppStatusRequest(NetRequest* request, NetResponse*
 #ifndef NATIVE
   m_web_page.clear();
   html::writeTableInto(&m_web_page, app_status().variables());
+  if (tasks().loopStats().enabled()) {
+    html::writeTableInto(&m_web_page, tasks().loopStats().variables());
+  }
   m_web_page += HTML_BUTTON("/", "Back");
   sendWrappedHTML(request, response, board_cname(), software_name(), m_web_page.c_str());
   config().write_config(app_status().variables());
@@ -395,7 +395,7 @@ void HADiscovery::onMqttConnect() {
                 failed ? "failed" : "pause", m_idx_mqtt_connect_next_discovery_calback,
                 m_discovery_callbacks.size());
     // Call back in 0.1sec.
-    m_tasks->runIn(100, std::bind(&HADiscovery::onMqttConnect, this));
+    m_tasks->runIn(100, [this]() { onMqttConnect(); });
   };
 
   constexpr unsigned kMaxSends = 8;  // send up to 8 at a time.
@@ -0,0 +1,133 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/heap_stats.h"
+
+#include <atomic>
+#include <cstddef>
+
+#include "og3/alloc_guard.h"
+
+#if defined(NATIVE)
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#elif defined(ARDUINO_ARCH_ESP8266)
+#include <Arduino.h>
+#endif
+
+namespace og3 {
+
+#if defined(NATIVE) && defined(OG3_ALLOC_HOOK) && defined(__GLIBC__)
+namespace heap_hook {
+std::atomic<uint32_t> s_num_allocs{0};
+std::atomic<uint32_t> s_num_frees{0};
+}  // namespace heap_hook
+#endif
+
+void HeapStats::read() {
+#if defined(NATIVE)
+#if defined(__GLIBC__)
+#if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+  const struct mallinfo2 info = mallinfo2();
+#else
+  const struct mallinfo info = mallinfo();
+#endif
+  free_bytes = static_cast<uint32_t>(info.fordblks);
+  largest_free_block = static_cast<uint32_t>(info.keepcost);
+#endif
+#if defined(OG3_ALLOC_HOOK) && defined(__GLIBC__)
+  num_allocs = heap_hook::s_num_allocs.load(std::memory_order_relaxed);
+  num_frees = heap_hook::s_num_frees.load(std::memory_order_relaxed);
+#endif
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+  free_bytes = info.total_free_bytes;
+  largest_free_block = info.largest_free_block;
+  min_free_bytes = info.minimum_free_bytes;
+  allocated_blocks = info.allocated_blocks;
+  free_blocks = info.free_blocks;
+  // On ESP32 the high-water mark is in bytes.
+  stack_free_bytes = uxTaskGetStackHighWaterMark(nullptr);
+#elif defined(ARDUINO_ARCH_ESP8266)
+  uint32_t free_heap = 0;
+  uint32_t max_block = 0;
+  ESP.getHeapStats(&free_heap, &max_block, nullptr);
+  free_bytes = free_heap;
+  largest_free_block = max_block;
+  stack_free_bytes = ESP.getFreeContStack();
+#endif
+
+#if defined(NATIVE) || !(defined(ARDUINO_ARCH_ESP32) || defined(ESP32))
+  if (min_free_bytes == 0 || free_bytes < min_free_bytes) {
+    min_free_bytes = free_bytes;
+  }
+#endif
+  fragmentation_pct =
+      free_bytes ? static_cast<uint8_t>(100 - (100ull * largest_free_block) / free_bytes) : 0;
+}
+
+bool HeapStats::countsAllocations() {
+#if defined(NATIVE)
+#if defined(OG3_ALLOC_HOOK) && defined(__GLIBC__)
+  return true;
+#else
+  return false;
+#endif
+#else
+  return false;
+#endif
+}
+
+}  // namespace og3
+
+#if defined(NATIVE) && defined(OG3_ALLOC_HOOK) && defined(__GLIBC__)
+// Replace the glibc allocator entry points with counting wrappers.  glibc exports the
+// real implementations as __libc_*, and operator new and String both allocate through
+// malloc(), so this counts every heap allocation in the program.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+  og3::heap_hook::s_num_allocs.fetch_add(1, std::memory_order_relaxed);
+#ifdef OG3_ALLOC_GUARD
+  og3::AllocGuard::onAlloc(size);
+#endif
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size) {
+  og3::heap_hook::s_num_allocs.fetch_add(1, std::memory_order_relaxed);
+#ifdef OG3_ALLOC_GUARD
+  og3::AllocGuard::onAlloc(num * size);
+#endif
+  return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  og3::heap_hook::s_num_allocs.fetch_add(1, std::memory_order_relaxed);
+#ifdef OG3_ALLOC_GUARD
+  og3::AllocGuard::onAlloc(size);
+#endif
+  if (ptr) {
+    og3::heap_hook::s_num_frees.fetch_add(1, std::memory_order_relaxed);
+  }
+  return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+  if (ptr) {
+    og3::heap_hook::s_num_frees.fetch_add(1, std::memory_order_relaxed);
+  }
+  __libc_free(ptr);
+}
+}  // extern "C"
+#endif
@@ -36,6 +36,16 @@ void escape(String* out_str, const char* in_str) {
   }
 }
 
+void writeValueInto(String* out_str, const VariableBase& var) {
+  // Long values, such as some strings, do not fit here and are formatted by string().
+  char value[64];
+  if (var.formatTo(value, sizeof(value)) < sizeof(value)) {
+    escape(out_str, value);
+  } else {
+    escape(out_str, var.string().c_str());
+  }
+}
+
 void writeRowInto(String* out_str, const VariableBase& var, const char* name) {
   *out_str += "<tr><td>";
   escape(out_str, name ? name : var.human_str());
@@ -43,7 +53,7 @@ void writeRowInto(String* out_str, const VariableBase& var, const char* name) {
   if (var.failed()) {
     *out_str += "(failed)";
   } else {
-    escape(out_str, var.string().c_str());
+    writeValueInto(out_str, var);
   }
   *out_str += " ";
   escape(out_str, var.units());
@@ -0,0 +1,93 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/isr_event_queue.h"
+
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+#include <interrupts.h>
+#endif
+
+#include "og3/compiler_definitions.h"
+
+namespace og3 {
+
+namespace {
+
+std::size_t roundUpToPowerOfTwo(std::size_t n) {
+  std::size_t size = 1;
+  while (size < n) {
+    size <<= 1;
+  }
+  return size;
+}
+
+}  // namespace
+
+IsrEventQueue::IsrEventQueue(std::size_t capacity)
+    : m_cells(roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity)),
+      m_mask(static_cast<uint32_t>(m_cells.size() - 1)) {
+  // A cell is free for the producer at position pos when its seq == pos.
+  for (std::size_t i = 0; i < m_cells.size(); ++i) {
+    m_cells[i].seq.store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+  }
+}
+
+bool OG3_IRAM_ATTR IsrEventQueue::post(IsrEventFn fn, void* ctx, unsigned long msec) {
+  Cell* cell = nullptr;
+  uint32_t pos = 0;
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  {
+    esp8266::InterruptLock lock;
+    pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    cell = &m_cells[pos & m_mask];
+    if (cell->seq.load(std::memory_order_acquire) != pos) {
+      m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    m_enqueue_pos.store(pos + 1, std::memory_order_relaxed);
+  }
+#else
+  pos = m_enqueue_pos.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &m_cells[pos & m_mask];
+    const int32_t diff =
+        static_cast<int32_t>(cell->seq.load(std::memory_order_acquire) - pos);
+    if (diff == 0) {
+      // The cell is free: try to claim this position.
+      if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The cell still holds an event from the previous lap: the queue is full.
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      // Another producer claimed this position first.
+      pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+#endif
+  cell->event.fn = fn;
+  cell->event.ctx = ctx;
+  cell->event.msec = msec;
+  // Publish the event to the consumer.
+  cell->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool IsrEventQueue::pop(IsrEvent* event) {
+  if (empty()) {
+    // Empty, or the next producer has claimed the cell but not yet published its event.
+    return false;
+  }
+  Cell& cell = m_cells[m_dequeue_pos & m_mask];
+  *event = cell.event;
+  // Hand the cell back to producers for the next lap.
+  cell.seq.store(m_dequeue_pos + m_mask + 1, std::memory_order_release);
+  m_dequeue_pos += 1;
+  return true;
+}
+
+}  // namespace og3
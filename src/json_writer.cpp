@@ -0,0 +1,100 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/json_writer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "og3/number_format.h"
+#include "og3/text_buffer.h"
+
+namespace og3 {
+
+JsonWriter::JsonWriter(char* buffer, std::size_t size) : m_buffer(buffer), m_size(size) {
+  if (m_size > 0) {
+    m_buffer[0] = 0;
+  }
+}
+
+JsonWriter::JsonWriter(TextBufferBase* out) : JsonWriter(out->tail(), out->available()) {}
+
+void JsonWriter::raw(const char* text, std::size_t len) {
+  if (m_len + 1 < m_size) {
+    const std::size_t room = m_size - 1 - m_len;
+    const std::size_t num = len < room ? len : room;
+    memcpy(m_buffer + m_len, text, num);
+    m_buffer[m_len + num] = 0;
+  }
+  m_len += len;
+}
+
+void JsonWriter::raw(const char* text) { raw(text, strlen(text)); }
+
+void JsonWriter::raw(char c) { raw(&c, 1); }
+
+void JsonWriter::string(const char* text) {
+  raw('"');
+  const char* run = text;
+  for (const char* p = text; *p; p++) {
+    const unsigned char c = static_cast<unsigned char>(*p);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    // Copy the plain characters before this one in one go.
+    raw(run, p - run);
+    run = p + 1;
+    switch (c) {
+      case '"':
+        raw("\\\"", 2);
+        break;
+      case '\\':
+        raw("\\\\", 2);
+        break;
+      case '\n':
+        raw("\\n", 2);
+        break;
+      case '\r':
+        raw("\\r", 2);
+        break;
+      case '\t':
+        raw("\\t", 2);
+        break;
+      default: {
+        char escaped[8];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        raw(escaped, 6);
+        break;
+      }
+    }
+  }
+  raw(run, strlen(run));
+  raw('"');
+}
+
+void JsonWriter::value(unsigned long long val) {
+  char text[24];
+  raw(text, formatUnsigned(text, sizeof(text), val));
+}
+
+void JsonWriter::value(long long val) {
+  char text[24];
+  raw(text, formatInt(text, sizeof(text), val));
+}
+
+void JsonWriter::value(double val, unsigned decimals) {
+  if (!std::isfinite(val)) {
+    null();
+    return;
+  }
+  char text[48];
+  std::size_t len = formatFixed(text, sizeof(text), val, decimals);
+  if (len >= sizeof(text)) {
+    // Too large for fixed notation.
+    len = snprintf(text, sizeof(text), "%.9g", val);
+  }
+  raw(text, len);
+}
+
+}  // namespace og3
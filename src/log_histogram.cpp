@@ -0,0 +1,68 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/log_histogram.h"
+
+namespace og3 {
+
+// static
+std::size_t LogHistogram::bucketFor(uint32_t value) {
+  std::size_t bucket = 0;
+  while (value != 0 && bucket < kNumBuckets - 1) {
+    value >>= 1;
+    bucket += 1;
+  }
+  return bucket;
+}
+
+// static
+uint32_t LogHistogram::bucketMax(std::size_t bucket) {
+  return bucket == 0 ? 0 : (static_cast<uint32_t>(1) << bucket) - 1;
+}
+
+void LogHistogram::add(uint32_t value) {
+  uint16_t& bucket = m_buckets[bucketFor(value)];
+  if (bucket == UINT16_MAX) {
+    // Halve all counts so that the histogram keeps its shape without overflowing.
+    m_count = 0;
+    for (uint16_t& count : m_buckets) {
+      count /= 2;
+      m_count += count;
+    }
+  }
+  bucket += 1;
+  m_count += 1;
+  if (value > m_max) {
+    m_max = value;
+  }
+}
+
+void LogHistogram::reset() {
+  for (uint16_t& count : m_buckets) {
+    count = 0;
+  }
+  m_count = 0;
+  m_max = 0;
+}
+
+uint32_t LogHistogram::percentile(unsigned percent) const {
+  if (m_count == 0) {
+    return 0;
+  }
+  // The rank (1-based) of the value at this percentile.
+  uint32_t rank = static_cast<uint32_t>((static_cast<uint64_t>(m_count) * percent + 99) / 100);
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint32_t seen = 0;
+  for (std::size_t bucket = 0; bucket < kNumBuckets - 1; bucket++) {
+    seen += m_buckets[bucket];
+    if (seen >= rank) {
+      const uint32_t upper = bucketMax(bucket);
+      return upper < m_max ? upper : m_max;
+    }
+  }
+  return m_max;
+}
+
+}  // namespace og3
@@ -0,0 +1,88 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/loop_stats.h"
+
+#include <iterator>
+
+#include "og3/units.h"
+
+namespace og3 {
+
+namespace {
+
+uint32_t clamp32(unsigned long value) {
+  return value > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(value);
+}
+
+enum VarIndex : uint16_t {
+  kVarLoopRate,
+  kVarLoopMax,
+  kVarLoopP50,
+  kVarLoopP99,
+  kVarModulesPct,
+  kVarTasksPct,
+  kVarCount,
+};
+
+const VariableDescriptor s_vars[] PROGMEM = {
+    {"loopRate", "", "loop iterations per second", 0, 1},
+    {"loopMax", units::kMicroseconds, "longest loop iteration", 0, 0},
+    {"loopP50", units::kMicroseconds, "loop iteration p50", 0, 0},
+    {"loopP99", units::kMicroseconds, "loop iteration p99", 0, 0},
+    {"modulesPct", units::kPercentage, "time in module updates", 0, 1},
+    {"tasksPct", units::kPercentage, "time in tasks", 0, 1},
+};
+static_assert(std::size(s_vars) == kVarCount, "s_vars must describe each VarIndex");
+
+}  // namespace
+
+LoopStats::LoopStats(const char* name)
+    : m_vg(name, s_vars),
+      m_loop_rate(kVarLoopRate, 0.0f, m_vg),
+      m_loop_max(kVarLoopMax, 0, m_vg),
+      m_loop_p50(kVarLoopP50, 0, m_vg),
+      m_loop_p99(kVarLoopP99, 0, m_vg),
+      m_modules_pct(kVarModulesPct, 0.0f, m_vg),
+      m_tasks_pct(kVarTasksPct, 0.0f, m_vg) {}
+
+void LoopStats::record(unsigned long update_usec) {
+  const uint32_t usec = clamp32(update_usec);
+  m_latency.add(usec);
+  m_window_loops += 1;
+  m_window_update_usec += usec;
+  if (usec > m_window_max_usec) {
+    m_window_max_usec = usec;
+  }
+}
+
+void LoopStats::update(unsigned long now_msec) {
+  const unsigned long elapsed_msec = now_msec - m_window_start_msec;
+  if (elapsed_msec == 0) {
+    return;
+  }
+  const float elapsed_usec = elapsed_msec * 1000.0f;
+  // Tasks run inside the update function of Tasks, so they are part of the update time.
+  const uint64_t modules_usec = m_window_update_usec > m_window_tasks_usec
+                                    ? m_window_update_usec - m_window_tasks_usec
+                                    : 0;
+  m_loop_rate = m_window_loops * 1000.0f / elapsed_msec;
+  m_loop_max = m_window_max_usec;
+  m_loop_p50 = m_latency.percentile(50);
+  m_loop_p99 = m_latency.percentile(99);
+  m_modules_pct = 100.0f * modules_usec / elapsed_usec;
+  m_tasks_pct = 100.0f * m_window_tasks_usec / elapsed_usec;
+
+  reset(now_msec);
+}
+
+void LoopStats::reset(unsigned long now_msec) {
+  m_latency.reset();
+  m_window_start_msec = now_msec;
+  m_window_loops = 0;
+  m_window_max_usec = 0;
+  m_window_update_usec = 0;
+  m_window_tasks_usec = 0;
+}
+
+}  // namespace og3
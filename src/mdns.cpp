@@ -15,6 +15,13 @@ namespace og3 {
 
 const char Mdns::kName[] = "mdns";
 
+#if defined(ARDUINO_ARCH_ESP8266)
+namespace {
+// How often the ESP8266 mDNS responder is polled for queries.
+constexpr unsigned kMdnsPollMsec = 50;
+}  // namespace
+#endif
+
 // Wrapper for digital input.
 Mdns::Mdns(Tasks* tasks) : Module(kName, tasks->module_system()), m_tasks(tasks) {
 #ifndef NATIVE
@@ -27,11 +34,13 @@ Mdns::Mdns(Tasks* tasks) : Module(kName, tasks->module_system()), m_tasks(tasks)
     }
   });
 #if defined(ARDUINO_ARCH_ESP8266)
-  add_update_fn([this]() {
-    if (m_ok && m_connected) {
-      MDNS.update();
-    }
-  });
+  add_update_fn(
+      [this]() {
+        if (m_ok && m_connected) {
+          MDNS.update();
+        }
+      },
+      kMdnsPollMsec);
 #endif
 #endif
 }
@@ -18,7 +18,14 @@ void Module::add_init_fn(const Thunk& thunk) { m_module_system->add_init_fn(thun
 
 void Module::add_start_fn(const Thunk& thunk) { m_module_system->add_start_fn(thunk, this); }
 
-void Module::add_update_fn(const Thunk& thunk) { m_module_system->add_update_fn(thunk, this); }
+ModuleSystem::UpdateId Module::add_update_fn(const Thunk& thunk, unsigned interval_msec) {
+  return m_module_system->add_update_fn(thunk, this, interval_msec);
+}
+
+ModuleSystem::UpdateId Module::add_update_fn(ModuleSystem::UpdateFn fn, void* ctx,
+                                             unsigned interval_msec) {
+  return m_module_system->add_update_fn(fn, ctx, this, interval_msec);
+}
 
 void Module::add_html_button(String* body, const char* label, const char* url) const {
   *body += "<a href='";
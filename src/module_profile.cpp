@@ -0,0 +1,142 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/module_profile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include "og3/html_table.h"
+#include "og3/units.h"
+
+namespace og3 {
+
+namespace {
+
+const char* const kPhaseNames[ModuleProfile::kNumPhases] = {"init", "start", "update"};
+
+uint32_t clamp32(unsigned long value) {
+  return value > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(value);
+}
+
+unsigned meanUsec(const ModuleProfile::Timing& timing) {
+  return timing.count ? static_cast<unsigned>(timing.total_usec / timing.count) : 0;
+}
+
+enum VarIndex : uint16_t {
+  kVarInitUsec,
+  kVarStartUsec,
+  kVarSlowestUpdate,
+  kVarSlowestUpdateMax,
+  kVarCount,
+};
+
+const VariableDescriptor s_vars[] PROGMEM = {
+    {"initUsec", units::kMicroseconds, "module init time", 0, 0},
+    {"startUsec", units::kMicroseconds, "module start time", 0, 0},
+    {"slowestUpdate", "", "module with the slowest update", 0, 0},
+    {"slowestUpdateMax", units::kMicroseconds, "slowest update time", 0, 0},
+};
+static_assert(std::size(s_vars) == kVarCount, "s_vars must describe each VarIndex");
+
+}  // namespace
+
+ModuleProfile::ModuleProfile(const char* name)
+    : m_vg(name, s_vars),
+      m_init_usec(kVarInitUsec, 0, m_vg),
+      m_start_usec(kVarStartUsec, 0, m_vg),
+      m_slowest_name(kVarSlowestUpdate, "", m_vg),
+      m_slowest_usec(kVarSlowestUpdateMax, 0, m_vg) {}
+
+void ModuleProfile::setNumModules(std::size_t num_modules) {
+  m_entries.assign(num_modules, Entry());
+}
+
+void ModuleProfile::record(std::size_t module_idx, Phase phase, unsigned long usec) {
+  if (module_idx >= m_entries.size()) {
+    return;
+  }
+  Timing& timing = m_entries[module_idx].phases[static_cast<int>(phase)];
+  const uint32_t run = clamp32(usec);
+  timing.count += 1;
+  timing.total_usec += run;
+  if (run > timing.max_usec) {
+    timing.max_usec = run;
+  }
+}
+
+void ModuleProfile::update() {
+  uint64_t init_usec = 0;
+  uint64_t start_usec = 0;
+  const Entry* slowest = nullptr;
+  for (const Entry& entry : m_entries) {
+    init_usec += entry.timing(Phase::kInit).total_usec;
+    start_usec += entry.timing(Phase::kStart).total_usec;
+    const Timing& update = entry.timing(Phase::kUpdate);
+    if (update.count && (!slowest || update.max_usec > slowest->timing(Phase::kUpdate).max_usec)) {
+      slowest = &entry;
+    }
+  }
+  m_init_usec = clamp32(init_usec);
+  m_start_usec = clamp32(start_usec);
+  m_slowest_usec = slowest ? slowest->timing(Phase::kUpdate).max_usec : 0;
+  const char* slowest_name = slowest && slowest->name ? slowest->name : "";
+  // Only assign the String when the slowest module changes.
+  if (0 != strcmp(m_slowest_name.value().c_str(), slowest_name)) {
+    m_slowest_name = slowest_name;
+  }
+}
+
+void ModuleProfile::reset() {
+  for (Entry& entry : m_entries) {
+    entry.phases[static_cast<int>(Phase::kUpdate)] = Timing();
+  }
+  update();
+}
+
+void ModuleProfile::writeHtmlInto(String* out_str) const {
+  *out_str +=
+      "<table class=\"readings\">\n"
+      "<thead><tr><th>module</th><th>init usec</th><th>start usec</th><th>updates</th>"
+      "<th>update mean usec</th><th>update max usec</th></tr></thead>\n"
+      "<tbody>\n";
+  char buf[96];
+  for (const Entry& entry : m_entries) {
+    *out_str += "<tr><td>";
+    html::escape(out_str, entry.name);
+    const Timing& update = entry.timing(Phase::kUpdate);
+    snprintf(buf, sizeof(buf), "</td><td>%lu</td><td>%lu</td><td>%lu</td><td>%u</td><td>%lu</td>",
+             static_cast<unsigned long>(entry.timing(Phase::kInit).total_usec),
+             static_cast<unsigned long>(entry.timing(Phase::kStart).total_usec),
+             static_cast<unsigned long>(update.count), meanUsec(update),
+             static_cast<unsigned long>(update.max_usec));
+    *out_str += buf;
+    *out_str += "</tr>\n";
+  }
+  html::writeTableEnd(out_str);
+}
+
+void ModuleProfile::writeJsonInto(String* out_str) const {
+  char buf[96];
+  *out_str += "[";
+  for (std::size_t i = 0; i < m_entries.size(); i++) {
+    const Entry& entry = m_entries[i];
+    *out_str += i ? ",{\"name\":\"" : "{\"name\":\"";
+    // Module names are identifiers, so they need no JSON escaping.
+    *out_str += entry.name ? entry.name : "";
+    *out_str += "\"";
+    for (std::size_t phase = 0; phase < kNumPhases; phase++) {
+      const Timing& timing = entry.phases[phase];
+      snprintf(buf, sizeof(buf), ",\"%s\":{\"count\":%lu,\"totalUsec\":%llu,\"maxUsec\":%lu}",
+               kPhaseNames[phase], static_cast<unsigned long>(timing.count),
+               static_cast<unsigned long long>(timing.total_usec),
+               static_cast<unsigned long>(timing.max_usec));
+      *out_str += buf;
+    }
+    *out_str += "}";
+  }
+  *out_str += "]";
+}
+
+}  // namespace og3
@@ -3,8 +3,17 @@
 
 #include "og3/module_system.h"
 
+#include <Arduino.h>
+
 #include <algorithm>
-#include <set>
+#include <cstring>
+#if defined(NATIVE)
+#include <thread>
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
 
 #include "og3/logger.h"
 #include "og3/module.h"
@@ -19,8 +28,31 @@ void ModuleSystem::add_module(Module* module) { m_modules.push_back(module); }
 
 void ModuleSystem::add_init_fn(const Thunk& fn, Module* mod) { m_init_fns.emplace_back(fn, mod); }
 void ModuleSystem::add_start_fn(const Thunk& fn, Module* mod) { m_start_fns.emplace_back(fn, mod); }
-void ModuleSystem::add_update_fn(const Thunk& fn, Module* mod) {
-  m_update_fns.emplace_back(fn, mod);
+ModuleSystem::UpdateId ModuleSystem::add_update_fn(UpdateFn fn, void* ctx, Module* mod,
+                                                   unsigned interval_msec) {
+  const UpdateId id = static_cast<UpdateId>(m_update_pos.size());
+  m_update_pos.push_back(static_cast<UpdateId>(m_update_fns.size()));
+  m_update_fns.push_back({fn, ctx, mod, 0, 0, id, true});
+  set_update_interval(id, interval_msec);
+  return id;
+}
+
+ModuleSystem::UpdateId ModuleSystem::add_update_fn(const Thunk& thunk, Module* mod,
+                                                   unsigned interval_msec) {
+  // A deque does not move its elements as it grows, so the context pointer stays valid.
+  m_update_thunks.push_back(thunk);
+  return add_update_fn([](void* ctx) { (*static_cast<Thunk*>(ctx))(); },
+                       &m_update_thunks.back(), mod, interval_msec);
+}
+
+void ModuleSystem::set_update_interval(UpdateId id, unsigned interval_msec) {
+  UpdateRec& rec = update_rec(id);
+  if ((rec.interval_msec == 0) != (interval_msec == 0)) {
+    m_num_rate_limited += interval_msec ? 1 : -1;
+    // A newly rate-limited callback is due at once.
+    rec.next_msec = interval_msec ? millis() : 0;
+  }
+  rec.interval_msec = interval_msec;
 }
 
 bool ModuleSystem::setup() {
@@ -39,18 +71,15 @@ bool ModuleSystem::setup() {
 }
 
 bool ModuleSystem::link() {
-  // Map module names to module pointers.
-  NameToModule name_to_module;
-  for (auto* mod : m_modules) {
-    name_to_module[mod->name()] = mod;
-  }
+  build_name_table();
 
   // Resolve declarative requirements
+  m_implicit_deps.reserve(m_pending_requirements.size());
   for (auto& req : m_pending_requirements) {
-    auto it = name_to_module.find(req.required_name);
-    if (it != name_to_module.end()) {
-      *(req.target_ptr) = it->second;
-      m_implicit_deps.push_back({req.owner, it->second});
+    Module* required = find(req.required_name);
+    if (required) {
+      *(req.target_ptr) = required;
+      m_implicit_deps.push_back({req.owner, required});
     } else {
       log()->logf("Failed to resolve requirement '%s' for module '%s'.", req.required_name,
                   req.owner->name());
@@ -60,45 +89,194 @@ bool ModuleSystem::link() {
 
   // Order the modules based on their dependencies.
   std::vector<size_t> sorted_module_indexes;
-  if (!topological_sort_internal(&sorted_module_indexes)) {
+  std::vector<uint16_t> levels;
+  if (!topological_sort_internal(&sorted_module_indexes, &levels)) {
     return false;
   }
 
   // Assign sorted indexes to modules.
+  m_levels.resize(sorted_module_indexes.size());
   for (size_t i = 0; i < sorted_module_indexes.size(); i++) {
     m_modules[sorted_module_indexes[i]]->set_sorted_idx(i);
+    m_levels[i] = levels[sorted_module_indexes[i]];
   }
 
-  // Re-sort the callback lists based on the sorted module order.
+  // Re-sort the callback lists based on the sorted module order, keeping the order in
+  // which each module registered its callbacks.
   auto sort_thunks = [this](std::vector<ThunkRec>& thunks) {
-    std::sort(thunks.begin(), thunks.end(), [](const ThunkRec& a, const ThunkRec& b) {
+    std::stable_sort(thunks.begin(), thunks.end(), [](const ThunkRec& a, const ThunkRec& b) {
       return a.mod->sorted_index() < b.mod->sorted_index();
     });
   };
 
   sort_thunks(m_init_fns);
   sort_thunks(m_start_fns);
-  sort_thunks(m_update_fns);
+  std::stable_sort(m_update_fns.begin(), m_update_fns.end(),
+                   [](const UpdateRec& a, const UpdateRec& b) {
+                     return a.mod->sorted_index() < b.mod->sorted_index();
+                   });
+  for (size_t i = 0; i < m_update_fns.size(); i++) {
+    m_update_pos[m_update_fns[i].id] = static_cast<UpdateId>(i);
+  }
+
+#ifdef OG3_MODULE_PROFILE
+  m_profile.setNumModules(m_modules.size());
+  for (const Module* mod : m_modules) {
+    m_profile.setName(mod->sorted_index(), mod->name());
+  }
+#endif
 
   m_is_ok = true;
   return true;
 }
 
+void ModuleSystem::call_init(ThunkRec& fn) {
+#ifdef OG3_MODULE_PROFILE
+  const unsigned long start_usec = micros();
+  fn.fn();
+  m_profile.record(fn.mod->sorted_index(), ModuleProfile::Phase::kInit, micros() - start_usec);
+#else
+  fn.fn();
+#endif
+}
+
 void ModuleSystem::init() {
   if (!m_is_ok) {
     return;
   }
+#if defined(NATIVE) || defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  if (m_init_workers > 1) {
+    init_parallel();
+    return;
+  }
+#endif
   for (auto& fn : m_init_fns) {
-    fn.fn();
+    call_init(fn);
+  }
+}
+
+void ModuleSystem::init_parallel() {
+  // Init functions are sorted by module, and Kahn's algorithm sorts modules in order of
+  // depth, so each level is a contiguous range of m_init_fns. Within a level, each
+  // module's run of init functions is one unit of work, so they keep their order.
+  // Runs of modules which did not opt in to concurrent init go first, one at a time.
+  std::vector<size_t> runs;
+  runs.reserve(m_init_fns.size());
+  m_init_levels.clear();
+  const size_t num_fns = m_init_fns.size();
+  for (size_t i = 0; i < num_fns;) {
+    const uint16_t level = m_levels[m_init_fns[i].mod->sorted_index()];
+    const unsigned long start_usec = micros();
+    size_t num_modules = 0;
+    runs.clear();
+    while (i < num_fns && m_levels[m_init_fns[i].mod->sorted_index()] == level) {
+      const Module* mod = m_init_fns[i].mod;
+      num_modules += 1;
+      if (mod->concurrent_init()) {
+        runs.push_back(i);
+      }
+      for (; i < num_fns && m_init_fns[i].mod == mod; i++) {
+        if (!mod->concurrent_init()) {
+          call_init(m_init_fns[i]);
+        }
+      }
+    }
+    if (!runs.empty()) {
+      run_init_level(runs.data(), runs.size());
+    }
+    const uint32_t usec = micros() - start_usec;
+    m_init_levels.push_back({level, static_cast<uint16_t>(num_modules),
+                             static_cast<uint16_t>(runs.size()), usec});
+    log()->debugf("Init level %u: %u modules (%u concurrent) in %lu usec.", level,
+                  static_cast<unsigned>(num_modules), static_cast<unsigned>(runs.size()),
+                  static_cast<unsigned long>(usec));
+  }
+}
+
+void ModuleSystem::init_worker(const size_t* runs, size_t num_runs, std::atomic<size_t>* next) {
+  for (size_t run = next->fetch_add(1); run < num_runs; run = next->fetch_add(1)) {
+    const Module* mod = m_init_fns[runs[run]].mod;
+    for (size_t k = runs[run]; k < m_init_fns.size() && m_init_fns[k].mod == mod; k++) {
+      call_init(m_init_fns[k]);
+    }
+  }
+}
+
+#if defined(NATIVE)
+void ModuleSystem::run_init_level(const size_t* runs, size_t num_runs) {
+  std::atomic<size_t> next{0};
+  const size_t num_threads = std::min<size_t>(m_init_workers, num_runs);
+  std::thread threads[kMaxInitWorkers];
+  // The calling thread is one of the workers.
+  for (size_t t = 1; t < num_threads; t++) {
+    threads[t] =
+        std::thread([this, runs, num_runs, &next]() { init_worker(runs, num_runs, &next); });
+  }
+  init_worker(runs, num_runs, &next);
+  for (size_t t = 1; t < num_threads; t++) {
+    threads[t].join();
+  }
+}
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+namespace {
+
+struct InitLevelJob {
+  ModuleSystem* module_system;
+  const size_t* runs;
+  size_t num_runs;
+  std::atomic<size_t>* next;
+  SemaphoreHandle_t done;
+};
+
+constexpr uint32_t kInitWorkerStackSize = 8192;
+
+}  // namespace
+
+void ModuleSystem::run_init_level(const size_t* runs, size_t num_runs) {
+  std::atomic<size_t> next{0};
+  InitLevelJob job{this, runs, num_runs, &next, xSemaphoreCreateCounting(kMaxInitWorkers, 0)};
+  const size_t num_threads = std::min<size_t>(m_init_workers, num_runs);
+  size_t num_started = 0;
+  for (size_t t = 1; job.done && t < num_threads; t++) {
+    auto worker = [](void* arg) {
+      InitLevelJob* job = static_cast<InitLevelJob*>(arg);
+      job->module_system->init_worker(job->runs, job->num_runs, job->next);
+      xSemaphoreGive(job->done);
+      vTaskDelete(nullptr);
+    };
+    if (pdPASS == xTaskCreate(worker, "og3-init", kInitWorkerStackSize, &job,
+                              uxTaskPriorityGet(nullptr), nullptr)) {
+      num_started += 1;
+    }
+  }
+  // The calling task is one of the workers, and finishes the level if no tasks started.
+  init_worker(runs, num_runs, &next);
+  for (size_t t = 0; t < num_started; t++) {
+    xSemaphoreTake(job.done, portMAX_DELAY);
+  }
+  if (job.done) {
+    vSemaphoreDelete(job.done);
   }
 }
+#else
+void ModuleSystem::run_init_level(const size_t* runs, size_t num_runs) {
+  std::atomic<size_t> next{0};
+  init_worker(runs, num_runs, &next);
+}
+#endif
 
 void ModuleSystem::start() {
   if (!m_is_ok) {
     return;
   }
   for (auto& fn : m_start_fns) {
+#ifdef OG3_MODULE_PROFILE
+    const unsigned long start_usec = micros();
+    fn.fn();
+    m_profile.record(fn.mod->sorted_index(), ModuleProfile::Phase::kStart, micros() - start_usec);
+#else
     fn.fn();
+#endif
   }
 }
 
@@ -106,10 +284,92 @@ int ModuleSystem::update() {
   if (!m_is_ok) {
     return -1;
   }
-  for (auto& fn : m_update_fns) {
-    fn.fn();
+  // The clock is only read if some callback is rate-limited.
+  const uint32_t now = m_num_rate_limited ? millis() : 0;
+  // Calls rec if it is enabled and due, and returns whether it was called.
+  auto dispatch = [&](UpdateRec& rec) {
+    if (!rec.enabled) {
+      return false;
+    }
+    if (rec.interval_msec) {
+      if (static_cast<int32_t>(now - rec.next_msec) < 0) {
+        return false;
+      }
+      rec.next_msec = now + rec.interval_msec;
+    }
+    const auto prev =
+        m_dispatch_trace.begin(DispatchTrace::Kind::kUpdate, rec.mod->sorted_index());
+#ifdef OG3_MODULE_PROFILE
+    const unsigned long start_usec = micros();
+    rec.fn(rec.ctx);
+    m_profile.record(rec.mod->sorted_index(), ModuleProfile::Phase::kUpdate,
+                     micros() - start_usec);
+#else
+    rec.fn(rec.ctx);
+#endif
+    m_dispatch_trace.end(prev);
+    return true;
+  };
+  int count = 0;
+  if (m_update_budget_usec == 0) {
+    for (auto& rec : m_update_fns) {
+      count += dispatch(rec);
+    }
+    return count;
+  }
+  // Run update functions round-robin, continuing where the previous call stopped.
+  const std::size_t num_fns = m_update_fns.size();
+  const unsigned long start_usec = micros();
+  for (std::size_t visited = 0; visited < num_fns;) {
+    if (m_update_cursor >= num_fns) {
+      m_update_cursor = 0;
+    }
+    const bool called = dispatch(m_update_fns[m_update_cursor++]);
+    visited += 1;
+    if (!called) {
+      continue;
+    }
+    count += 1;
+    if (visited < num_fns && micros() - start_usec >= m_update_budget_usec) {
+      m_update_deferrals += 1;
+      break;
+    }
+  }
+  return count;
+}
+
+void ModuleSystem::build_name_table() {
+  // The first module registered with a name is the one found.
+  auto name_of = [this](size_t i) { return m_modules[i]->name(); };
+  buildNameTable(&m_name_table, m_modules.size(), name_of, [this, &name_of](size_t i) {
+    log()->logf("Duplicate module name '%s'.", name_of(i));
+  });
+}
+
+Module* ModuleSystem::find(const char* name) const {
+  if (m_name_table.empty()) {
+    for (Module* mod : m_modules) {
+      if (0 == strcmp(mod->name(), name)) {
+        return mod;
+      }
+    }
+    return nullptr;
   }
-  return m_update_fns.size();
+  const uint16_t entry =
+      findInNameTable(m_name_table, name, [this](size_t i) { return m_modules[i]->name(); });
+  return entry ? m_modules[entry - 1] : nullptr;
+}
+
+Module* ModuleSystem::find_sorted(size_t sorted_idx) const {
+  if (!m_is_ok) {
+    return nullptr;
+  }
+  for (Module* mod : m_modules) {
+    if (mod->sorted_index() == sorted_idx) {
+      return mod;
+    }
+  }
+  return nullptr;
 }
 
 bool ModuleSystem::topological_sort(size_t* sorted_module_indexes) {
@@ -123,56 +383,85 @@ bool ModuleSystem::topological_sort(size_t* sorted_module_indexes) {
   return true;
 }
 
-bool ModuleSystem::topological_sort_internal(std::vector<size_t>* out_sorted_module_indexes) {
+bool ModuleSystem::topological_sort_internal(std::vector<size_t>* out_sorted_module_indexes,
+                                             std::vector<uint16_t>* out_levels) {
+  // Kahn's algorithm over a compressed sparse row (CSR) adjacency array, in O(M + E).
+  // Until link() assigns the sorted order, each module's sorted index holds its index in
+  // m_modules, which maps the Module pointers of the edges to indexes without a lookup table.
   const size_t n_modules = m_modules.size();
-  out_sorted_module_indexes->resize(n_modules);
-
-  std::map<const Module*, size_t> module_to_index;
   for (size_t i = 0; i < n_modules; i++) {
-    module_to_index[m_modules[i]] = i;
+    m_modules[i]->set_sorted_idx(i);
+  }
+  const size_t n_edges = m_implicit_deps.size();
+  std::vector<size_t>& sorted = *out_sorted_module_indexes;
+  sorted.resize(n_modules);
+
+  // All scratch space is allocated at once: CSR row offsets, the modules which depend on
+  // each module, each module's count of dependencies which are not yet sorted, and each
+  // module's depth: the length of the longest chain of requirements below it.
+  std::vector<size_t> scratch(3 * n_modules + 1 + n_edges, 0);
+  size_t* offsets = scratch.data();
+  size_t* dependents = offsets + n_modules + 1;
+  size_t* num_deps = dependents + n_edges;
+  size_t* levels = num_deps + n_modules;
+
+  for (const auto& edge : m_implicit_deps) {
+    offsets[edge.second->sorted_index() + 1] += 1;
+    num_deps[edge.first->sorted_index()] += 1;
   }
-
-  std::set<size_t> unsorted;
   for (size_t i = 0; i < n_modules; i++) {
-    unsorted.insert(i);
+    offsets[i + 1] += offsets[i];
   }
+  // Fill each row, advancing its offset to the start of the next row, then shift back.
+  for (const auto& edge : m_implicit_deps) {
+    dependents[offsets[edge.second->sorted_index()]++] = edge.first->sorted_index();
+  }
+  for (size_t i = n_modules; i > 0; i--) {
+    offsets[i] = offsets[i - 1];
+  }
+  offsets[0] = 0;
 
-  std::vector<bool> visiting(n_modules, false);
-
-  std::function<bool(size_t)> visit = [&](size_t idx) -> bool {
-    if (visiting[idx]) {
-      log()->logf("Circular dependency detected involving module '%s'.", m_modules[idx]->name());
-      return false;
-    }
-    if (unsorted.find(idx) == unsorted.end()) {
-      return true;
+  // The output doubles as the queue of modules whose dependencies are all sorted.
+  size_t tail = 0;
+  for (size_t i = 0; i < n_modules; i++) {
+    if (num_deps[i] == 0) {
+      sorted[tail++] = i;
     }
-
-    visiting[idx] = true;
-    const Module* module = m_modules[idx];
-
-    for (const auto& edge : m_implicit_deps) {
-      if (edge.first == module) {
-        if (!visit(module_to_index[edge.second])) {
-          return false;
-        }
+  }
+  for (size_t head = 0; head < tail; head++) {
+    const size_t idx = sorted[head];
+    for (size_t k = offsets[idx]; k < offsets[idx + 1]; k++) {
+      levels[dependents[k]] = std::max(levels[dependents[k]], levels[idx] + 1);
+      if (--num_deps[dependents[k]] == 0) {
+        sorted[tail++] = dependents[k];
       }
     }
-
-    visiting[idx] = false;
-    const size_t sidx = n_modules - unsorted.size();
-    (*out_sorted_module_indexes)[sidx] = idx;
-    unsorted.erase(idx);
+  }
+  if (tail == n_modules) {
+    if (out_levels) {
+      out_levels->assign(levels, levels + n_modules);
+    }
     return true;
-  };
+  }
 
-  while (!unsorted.empty()) {
-    if (!visit(*unsorted.begin())) {
-      return false;
+  // Every unsorted module has an unsorted dependency. Follow those from the first unsorted
+  // module until one repeats: that module is on a cycle. This is only done on failure.
+  constexpr size_t kVisited = static_cast<size_t>(-1);
+  size_t idx = 0;
+  while (num_deps[idx] == 0) {
+    idx += 1;
+  }
+  while (num_deps[idx] != kVisited) {
+    num_deps[idx] = kVisited;
+    for (const auto& edge : m_implicit_deps) {
+      if (edge.first->sorted_index() == idx && num_deps[edge.second->sorted_index()] != 0) {
+        idx = edge.second->sorted_index();
+        break;
+      }
     }
   }
-
-  return true;
+  log()->logf("Circular dependency detected involving module '%s'.", m_modules[idx]->name());
+  return false;
 }
 
 }  // namespace og3
@@ -6,16 +6,20 @@
 #include <ArduinoJson.h>
 
 #include <functional>
+#include <iterator>
 
 #include "og3/config_interface.h"
 #include "og3/constants.h"
 #include "og3/html_table.h"
+#include "og3/json_writer.h"
 #include "og3/web_server.h"
 #include "og3/wifi_manager.h"
 
 namespace {
 const char* s_str_modes[] = {"home-assistant", "adafruit.io."};
 const char* s_str_connected[] = {"not connected", "connected"};
+// Groups whose JSON is longer than this are serialized through a JsonDocument instead.
+constexpr unsigned kJsonBufferSize = 512;
 }  // namespace
 
 namespace og3 {
@@ -44,34 +48,56 @@ String MqttManager::willTopic(const char* device_name) const {
   return topic("connection", device_name);
 }
 
+namespace {
+
+enum VarIndex : uint16_t {
+  kVarEnabled,
+  kVarHostAddr,
+  kVarAuthUser,
+  kVarAuthPassword,
+  kVarMode,
+  kVarConnection,
+  kVarCount,
+};
+
+const VariableDescriptor s_vars[] PROGMEM = {
+    {"enabled", "", "Enable MQTT",
+     VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish, 0},
+    {"hostAddr", "", "MQTT server", VariableBase::kConfig | VariableBase::kSettable, 0},
+    {"authUser", "", "username", VariableBase::kConfig | VariableBase::kSettable, 0},
+    {"authPassword", "", "password",
+     VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish |
+         VariableBase::kNoDisplay,
+     0},
+    {"mode", nullptr, "mode",
+     VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish, 0},
+    {"connection", nullptr, "connection", VariableBase::kNoPublish, 0},
+};
+static_assert(std::size(s_vars) == kVarCount, "s_vars must describe each VarIndex");
+
+}  // namespace
+
 MqttManager::MqttManager(const Options& opts, Tasks* tasks)
     : Module(kName, tasks->module_system()),
       m_opts(opts),
       m_connect_scheduler([this]() { connect(); }, tasks),
-      m_vg(kName, nullptr, 4),
-      m_enabled("enabled", true, "Enable MQTT",
-                VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish, m_vg),
-      m_host_addr("hostAddr", opts.default_server, "", "MQTT server",
-                  VariableBase::kConfig | VariableBase::kSettable, m_vg),
+      m_vg(kName, s_vars),
+      m_enabled(kVarEnabled, true, m_vg),
+      m_host_addr(kVarHostAddr, opts.default_server, m_vg),
 #if 0
       m_port("port", opts.port, "", "port",
                   VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish, m_vg),
 #endif
-      m_auth_user("authUser", opts.default_user, "", "username",
-                  VariableBase::kConfig | VariableBase::kSettable, m_vg),
-      m_auth_password("authPassword", opts.default_password, "", "password",
-                      VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish |
-                          VariableBase::kNoDisplay,
-                      m_vg),
-      m_mode("mode", opts.mode, "mode", Mode::kAdafruitIO, s_str_modes,
-             VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish, m_vg),
-      m_connected("connection", kNotConnected, "connection", kConnected, s_str_connected,
-                  VariableBase::kNoPublish, m_vg) {
+      m_auth_user(kVarAuthUser, opts.default_user, m_vg),
+      m_auth_password(kVarAuthPassword, opts.default_password, m_vg),
+      m_mode(kVarMode, opts.mode, Mode::kAdafruitIO, s_str_modes, m_vg),
+      m_connected(kVarConnection, kNotConnected, kConnected, s_str_connected, m_vg) {
   // Module callbacks
   require(ConfigInterface::kName, &m_config);
   require(WifiManager::kName, &m_wifi_manager);
 
   add_init_fn([this]() {
+    m_json_buffer.reset(new char[kJsonBufferSize]);
     if (m_config) {
       m_config->read_config(m_vg);
     }
@@ -97,6 +123,7 @@ MqttManager::MqttManager(const Options& opts, Tasks* tasks)
   m_mqttClient.onSubscribe(
       [this](int packetId) { log()->logf("Subscription acknowledged. packetId: %d", packetId); });
   m_mqttClient.onMessage([this](char* topic, char* payload, int len, int index, bool total) {
+    Tasks::wake();  // Let a sleeping loop() act on the message.
     for (const auto& it : m_mqtt_callbacks) {
       if (it.topic == topic) {
         it.callback_fn(topic, payload, static_cast<size_t>(len));
@@ -122,6 +149,7 @@ MqttManager::MqttManager(const Options& opts, Tasks* tasks)
   m_mqttClient.onMessage([this](char* topic, char* payload,
                                 AsyncMqttClientMessageProperties properties, size_t len,
                                 size_t index, size_t total) {
+    Tasks::wake();  // Let a sleeping loop() act on the message.
     for (const auto& it : m_mqtt_callbacks) {
       if (it.topic == topic) {
         it.callback_fn(topic, payload, len);
@@ -222,23 +250,42 @@ void MqttManager::mqttSend(const char topic[], const char content[]) {
 #endif
 }
 
-bool MqttManager::mqttSend(const VariableGroup& variables, unsigned flags) {
+bool MqttManager::mqttSend(const VariableGroup& variables, unsigned flags, SendMode mode) {
   if (!connected()) {
     return false;
   }
+  // Changes to variables which these flags leave out, such as kNoPublish ones, do not
+  // cause a publish, and their changed bits are kept.
+  if (mode != SendMode::kAll && !variables.changedToPublish(flags)) {
+    return false;
+  }
+  const bool changed_only = mode == SendMode::kChanged;
+  if (m_json_buffer) {
+    JsonWriter json(m_json_buffer.get(), kJsonBufferSize);
+    if (this->mode() == Mode::kAdafruitIO) {
+      json.raw("value:");
+    }
+    variables.writeJson(&json, flags, changed_only);
+    if (!json.truncated()) {
+      mqttSend(topic(variables.id()).c_str(), m_json_buffer.get());
+      variables.clearChanged(flags);
+      return true;
+    }
+  }
   String mqttOutput;
-  switch (mode()) {
+  switch (this->mode()) {
     case Mode::kHomeAssistant: {
-      variables.toJson(&mqttOutput, flags);
+      variables.toJson(&mqttOutput, flags, changed_only);
       break;
     }
     case Mode::kAdafruitIO:
       String values;
-      variables.toJson(&values, flags);
+      variables.toJson(&values, flags, changed_only);
       mqttOutput = String("value:") + values;
       break;
   }
   mqttSend(topic(variables.id()).c_str(), mqttOutput.c_str());
+  variables.clearChanged(flags);
   return true;
 }
 
@@ -0,0 +1,288 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/number_format.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace og3 {
+
+namespace {
+
+constexpr uint64_t kPow10[] = {1ull,
+                               10ull,
+                               100ull,
+                               1000ull,
+                               10000ull,
+                               100000ull,
+                               1000000ull,
+                               10000000ull,
+                               100000000ull,
+                               1000000000ull,
+                               10000000000ull,
+                               100000000000ull,
+                               1000000000000ull,
+                               10000000000000ull,
+                               100000000000000ull,
+                               1000000000000000ull,
+                               10000000000000000ull,
+                               100000000000000000ull,
+                               1000000000000000000ull};
+constexpr unsigned kMaxDecimals = sizeof(kPow10) / sizeof(kPow10[0]) - 1;
+// Scaled values below this are rounded to a uint64_t.
+constexpr double kMaxScaled = 9.0e18;
+
+// Powers of ten which are exact as doubles.
+constexpr double kExactPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+constexpr int kMaxExactPow10 = sizeof(kExactPow10) / sizeof(kExactPow10[0]) - 1;
+// Mantissas up to this many digits are exact as doubles.
+constexpr int kMaxExactDigits = 15;
+// Mantissa digits kept while parsing; later digits only scale the number.
+constexpr int kMaxMantissaDigits = 19;
+
+std::size_t put(char* buf, std::size_t len, const char* text, std::size_t text_len) {
+  if (len > 0) {
+    const std::size_t num = text_len < len ? text_len : len - 1;
+    memcpy(buf, text, num);
+    buf[num] = 0;
+  }
+  return text_len;
+}
+
+// Writes the digits of val before end, and returns where they start.
+char* writeDigits(char* end, uint64_t val) {
+  do {
+    *--end = static_cast<char>('0' + val % 10);
+    val /= 10;
+  } while (val);
+  return end;
+}
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+const char* skipSpaces(const char* p, const char* end) {
+  while (p < end && isSpace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+// Parses one or more digits at p, advancing p past them.
+bool parseDigits(const char** p, const char* end, uint64_t* out) {
+  const char* start = *p;
+  uint64_t val = 0;
+  for (; *p < end && isDigit(**p); (*p)++) {
+    const unsigned digit = **p - '0';
+    if (val > (UINT64_MAX - digit) / 10) {
+      return false;
+    }
+    val = val * 10 + digit;
+  }
+  *out = val;
+  return *p > start;
+}
+
+// Compares a case-insensitive lowercase word at p.
+bool matchWord(const char* p, const char* end, const char* word) {
+  for (; *word; word++, p++) {
+    if (p >= end || (*p | 0x20) != *word) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+std::size_t formatText(char* buf, std::size_t len, const char* text) {
+  return put(buf, len, text, strlen(text));
+}
+
+std::size_t formatUnsigned(char* buf, std::size_t len, unsigned long long val) {
+  char text[24];
+  const char* start = writeDigits(text + sizeof(text), val);
+  return put(buf, len, start, text + sizeof(text) - start);
+}
+
+std::size_t formatInt(char* buf, std::size_t len, long long val) {
+  char text[24];
+  // Negate as unsigned, so that the most negative value does not overflow.
+  const uint64_t magnitude =
+      val < 0 ? 0ull - static_cast<uint64_t>(val) : static_cast<uint64_t>(val);
+  char* start = writeDigits(text + sizeof(text), magnitude);
+  if (val < 0) {
+    *--start = '-';
+  }
+  return put(buf, len, start, text + sizeof(text) - start);
+}
+
+std::size_t formatFixed(char* buf, std::size_t len, double val, unsigned decimals) {
+  if (std::isnan(val)) {
+    return formatText(buf, len, "nan");
+  }
+  if (std::isinf(val)) {
+    return formatText(buf, len, val < 0 ? "-inf" : "inf");
+  }
+  const bool negative = val < 0;
+  const double scaled =
+      decimals <= kMaxDecimals ? (negative ? -val : val) * kPow10[decimals] : kMaxScaled;
+  if (scaled >= kMaxScaled) {
+    return snprintf(buf, len, "%.*f", static_cast<int>(decimals), val);
+  }
+  const uint64_t units = static_cast<uint64_t>(scaled + 0.5);
+  char text[48];
+  char* start = text + sizeof(text);
+  if (decimals > 0) {
+    char* const point = start - decimals;
+    start = writeDigits(start, units % kPow10[decimals]);
+    while (start > point) {
+      *--start = '0';
+    }
+    *--start = '.';
+  }
+  start = writeDigits(start, units / kPow10[decimals]);
+  // Values which round to zero get no sign.
+  if (negative && units) {
+    *--start = '-';
+  }
+  return put(buf, len, start, text + sizeof(text) - start);
+}
+
+bool parseUnsigned(const char* text, std::size_t len, unsigned long long* out) {
+  const char* end = text + len;
+  const char* p = skipSpaces(text, end);
+  if (p < end && *p == '+') {
+    p++;
+  }
+  uint64_t val = 0;
+  if (!parseDigits(&p, end, &val)) {
+    return false;
+  }
+  *out = val;
+  return true;
+}
+
+bool parseInt(const char* text, std::size_t len, long long* out) {
+  const char* end = text + len;
+  const char* p = skipSpaces(text, end);
+  const bool negative = p < end && *p == '-';
+  if (p < end && (*p == '-' || *p == '+')) {
+    p++;
+  }
+  uint64_t magnitude = 0;
+  if (!parseDigits(&p, end, &magnitude)) {
+    return false;
+  }
+  const uint64_t limit = static_cast<uint64_t>(LLONG_MAX) + (negative ? 1 : 0);
+  if (magnitude > limit) {
+    return false;
+  }
+  *out = negative ? static_cast<long long>(0ull - magnitude) : static_cast<long long>(magnitude);
+  return true;
+}
+
+bool parseDouble(const char* text, std::size_t len, double* out) {
+  const char* end = text + len;
+  const char* start = skipSpaces(text, end);
+  const char* p = start;
+  const bool negative = p < end && *p == '-';
+  if (p < end && (*p == '-' || *p == '+')) {
+    p++;
+  }
+  if (matchWord(p, end, "nan")) {
+    *out = NAN;
+    return true;
+  }
+  if (matchWord(p, end, "inf")) {
+    *out = negative ? -INFINITY : INFINITY;
+    return true;
+  }
+
+  uint64_t mantissa = 0;
+  int num_digits = 0;  // Significant digits in the mantissa.
+  int exp10 = 0;
+  bool any_digits = false;
+  for (; p < end && isDigit(*p); p++) {
+    any_digits = true;
+    if (mantissa == 0 && *p == '0') {
+      continue;
+    }
+    if (num_digits < kMaxMantissaDigits) {
+      mantissa = mantissa * 10 + (*p - '0');
+      num_digits += 1;
+    } else {
+      exp10 += 1;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && isDigit(*p); p++) {
+      any_digits = true;
+      if (mantissa == 0 && *p == '0') {
+        exp10 -= 1;
+        continue;
+      }
+      if (num_digits < kMaxMantissaDigits) {
+        mantissa = mantissa * 10 + (*p - '0');
+        num_digits += 1;
+        exp10 -= 1;
+      }
+    }
+  }
+  if (!any_digits) {
+    return false;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    // The exponent is only used if it has digits, as with strtod().
+    const char* q = p + 1;
+    const bool exp_negative = q < end && *q == '-';
+    if (q < end && (*q == '-' || *q == '+')) {
+      q++;
+    }
+    int exp = 0;
+    bool exp_digits = false;
+    for (; q < end && isDigit(*q); q++) {
+      exp_digits = true;
+      if (exp < 100000) {
+        exp = exp * 10 + (*q - '0');
+      }
+    }
+    if (exp_digits) {
+      exp10 += exp_negative ? -exp : exp;
+      p = q;
+    }
+  }
+
+  double val = 0;
+  if (mantissa == 0) {
+    val = 0;
+  } else if (num_digits <= kMaxExactDigits && exp10 >= -kMaxExactPow10 &&
+             exp10 <= kMaxExactPow10) {
+    // Both operands are exact, so one correctly rounded operation gives the nearest double.
+    val = static_cast<double>(mantissa);
+    val = exp10 < 0 ? val / kExactPow10[-exp10] : val * kExactPow10[exp10];
+  } else {
+    char copy[64];
+    const std::size_t copy_len = p - start;
+    if (copy_len < sizeof(copy)) {
+      memcpy(copy, start, copy_len);
+      copy[copy_len] = 0;
+      *out = strtod(copy, nullptr);
+      return true;
+    }
+    val = static_cast<double>(mantissa) * std::pow(10.0, exp10);
+  }
+  *out = negative ? -val : val;
+  return true;
+}
+
+}  // namespace og3
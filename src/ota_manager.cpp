@@ -4,6 +4,8 @@
 #include "og3/ota_manager.h"
 
 #include <Arduino.h>
+
+#include <iterator>
 #ifndef NATIVE
 #include <ArduinoOTA.h>
 #endif
@@ -15,12 +17,23 @@ namespace og3 {
 
 const char OtaManager::kName[] = "ota";
 
+namespace {
+// How often to check for an OTA update request.
+constexpr unsigned kOtaPollMsec = 50;
+
+enum VarIndex : uint16_t { kVarPassword, kVarCount };
+
+const VariableDescriptor s_vars[] PROGMEM = {
+    {"password", "", "password", VariableBase::kConfig | VariableBase::kSettable, 0},
+};
+static_assert(std::size(s_vars) == kVarCount, "s_vars must describe each VarIndex");
+}  // namespace
+
 OtaManager::OtaManager(const Options& opts, ModuleSystem* module_system)
     : Module(kName, module_system),
       m_opts(opts),
-      m_vg(kName),
-      m_password("password", opts.default_password, "", "password",
-                 VariableBase::kConfig | VariableBase::kSettable, m_vg) {
+      m_vg(kName, s_vars),
+      m_password(kVarPassword, opts.default_password, m_vg) {
   require(WifiManager::kName, &m_wifi_manager);
   require(ConfigInterface::kName, &m_config);
   add_init_fn([this]() {
@@ -31,7 +44,7 @@ OtaManager::OtaManager(const Options& opts, ModuleSystem* module_system)
     setup();
   });
 #ifndef NATIVE
-  add_update_fn([this]() { ArduinoOTA.handle(); });
+  add_update_fn([this]() { ArduinoOTA.handle(); }, kOtaPollMsec);
 #endif
 }
 
@@ -11,12 +11,6 @@
 
 namespace og3 {
 
-namespace {
-Thunk s_motion_callback;
-}  // namespace
-
-bool Pir::s_interrupt_setup = false;
-
 Pir::Pir(const char* module_name, const char* motion_name, ModuleSystem* module_system, uint8_t pin,
          const char* description, VariableGroup& vg, bool publish, bool ha_discovery, int pin_mode)
     : Module(module_name, module_system),
@@ -35,20 +29,27 @@ Pir::Pir(const char* module_name, const char* motion_name, ModuleSystem* module_
 
 // Interrupt routine causes onMotion to run in the main process
 #ifndef NATIVE
-void IRAM_ATTR Pir::_onMotion() { Tasks::run_next(s_motion_callback); }
+void IRAM_ATTR Pir::_onMotion(void* pir) { Tasks::run_next(&Pir::runMotionCallback, pir); }
 #endif
 
 // static
+void Pir::runMotionCallback(void* pir) {
+  const Thunk& callback = static_cast<Pir*>(pir)->m_motion_callback;
+  if (callback) {
+    callback();
+  }
+}
+
 void Pir::callOnMotion(const Thunk& thunk) {
   if (!thunk) {
     return;
   }
-  s_motion_callback = thunk;
-  if (!s_interrupt_setup) {
+  m_motion_callback = thunk;
+  if (!m_interrupt_setup) {
 #ifndef NATIVE
-    attachInterrupt(digitalPinToInterrupt(m_din.pin()), Pir::_onMotion, CHANGE);
+    attachInterruptArg(digitalPinToInterrupt(m_din.pin()), Pir::_onMotion, this, CHANGE);
 #endif
-    s_interrupt_setup = true;
+    m_interrupt_setup = true;
   }
 }
 
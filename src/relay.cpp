@@ -29,11 +29,19 @@ bool Relay::turnOn(int on_msec, const std::function<void()>& off_fn) {
 }
 
 void Relay::turnOffIn(int msec, const std::function<void()>& fn) {
+  // Only the latest turn-off time applies.
+  m_tasks->cancel(m_off_task);
   m_off_callback = fn;
-  m_tasks->runIn(msec, [this]() { turnOff(); });
+  m_off_task = m_tasks->runIn(msec, [this]() {
+    // The task has run, so its handle must not cancel whichever task reuses its node.
+    m_off_task = TaskHandle();
+    turnOff();
+  });
 }
 
 void Relay::turnOff() {
+  m_tasks->cancel(m_off_task);
+  m_off_task = TaskHandle();
   const bool was_on = isOn();
   set(m_on_level == OnLevel::kHigh ? false : true);
   if (m_off_callback) {
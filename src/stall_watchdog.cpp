@@ -0,0 +1,282 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/stall_watchdog.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include "og3/logger.h"
+#include "og3/module_system.h"
+#include "og3/units.h"
+
+#if defined(NATIVE)
+#include <chrono>
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+#include <esp_attr.h>
+#include <esp_log.h>
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+#include <Esp.h>
+#endif
+
+namespace og3 {
+
+const char StallWatchdog::kName[] = "stall_watchdog";
+
+namespace {
+
+using Kind = DispatchTrace::Kind;
+
+// How often the loop reports near misses.
+constexpr unsigned kReportMsec = 1000;
+
+enum VarIndex : uint16_t { kVarNearMisses, kVarResetStall, kVarResetStallMsec, kVarCount };
+
+const VariableDescriptor s_vars[] PROGMEM = {
+    {"stallNearMisses", "", "stalls which recovered", 0, 0},
+    {"resetStall", "", "callback running at the last reset", 0, 0},
+    {"resetStallMsec", units::kMilliseconds, "stall before the last reset", 0, 0},
+};
+static_assert(std::size(s_vars) == kVarCount, "s_vars must describe each VarIndex");
+
+#if !defined(NATIVE) && (defined(ARDUINO_ARCH_ESP32) || defined(ESP32))
+// Not cleared on a software or watchdog reset.
+RTC_NOINIT_ATTR StallWatchdog::Record s_rtc_record;
+constexpr const char* kTag = "og3";
+constexpr UBaseType_t kMonitorPriority = 2;  // Above the Arduino loop task.
+constexpr uint32_t kMonitorStackSize = 2048;
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+static_assert(sizeof(StallWatchdog::Record) % 4 == 0, "RTC memory is read in 4-byte blocks");
+#endif
+
+}  // namespace
+
+StallWatchdog::StallWatchdog(const Options& options, Tasks* tasks)
+    : Module(kName, tasks->module_system()),
+      m_options(options),
+      m_trace(tasks->module_system()->dispatch_trace()),
+      m_vg(kName, s_vars),
+      m_near_misses_var(kVarNearMisses, 0, m_vg),
+      m_reset_stall(kVarResetStall, "", m_vg),
+      m_reset_stall_msec(kVarResetStallMsec, 0, m_vg) {
+  Record record;
+  if (readRecord(&record)) {
+    m_reset_by_stall = true;
+    m_reset_record = record;
+    char desc[48];
+    describe(record, desc, sizeof(desc));
+    m_reset_stall = desc;
+    m_reset_stall_msec = record.stall_msec;
+    clearRecord();
+  }
+  add_start_fn([this]() {
+    if (m_reset_by_stall) {
+      log()->logf("Loop stalled in %s for %u msec before reset.", m_reset_stall.value().c_str(),
+                  static_cast<unsigned>(m_reset_record.stall_msec));
+    }
+  });
+  add_update_fn([this]() { update(); }, kReportMsec);
+
+  if (m_options.check_msec == 0) {
+    return;
+  }
+#if defined(NATIVE)
+  m_monitor = std::thread([this]() { monitorMain(); });
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  xTaskCreate(&StallWatchdog::monitorTask, kName, kMonitorStackSize, this, kMonitorPriority,
+              &m_monitor);
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  os_timer_setfn(&m_monitor, &StallWatchdog::monitorTimer, this);
+  os_timer_arm(&m_monitor, m_options.check_msec, true /*repeat*/);
+  m_monitor_armed = true;
+#endif
+}
+
+StallWatchdog::~StallWatchdog() {
+#if defined(NATIVE)
+  if (m_monitor.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_cv.notify_all();
+    m_monitor.join();
+  }
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  if (m_monitor) {
+    vTaskDelete(m_monitor);
+  }
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  if (m_monitor_armed) {
+    os_timer_disarm(&m_monitor);
+  }
+#endif
+}
+
+#if defined(NATIVE)
+void StallWatchdog::monitorMain() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_cv.wait_for(lock, std::chrono::milliseconds(m_options.check_msec),
+                        [this]() { return m_stopping; })) {
+    check(m_options.check_msec);
+  }
+}
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+void StallWatchdog::monitorTask(void* watchdog) {
+  auto* self = static_cast<StallWatchdog*>(watchdog);
+  const TickType_t period = pdMS_TO_TICKS(self->m_options.check_msec);
+  while (true) {
+    vTaskDelay(period > 0 ? period : 1);
+    self->check(self->m_options.check_msec);
+  }
+}
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+void StallWatchdog::monitorTimer(void* watchdog) {
+  auto* self = static_cast<StallWatchdog*>(watchdog);
+  self->check(self->m_options.check_msec);
+}
+#endif
+
+void StallWatchdog::check(unsigned elapsed_msec) {
+  const DispatchTrace::Sample sample = m_trace.sample();
+  if (sample.seq != m_last_seq || sample.kind == Kind::kNone) {
+    // The loop made progress since the last check.
+    if (m_recorded) {
+      clearRecord();
+      m_recorded = false;
+      m_num_near_misses.fetch_add(1);
+      // Drop the details if the loop has not reported the previous near miss yet.
+      if (!m_near_miss_pending.load(std::memory_order_acquire)) {
+        m_near_miss = m_stall;
+        m_near_miss_pending.store(true, std::memory_order_release);
+      }
+    }
+    m_last_seq = sample.seq;
+    m_stall_msec = 0;
+    return;
+  }
+  m_stall_msec += elapsed_msec;
+  if (m_stall_msec < m_options.warn_msec) {
+    return;
+  }
+  // Record the stall, then keep its duration current until the loop recovers or resets.
+  if (!m_recorded) {
+    m_stall = Record();
+    m_stall.magic = kMagic;
+    m_stall.kind = static_cast<uint8_t>(sample.kind);
+    m_stall.id = sample.id;
+    if (sample.kind == Kind::kUpdate) {
+      const Module* module = module_system()->find_sorted(sample.id);
+      if (module && module->name()) {
+        strncpy(m_stall.module, module->name(), sizeof(m_stall.module) - 1);
+      }
+    }
+  }
+  m_stall.stall_msec = m_stall_msec;
+  m_stall.check = checksum(m_stall);
+  writeRecord(m_stall);
+#if !defined(NATIVE) && (defined(ARDUINO_ARCH_ESP32) || defined(ESP32))
+  if (!m_recorded) {
+    // The loop is stuck, so it cannot log this itself.
+    char desc[48];
+    describe(m_stall, desc, sizeof(desc));
+    ESP_LOGW(kTag, "Loop stalled in %s for %u msec.", desc, m_stall_msec);
+  }
+#endif
+  m_recorded = true;
+}
+
+void StallWatchdog::update() {
+  m_near_misses_var = m_num_near_misses.load();
+  if (!m_near_miss_pending.load(std::memory_order_acquire)) {
+    return;
+  }
+  char desc[48];
+  describe(m_near_miss, desc, sizeof(desc));
+  const unsigned stall_msec = m_near_miss.stall_msec;
+  m_near_miss_pending.store(false, std::memory_order_release);
+  log()->logf("Loop stalled in %s for at least %u msec.", desc, stall_msec);
+}
+
+void StallWatchdog::describe(const Record& record, char* out, std::size_t size) const {
+  switch (static_cast<Kind>(record.kind)) {
+    case Kind::kUpdate:
+      snprintf(out, size, "update of '%.*s'", static_cast<int>(sizeof(record.module)),
+               record.module);
+      break;
+    case Kind::kTask:
+      snprintf(out, size, "task %u", static_cast<unsigned>(record.id));
+      break;
+    default:
+      snprintf(out, size, "unknown callback");
+      break;
+  }
+}
+
+uint32_t StallWatchdog::checksum(const Record& record) {
+  // FNV-1a over every field before the checksum.
+  const auto* bytes = reinterpret_cast<const uint8_t*>(&record);
+  uint32_t hash = 2166136261u;
+  for (std::size_t i = 0; i < offsetof(Record, check); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+bool StallWatchdog::readRecord(Record* record) {
+#if defined(NATIVE)
+  FILE* file = fopen(m_options.path, "rb");
+  if (!file) {
+    return false;
+  }
+  const bool ok = 1 == fread(record, sizeof(*record), 1, file);
+  fclose(file);
+  if (!ok) {
+    return false;
+  }
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  *record = s_rtc_record;
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  if (!ESP.rtcUserMemoryRead(m_options.rtc_block, reinterpret_cast<uint32_t*>(record),
+                             sizeof(*record))) {
+    return false;
+  }
+#else
+  return false;
+#endif
+  return record->magic == kMagic && record->check == checksum(*record);
+}
+
+void StallWatchdog::writeRecord(const Record& record) {
+#if defined(NATIVE)
+  FILE* file = fopen(m_options.path, "wb");
+  if (file) {
+    fwrite(&record, sizeof(record), 1, file);
+    fclose(file);
+  }
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  s_rtc_record = record;
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  ESP.rtcUserMemoryWrite(m_options.rtc_block,
+                         reinterpret_cast<uint32_t*>(const_cast<Record*>(&record)),
+                         sizeof(record));
+#else
+  (void)record;
+#endif
+}
+
+void StallWatchdog::clearRecord() {
+#if defined(NATIVE)
+  remove(m_options.path);
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  s_rtc_record.magic = 0;
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  uint32_t magic = 0;
+  ESP.rtcUserMemoryWrite(m_options.rtc_block + offsetof(Record, magic) / 4, &magic,
+                         sizeof(magic));
+#endif
+}
+
+}  // namespace og3
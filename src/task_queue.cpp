@@ -8,220 +8,463 @@
 
 namespace og3 {
 
-TaskQueue::TaskQueue(std::size_t capacity) : m_pool(capacity) {
+namespace {
+
+// Size of the ID table: a power of two with at most 50% load at full capacity.
+std::size_t idTableSize(std::size_t capacity) {
+  std::size_t size = 1;
+  while (size < 2 * capacity) {
+    size <<= 1;
+  }
+  return capacity > 0 ? size : 0;
+}
+
+}  // namespace
+
+TaskQueue::TaskQueue(std::size_t capacity)
+    : m_pool(capacity),
+      m_heap(capacity, kInvalidIdx),
+      m_id_table(idTableSize(capacity), kInvalidIdx) {
   // Initialize the free list
   if (capacity > 0) {
     m_free_head = 0;
     for (std::size_t i = 0; i < capacity - 1; ++i) {
-      m_pool[i].next = static_cast<NodeIdx>(i + 1);
+      m_pool[i].next_free = static_cast<NodeIdx>(i + 1);
     }
-    m_pool[capacity - 1].next = kInvalidIdx;
+    m_pool[capacity - 1].next_free = kInvalidIdx;
   }
 }
 
-bool TaskQueue::insert(unsigned long msec, const Thunk& t, unsigned id) {
+TaskHandle TaskQueue::insert(unsigned long msec, TaskThunk t, unsigned id,
+                             unsigned long slack_msec) {
   if (full()) {
-    return false;
+    return TaskHandle();
   }
-  insertReplace(msec, t, id);
-  return true;
+  return insertNode(msec, &t, id, 0, MissedTicks::kSkip, slack_msec);
+}
+
+TaskHandle TaskQueue::insertReplace(unsigned long msec, TaskThunk t, unsigned id,
+                                    unsigned long slack_msec) {
+  return insertNode(msec, &t, id, 0, MissedTicks::kSkip, slack_msec);
+}
+
+TaskHandle TaskQueue::insertPeriodic(unsigned long msec, unsigned long period_msec, TaskThunk t,
+                                     unsigned id, MissedTicks policy, unsigned long slack_msec) {
+  return insertNode(msec, &t, id, period_msec, policy, slack_msec);
+}
+
+unsigned long TaskQueue::coalesce(unsigned long msec, unsigned long slack_msec) const {
+  return coalesceExcept(msec, slack_msec, kInvalidIdx);
 }
 
-void TaskQueue::insertReplace(unsigned long msec, const Thunk& t, unsigned id) {
+unsigned long TaskQueue::coalesceExcept(unsigned long msec, unsigned long slack_msec,
+                                        NodeIdx self) const {
+  m_coalesce_steps = 0;
+  if (slack_msec == 0) {
+    return msec;
+  }
+  const unsigned long limit = msec + slack_msec;
+
+  // Look for a queued task which runs in the window. A periodic task is also counted at
+  // its later nominal times, since it will join a wakeup chosen there when it is rearmed.
+  // Children are never earlier than their parent, so only subtrees whose root is before
+  // the end of the window are searched. Each step pops one position and pushes at most
+  // two, so the stack cannot overflow within kMaxCoalesceSteps steps.
+  std::size_t stack[kMaxCoalesceSteps + 1];
+  std::size_t depth = 0;
+  if (m_size > 0) {
+    stack[depth++] = 0;
+  }
+  while (depth > 0 && m_coalesce_steps < kMaxCoalesceSteps) {
+    const std::size_t pos = stack[--depth];
+    m_coalesce_steps += 1;
+    const Node& node = m_pool[m_heap[pos]];
+    if (!isBefore(node.data.msec, limit)) {
+      continue;
+    }
+    unsigned long run = node.data.msec;
+    const unsigned long period = node.data.period_msec;
+    if (period > 0 && !isBefore(msec, run)) {
+      // The first nominal time of the periodic task at or after msec.
+      run = node.due_msec + ((msec - node.due_msec + period - 1) / period) * period;
+    }
+    if (m_heap[pos] != self && isBefore(msec, run) && isBefore(run, limit)) {
+      return run;
+    }
+    for (std::size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < m_size; child++) {
+      stack[depth++] = child;
+    }
+  }
+  return msec;
+}
+
+TaskHandle TaskQueue::insertNode(unsigned long msec, TaskThunk* t, unsigned id,
+                                 unsigned long period_msec, MissedTicks policy,
+                                 unsigned long slack_msec) {
   if (capacity() < 1) {
-    return;
+    return TaskHandle();
   }
 
   // 1. Remove existing task with same ID
   const bool removed = remove(id);
+  const unsigned long due = msec;
+  msec = coalesce(due, slack_msec);
 
   // If full and no existing same-ID task was removed, check if we should even add this.
   if (full() && !removed) {
-    if (isBefore(m_pool[m_tail].data.msec, msec)) {
+    const std::size_t last = lastPos();
+    if (isBefore(m_pool[m_heap[last]].data.msec, msec)) {
       // New task is scheduled after the last one and queue is full.
-      return;
+      return TaskHandle();
     }
-    // New task is scheduled before the current tail, so we'll need to drop the tail.
-    popLast();
+    // New task is scheduled before the current last one, so we'll need to drop it.
+    removeAt(last);
   }
 
   // 2. Allocate a new node
   NodeIdx newIdx = allocNode();
   if (newIdx == kInvalidIdx) {
-    return;
-  }
-  m_pool[newIdx].data.msec = msec;
-  m_pool[newIdx].data.thunk = t;
-  m_pool[newIdx].data.id = id;
-
-  // 3. Find insertion point (keep list sorted by time)
-  if (m_size == 0) {
-    m_head = m_tail = newIdx;
-    m_pool[newIdx].prev = m_pool[newIdx].next = kInvalidIdx;
-  } else if (isBefore(msec, m_pool[m_head].data.msec)) {
-    // Insert at front
-    linkBefore(newIdx, m_head);
-  } else if (!isBefore(msec, m_pool[m_tail].data.msec)) {
-    // Insert at back
-    linkAfter(newIdx, m_tail);
-  } else {
-    // Insert in the middle
-    NodeIdx curr = m_head;
-    while (curr != kInvalidIdx && isBefore(m_pool[curr].data.msec, msec)) {
-      curr = m_pool[curr].next;
-    }
-    if (curr != kInvalidIdx) {
-      linkBefore(newIdx, curr);
-    } else {
-      linkAfter(newIdx, m_tail);
-    }
+    return TaskHandle();
   }
+  Node& node = m_pool[newIdx];
+  node.data.msec = msec;
+  node.data.thunk = std::move(*t);
+  node.data.id = id;
+  node.data.period_msec = period_msec;
+  node.policy = policy;
+  node.due_msec = due;
+  node.slack_msec = slack_msec;
+  node.seq = m_seq++;
+
+  // 3. Add the node at the bottom of the heap and move it up to its place.
+  placeAt(m_size, newIdx);
   m_size++;
+  siftUp(m_size - 1);
+  indexId(newIdx);
+  return handleOf(newIdx);
 }
 
 bool TaskQueue::remove(unsigned id) {
   if (id == 0 || empty()) {
     return false;
   }
+  const NodeIdx idx = findId(id);
+  if (idx == kInvalidIdx) {
+    return false;
+  }
+  removeAt(m_pool[idx].heap_pos);
+  return true;
+}
 
-  NodeIdx curr = m_head;
-  while (curr != kInvalidIdx) {
-    if (m_pool[curr].data.id == id) {
-      unlink(curr);
-      freeNode(curr);
-      m_size--;
-      return true;
-    }
-    curr = m_pool[curr].next;
+bool TaskQueue::cancel(TaskHandle handle) {
+  const NodeIdx idx = nodeOf(handle);
+  if (idx == kInvalidIdx) {
+    return false;
+  }
+  removeAt(m_pool[idx].heap_pos);
+  return true;
+}
+
+bool TaskQueue::reschedule(TaskHandle handle, unsigned long msec) {
+  const NodeIdx idx = nodeOf(handle);
+  if (idx == kInvalidIdx) {
+    return false;
   }
-  return false;
+  Node& node = m_pool[idx];
+  node.due_msec = msec;
+  node.data.msec = coalesceExcept(msec, node.slack_msec, idx);
+  node.seq = m_seq++;
+  siftDown(node.heap_pos);
+  siftUp(node.heap_pos);
+  return true;
 }
 
 bool TaskQueue::runNext() {
   if (empty()) {
     return false;
   }
-  Thunk fn = m_pool[m_head].data.thunk;
-  popFirst();
-  if (fn) {
-    fn();
+  TimedThunk task;
+  Loan loan;
+  takeFirst(first().msec, &task, &loan);
+  if (task.thunk) {
+    task.thunk();
   }
+  giveBack(loan, &task.thunk);
   return true;
 }
 
+void TaskQueue::takeFirst(unsigned long now, TimedThunk* t, Loan* loan) {
+  *loan = Loan();
+  if (empty()) {
+    return;
+  }
+  const NodeIdx idx = m_heap[0];
+  Node& node = m_pool[idx];
+  const unsigned long due = node.due_msec;
+  const unsigned long period = node.data.period_msec;
+  t->msec = node.data.msec;
+  t->thunk = std::move(node.data.thunk);
+  t->id = node.data.id;
+  t->period_msec = period;
+  t->ticks = 1;
+  if (period == 0) {
+    removeAt(0);
+    return;
+  }
+
+  // Rearm the periodic task in place. The number of whole periods missed is computed
+  // directly rather than by stepping through them.
+  const unsigned long missed = isBefore(due, now) ? (now - due) / period : 0;
+  switch (node.policy) {
+    case MissedTicks::kBurst:
+      node.due_msec = due + period;
+      break;
+    case MissedTicks::kCount:
+      t->ticks = static_cast<unsigned>(missed + 1);
+      node.due_msec = due + (missed + 1) * period;
+      break;
+    case MissedTicks::kSkip:
+    default:
+      node.due_msec = due + (missed + 1) * period;
+      break;
+  }
+  node.data.msec = coalesceExcept(node.due_msec, node.slack_msec, idx);
+  node.seq = m_seq++;
+  siftDown(0);
+  *loan = handleOf(idx);
+}
+
+void TaskQueue::giveBack(const Loan& loan, TaskThunk* thunk) {
+  const NodeIdx idx = nodeOf(loan);
+  if (idx == kInvalidIdx) {
+    return;  // Not periodic, or the task was removed or replaced while its callback ran.
+  }
+  m_pool[idx].data.thunk = std::move(*thunk);
+}
+
 void TaskQueue::popFirst() {
   if (empty()) {
     return;
   }
-  NodeIdx oldHead = m_head;
-  unlink(oldHead);
-  freeNode(oldHead);
-  m_size--;
+  removeAt(0);
 }
 
 void TaskQueue::popLast() {
   if (empty()) {
     return;
   }
-  NodeIdx oldTail = m_tail;
-  unlink(oldTail);
-  freeNode(oldTail);
-  m_size--;
+  removeAt(lastPos());
 }
 
 TimedThunk& TaskQueue::thunk(std::size_t idx) {
   static TimedThunk emptyThunk;
-  if (idx >= m_size) {
-    return emptyThunk;
-  }
-  NodeIdx curr = m_head;
-  for (std::size_t i = 0; i < idx && curr != kInvalidIdx; ++i) {
-    curr = m_pool[curr].next;
+  for (std::size_t pos = 0; pos < m_size; ++pos) {
+    if (rank(m_heap[pos]) == idx) {
+      return m_pool[m_heap[pos]].data;
+    }
   }
-  if (curr == kInvalidIdx) return emptyThunk;
-  return m_pool[curr].data;
+  return emptyThunk;
 }
 
 const TimedThunk& TaskQueue::thunk(std::size_t idx) const {
   static TimedThunk emptyThunk;
-  if (idx >= m_size) {
-    return emptyThunk;
-  }
-  NodeIdx curr = m_head;
-  for (std::size_t i = 0; i < idx && curr != kInvalidIdx; ++i) {
-    curr = m_pool[curr].next;
+  for (std::size_t pos = 0; pos < m_size; ++pos) {
+    if (rank(m_heap[pos]) == idx) {
+      return m_pool[m_heap[pos]].data;
+    }
   }
-  if (curr == kInvalidIdx) return emptyThunk;
-  return m_pool[curr].data;
+  return emptyThunk;
 }
 
 void TaskQueue::show() const {
   printf("TaskQueue[%zu/%zu]: ", m_size, capacity());
-  NodeIdx curr = m_head;
-  while (curr != kInvalidIdx) {
-    printf("%lu(%u) ", m_pool[curr].data.msec, m_pool[curr].data.id);
-    curr = m_pool[curr].next;
+  for (std::size_t pos = 0; pos < m_size; ++pos) {
+    const TimedThunk& data = m_pool[m_heap[pos]].data;
+    printf("%lu(%u) ", data.msec, data.id);
   }
   printf("\n");
 }
 
 // -- Private Helpers --
 
+TaskQueue::NodeIdx TaskQueue::nodeOf(TaskHandle handle) const {
+  if (handle.index < 0 || static_cast<std::size_t>(handle.index) >= m_pool.size()) {
+    return kInvalidIdx;
+  }
+  const Node& node = m_pool[handle.index];
+  if (node.gen != handle.gen || node.heap_pos == kInvalidIdx) {
+    return kInvalidIdx;
+  }
+  return handle.index;
+}
+
+TaskHandle TaskQueue::handleOf(NodeIdx idx) const {
+  TaskHandle handle;
+  handle.index = idx;
+  handle.gen = m_pool[idx].gen;
+  return handle;
+}
+
 TaskQueue::NodeIdx TaskQueue::allocNode() {
   if (m_free_head == kInvalidIdx) {
     return kInvalidIdx;
   }
   NodeIdx idx = m_free_head;
-  m_free_head = m_pool[idx].next;
-  m_pool[idx].next = m_pool[idx].prev = kInvalidIdx;
+  m_free_head = m_pool[idx].next_free;
+  m_pool[idx].next_free = kInvalidIdx;
   return idx;
 }
 
 void TaskQueue::freeNode(NodeIdx idx) {
-  m_pool[idx].next = m_free_head;
-  m_pool[idx].prev = kInvalidIdx;
+  Node& node = m_pool[idx];
+  node.data.thunk = nullptr;
+  node.data.id = 0;
+  node.data.period_msec = 0;
+  node.slack_msec = 0;
+  node.heap_pos = kInvalidIdx;
+  node.gen++;
+  node.next_free = m_free_head;
   m_free_head = idx;
 }
 
-void TaskQueue::linkBefore(NodeIdx nodeIdx, NodeIdx beforeIdx) {
-  NodeIdx prevIdx = m_pool[beforeIdx].prev;
-  m_pool[nodeIdx].next = beforeIdx;
-  m_pool[nodeIdx].prev = prevIdx;
-  m_pool[beforeIdx].prev = nodeIdx;
-  if (prevIdx != kInvalidIdx) {
-    m_pool[prevIdx].next = nodeIdx;
-  } else {
-    m_head = nodeIdx;
+// Orders by time, then by insertion order so tasks scheduled for the same time run FIFO.
+bool TaskQueue::before(NodeIdx a, NodeIdx b) const {
+  const Node& na = m_pool[a];
+  const Node& nb = m_pool[b];
+  if (na.data.msec != nb.data.msec) {
+    return isBefore(na.data.msec, nb.data.msec);
+  }
+  return static_cast<int32_t>(na.seq - nb.seq) < 0;
+}
+
+void TaskQueue::placeAt(std::size_t pos, NodeIdx node) {
+  m_heap[pos] = node;
+  m_pool[node].heap_pos = static_cast<NodeIdx>(pos);
+}
+
+void TaskQueue::siftUp(std::size_t pos) {
+  const NodeIdx node = m_heap[pos];
+  while (pos > 0) {
+    const std::size_t parent = (pos - 1) / 2;
+    if (!before(node, m_heap[parent])) {
+      break;
+    }
+    placeAt(pos, m_heap[parent]);
+    pos = parent;
+  }
+  placeAt(pos, node);
+}
+
+void TaskQueue::siftDown(std::size_t pos) {
+  const NodeIdx node = m_heap[pos];
+  while (true) {
+    std::size_t child = 2 * pos + 1;
+    if (child >= m_size) {
+      break;
+    }
+    if (child + 1 < m_size && before(m_heap[child + 1], m_heap[child])) {
+      child += 1;
+    }
+    if (!before(m_heap[child], node)) {
+      break;
+    }
+    placeAt(pos, m_heap[child]);
+    pos = child;
+  }
+  placeAt(pos, node);
+}
+
+void TaskQueue::removeAt(std::size_t pos) {
+  const NodeIdx node = m_heap[pos];
+  m_size--;
+  if (pos != m_size) {
+    // Move the bottom element into the hole, then restore the heap property.
+    placeAt(pos, m_heap[m_size]);
+    siftDown(pos);
+    siftUp(pos);
   }
+  m_heap[m_size] = kInvalidIdx;
+  unindexId(node);
+  freeNode(node);
 }
 
-void TaskQueue::linkAfter(NodeIdx nodeIdx, NodeIdx afterIdx) {
-  NodeIdx nextIdx = m_pool[afterIdx].next;
-  m_pool[nodeIdx].prev = afterIdx;
-  m_pool[nodeIdx].next = nextIdx;
-  m_pool[afterIdx].next = nodeIdx;
-  if (nextIdx != kInvalidIdx) {
-    m_pool[nextIdx].prev = nodeIdx;
-  } else {
-    m_tail = nodeIdx;
+// The latest task is always one of the leaves of the heap.
+std::size_t TaskQueue::lastPos() const {
+  std::size_t last = m_size / 2;
+  for (std::size_t pos = last + 1; pos < m_size; ++pos) {
+    if (before(m_heap[last], m_heap[pos])) {
+      last = pos;
+    }
   }
+  return last;
 }
 
-void TaskQueue::unlink(NodeIdx idx) {
-  NodeIdx prevIdx = m_pool[idx].prev;
-  NodeIdx nextIdx = m_pool[idx].next;
+std::size_t TaskQueue::rank(NodeIdx node) const {
+  std::size_t count = 0;
+  for (std::size_t pos = 0; pos < m_size; ++pos) {
+    if (before(m_heap[pos], node)) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+std::size_t TaskQueue::idSlot(unsigned id) const {
+  // Fibonacci hashing spreads sequential IDs from getId() across the table.
+  return (static_cast<uint32_t>(id) * 2654435761u) & (m_id_table.size() - 1);
+}
+
+TaskQueue::NodeIdx TaskQueue::findId(unsigned id) const {
+  if (id == 0 || m_id_table.empty()) {
+    return kInvalidIdx;
+  }
+  const std::size_t mask = m_id_table.size() - 1;
+  for (std::size_t slot = idSlot(id);; slot = (slot + 1) & mask) {
+    const NodeIdx idx = m_id_table[slot];
+    if (idx == kInvalidIdx || m_pool[idx].data.id == id) {
+      return idx;
+    }
+  }
+}
 
-  if (prevIdx != kInvalidIdx) {
-    m_pool[prevIdx].next = nextIdx;
-  } else {
-    m_head = nextIdx;
+void TaskQueue::indexId(NodeIdx node) {
+  const unsigned id = m_pool[node].data.id;
+  if (id == 0) {
+    return;
+  }
+  const std::size_t mask = m_id_table.size() - 1;
+  std::size_t slot = idSlot(id);
+  while (m_id_table[slot] != kInvalidIdx) {
+    slot = (slot + 1) & mask;
   }
+  m_id_table[slot] = node;
+}
 
-  if (nextIdx != kInvalidIdx) {
-    m_pool[nextIdx].prev = prevIdx;
-  } else {
-    m_tail = prevIdx;
+void TaskQueue::unindexId(NodeIdx node) {
+  const unsigned id = m_pool[node].data.id;
+  if (id == 0) {
+    return;
+  }
+  const std::size_t mask = m_id_table.size() - 1;
+  std::size_t hole = idSlot(id);
+  while (m_id_table[hole] != node) {
+    if (m_id_table[hole] == kInvalidIdx) {
+      return;
+    }
+    hole = (hole + 1) & mask;
+  }
+  // Backward-shift deletion keeps probe sequences intact without tombstones.
+  for (std::size_t slot = (hole + 1) & mask; m_id_table[slot] != kInvalidIdx;
+       slot = (slot + 1) & mask) {
+    const std::size_t home = idSlot(m_pool[m_id_table[slot]].data.id);
+    const bool stays =
+        (hole <= slot) ? (hole < home && home <= slot) : (hole < home || home <= slot);
+    if (!stays) {
+      m_id_table[hole] = m_id_table[slot];
+      hole = slot;
+    }
   }
+  m_id_table[hole] = kInvalidIdx;
 }
 
 }  // namespace og3
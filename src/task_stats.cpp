@@ -0,0 +1,129 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/task_stats.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "og3/units.h"
+
+namespace og3 {
+
+namespace {
+
+uint32_t clamp32(unsigned long value) {
+  return value > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(value);
+}
+
+enum VarIndex : uint16_t {
+  kVarLateP50,
+  kVarLateP99,
+  kVarLateMax,
+  kVarRunP50,
+  kVarRunP99,
+  kVarRunMax,
+  kVarSlowestId,
+  kVarSlowestMax,
+  kVarCount,
+};
+
+const VariableDescriptor s_vars[] PROGMEM = {
+    {"lateP50", units::kMilliseconds, "task lateness p50", 0, 0},
+    {"lateP99", units::kMilliseconds, "task lateness p99", 0, 0},
+    {"lateMax", units::kMilliseconds, "task lateness max", 0, 0},
+    {"runP50", units::kMicroseconds, "task run time p50", 0, 0},
+    {"runP99", units::kMicroseconds, "task run time p99", 0, 0},
+    {"runMax", units::kMicroseconds, "task run time max", 0, 0},
+    {"slowestTaskId", "", "slowest task id", 0, 0},
+    {"slowestTaskMax", units::kMicroseconds, "slowest task max run time", 0, 0},
+};
+static_assert(std::size(s_vars) == kVarCount, "s_vars must describe each VarIndex");
+
+}  // namespace
+
+TaskStats::TaskStats(const char* name, std::size_t max_task_ids)
+    : m_entries(max_task_ids),
+      m_vg(name, s_vars),
+      m_late_p50(kVarLateP50, 0, m_vg),
+      m_late_p99(kVarLateP99, 0, m_vg),
+      m_late_max(kVarLateMax, 0, m_vg),
+      m_run_p50(kVarRunP50, 0, m_vg),
+      m_run_p99(kVarRunP99, 0, m_vg),
+      m_run_max(kVarRunMax, 0, m_vg),
+      m_slowest_id(kVarSlowestId, 0, m_vg),
+      m_slowest_usec(kVarSlowestMax, 0, m_vg) {
+  // A power of two with at most 50% load.
+  std::size_t size = 1;
+  while (size < 2 * max_task_ids) {
+    size <<= 1;
+  }
+  m_index.assign(size, 0);
+}
+
+std::size_t TaskStats::slotOf(unsigned id) const {
+  // Fibonacci hashing spreads sequential IDs from getId() across the table.
+  const std::size_t mask = m_index.size() - 1;
+  std::size_t slot = (static_cast<uint32_t>(id) * 2654435769u) & mask;
+  while (m_index[slot] != 0 && m_entries[m_index[slot] - 1].id != id) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void TaskStats::record(unsigned id, unsigned long lateness_msec, unsigned long run_usec) {
+  const uint32_t late = clamp32(lateness_msec);
+  const uint32_t run = clamp32(run_usec);
+  m_lateness.add(late);
+  m_runtime.add(run);
+
+  const std::size_t slot = slotOf(id);
+  if (m_index[slot] == 0) {
+    if (m_num_entries == m_entries.size()) {
+      return;  // Only counted in the overall histograms.
+    }
+    m_entries[m_num_entries].id = id;
+    m_index[slot] = static_cast<uint16_t>(++m_num_entries);
+  }
+  Entry* entry = &m_entries[m_index[slot] - 1];
+  entry->lateness_msec.add(late);
+  entry->run_usec.add(run);
+}
+
+const TaskStats::Entry* TaskStats::find(unsigned id) const {
+  const uint16_t index = m_index[slotOf(id)];
+  return index ? &m_entries[index - 1] : nullptr;
+}
+
+void TaskStats::update() {
+  m_late_p50 = m_lateness.percentile(50);
+  m_late_p99 = m_lateness.percentile(99);
+  m_late_max = m_lateness.max();
+  m_run_p50 = m_runtime.percentile(50);
+  m_run_p99 = m_runtime.percentile(99);
+  m_run_max = m_runtime.max();
+
+  const Entry* slowest = nullptr;
+  for (std::size_t i = 0; i < m_num_entries; i++) {
+    if (!slowest || m_entries[i].run_usec.max() > slowest->run_usec.max()) {
+      slowest = &m_entries[i];
+    }
+  }
+  m_slowest_id = slowest ? slowest->id : 0;
+  m_slowest_usec = slowest ? slowest->run_usec.max() : 0;
+}
+
+void TaskStats::reset() {
+  for (std::size_t i = 0; i < m_num_entries; i++) {
+    m_entries[i].id = 0;
+    m_entries[i].lateness_msec.reset();
+    m_entries[i].run_usec.reset();
+  }
+  m_num_entries = 0;
+  std::fill(m_index.begin(), m_index.end(), 0);
+  m_lateness.reset();
+  m_runtime.reset();
+  update();
+}
+
+}  // namespace og3
@@ -4,10 +4,17 @@
 #include "og3/tasks.h"
 
 #include <Arduino.h>
-#ifndef NATIVE
-#else
+
+#include <algorithm>
+#if defined(NATIVE)
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+#include <coredecls.h>
 #endif
 
+#include "og3/compiler_definitions.h"
 #include "og3/logger.h"
 #include "og3/module.h"
 #include "og3/task_queue.h"
@@ -16,54 +23,229 @@ namespace og3 {
 
 const char* Tasks::kName = "tasks";
 
-Thunk Tasks::s_run_next = nullptr;
+IsrEventQueue Tasks::s_isr_events(Tasks::kIsrEventCapacity);
+
+namespace {
+
+// State used to end a wait in Tasks::idle() early.
+#if defined(NATIVE)
+std::mutex s_idle_mutex;
+std::condition_variable s_idle_cv;
+bool s_wake_pending = false;
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+TaskHandle_t s_loop_task = nullptr;
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+volatile bool s_wake_pending = false;
+#endif
+
+}  // namespace
 
 Tasks::Tasks(std::size_t capacity, ModuleSystem* module_system)
-    : Module(kName, module_system), m_queue(capacity) {
-  add_update_fn([this]() { loop(); });
+    : Module(kName, module_system),
+#ifdef OG3_TASK_STATS
+      // One entry for each task the queue holds, and one for tasks without an ID.
+      m_stats("task_stats", capacity + 1),
+#endif
+      m_queue(capacity) {
+  add_update_fn([](void* tasks) { static_cast<Tasks*>(tasks)->loop(); }, this);
+}
+
+// static
+bool OG3_IRAM_ATTR Tasks::run_next(IsrEventFn fn, void* ctx) {
+  const bool ok = s_isr_events.post(fn, ctx, millis());
+  wake();
+  return ok;
 }
 
-void Tasks::runAt(unsigned long msec, const Thunk& thunk, unsigned id) {
-  bool ok = false;
+// static
+void OG3_IRAM_ATTR Tasks::wake() {
+#if defined(NATIVE)
+  {
+    std::lock_guard<std::mutex> lock(s_idle_mutex);
+    s_wake_pending = true;
+  }
+  s_idle_cv.notify_one();
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  TaskHandle_t task = s_loop_task;
+  if (!task) {
+    return;  // idle() has not been used.
+  }
+  if (xPortInIsrContext()) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+    if (higher_priority_task_woken) {
+      portYIELD_FROM_ISR();
+    }
+  } else {
+    xTaskNotifyGive(task);
+  }
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  s_wake_pending = true;
+  esp_schedule();
+#endif
+}
+
+TaskHandle Tasks::runAt(unsigned long msec, TaskThunk thunk, unsigned id,
+                        unsigned long slack_msec) {
 #ifndef NATIVE
   noInterrupts();
 #endif
-  ok = m_queue.insert(msec, thunk, id);
+  const bool was_empty = m_queue.empty();
+  const unsigned long prev_next = m_queue.nextMsec();
+  const TaskHandle handle = m_queue.insert(msec, std::move(thunk), id, slack_msec);
+  // Slack may move the task, so check whether the next deadline changed.
+  const bool is_first = handle && (was_empty || m_queue.first().msec != prev_next);
 #ifndef NATIVE
   interrupts();
 #endif
-  if (!ok) {
+  if (!handle) {
     log()->logf("Failed to schedule task callback (full!) id=%u", id);
+  } else if (is_first) {
+    // The loop may be sleeping until a later deadline.
+    wake();
+  }
+  return handle;
+}
+
+TaskHandle Tasks::runIn(unsigned long msec, TaskThunk thunk, unsigned id,
+                        unsigned long slack_msec) {
+  return runAt(millis() + msec, std::move(thunk), id, slack_msec);
+}
+
+TaskHandle Tasks::runPeriodicAt(unsigned long msec, unsigned long period_msec, TaskThunk thunk,
+                                unsigned id, MissedTicks policy, unsigned long slack_msec) {
+#ifndef NATIVE
+  noInterrupts();
+#endif
+  const bool was_empty = m_queue.empty();
+  const unsigned long prev_next = m_queue.nextMsec();
+  const TaskHandle handle =
+      m_queue.insertPeriodic(msec, period_msec, std::move(thunk), id, policy, slack_msec);
+  const bool is_first = handle && (was_empty || m_queue.first().msec != prev_next);
+#ifndef NATIVE
+  interrupts();
+#endif
+  if (!handle) {
+    log()->logf("Failed to schedule periodic task callback (full!) id=%u", id);
+  } else if (is_first) {
+    wake();
   }
+  return handle;
 }
 
-void Tasks::runIn(unsigned long msec, const Thunk& thunk, unsigned id) {
-  runAt(millis() + msec, thunk, id);
+bool Tasks::cancel(TaskHandle handle) {
+#ifndef NATIVE
+  noInterrupts();
+#endif
+  const bool ok = m_queue.cancel(handle);
+#ifndef NATIVE
+  interrupts();
+#endif
+  return ok;
+}
+
+bool Tasks::reschedule(TaskHandle handle, unsigned long msec) {
+#ifndef NATIVE
+  noInterrupts();
+#endif
+  const unsigned long prev_next = m_queue.nextMsec();
+  const bool ok = m_queue.reschedule(handle, msec);
+  const bool is_first = ok && m_queue.first().msec != prev_next;
+#ifndef NATIVE
+  interrupts();
+#endif
+  if (is_first) {
+    wake();
+  }
+  return ok;
+}
+
+bool Tasks::pending(TaskHandle handle) const {
+#ifndef NATIVE
+  noInterrupts();
+#endif
+  const bool ok = m_queue.pending(handle);
+#ifndef NATIVE
+  interrupts();
+#endif
+  return ok;
 }
 
 int Tasks::loop() {
-  const auto now = millis();
-  Thunk thunk;
   int count = 0;
-  while (getThunk(now, &thunk)) {
-    thunk();
+  const bool timed = m_loop_stats.enabled();
+  const unsigned long loop_start_usec = timed ? micros() : 0;
+  // Run events posted by interrupt handlers, limited to one queue's worth per loop.
+  IsrEvent event;
+  for (std::size_t i = 0; i < s_isr_events.capacity() && s_isr_events.pop(&event); i++) {
+    event.fn(event.ctx);
+    count += 1;
+  }
+
+  const auto now = millis();
+  // micros() is only read when there is a time budget.
+  const unsigned long start_usec = m_budget_usec ? micros() : 0;
+  unsigned num_tasks = 0;
+  TimedThunk task;
+  TaskQueue::Loan loan;
+  DispatchTrace& trace = module_system()->dispatch_trace();
+  while (getThunk(now, &task, &loan)) {
+    m_current_ticks = task.ticks;
+    const auto prev = trace.begin(DispatchTrace::Kind::kTask, task.id);
+#ifdef OG3_TASK_STATS
+    const unsigned long start_msec = millis();
+    const unsigned long task_start_usec = micros();
+    task.thunk();
+    m_stats.record(task.id, start_msec - task.msec, micros() - task_start_usec);
+#else
+    task.thunk();
+#endif
+    trace.end(prev);
+    if (loan) {
+      giveBack(loan, &task.thunk);
+    }
     count += 1;
+    num_tasks += 1;
+    const bool out_of_budget = (m_budget_tasks && num_tasks >= m_budget_tasks) ||
+                               (m_budget_usec && micros() - start_usec >= m_budget_usec);
+    if (out_of_budget) {
+      // Any remaining due tasks stay in the queue, in order, for the next loop.
+      if (isDue(now)) {
+        m_deferrals += 1;
+      }
+      break;
+    }
+  }
+  m_current_ticks = 1;
+  if (timed) {
+    m_loop_stats.addTasksUsec(micros() - loop_start_usec);
   }
   return count;
 }
 
-bool Tasks::getThunk(unsigned long now, Thunk* t) {
+void Tasks::setLoopBudget(unsigned long max_usec, unsigned max_tasks) {
+  m_budget_usec = max_usec;
+  m_budget_tasks = max_tasks;
+}
+
+bool Tasks::isDue(unsigned long now) const {
+#ifndef NATIVE
+  noInterrupts();
+#endif
+  const bool due = !m_queue.empty() && isBefore(m_queue.nextMsec(), now);
+#ifndef NATIVE
+  interrupts();
+#endif
+  return due;
+}
+
+bool Tasks::getThunk(unsigned long now, TimedThunk* t, TaskQueue::Loan* loan) {
   bool ret = false;
 #ifndef NATIVE
   noInterrupts();
 #endif
-  if (s_run_next) {
-    *t = s_run_next;
-    s_run_next = nullptr;
-    ret = true;
-  } else if (!m_queue.empty() && isBefore(m_queue.nextMsec(), now)) {
-    *t = m_queue.first().thunk;
-    m_queue.popFirst();
+  if (!m_queue.empty() && isBefore(m_queue.nextMsec(), now)) {
+    m_queue.takeFirst(now, t, loan);
     ret = true;
   }
 #ifndef NATIVE
@@ -72,9 +254,67 @@ bool Tasks::getThunk(unsigned long now, Thunk* t) {
   return ret;
 }
 
+void Tasks::giveBack(const TaskQueue::Loan& loan, TaskThunk* thunk) {
+#ifndef NATIVE
+  noInterrupts();
+#endif
+  m_queue.giveBack(loan, thunk);
+#ifndef NATIVE
+  interrupts();
+#endif
+}
+
+unsigned long Tasks::msecUntilNext(unsigned long now, unsigned long max_msec) const {
+  if (!s_isr_events.empty()) {
+    return 0;
+  }
+  unsigned long msec = max_msec;
+#ifndef NATIVE
+  noInterrupts();
+#endif
+  if (!m_queue.empty()) {
+    const unsigned long next_msec = m_queue.nextMsec();
+    msec = isBefore(next_msec, now) ? 0 : std::min(next_msec - now, max_msec);
+  }
+#ifndef NATIVE
+  interrupts();
+#endif
+  return msec;
+}
+
+void Tasks::idle(unsigned long max_msec) {
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  s_loop_task = xTaskGetCurrentTaskHandle();
+#endif
+  const unsigned long msec = msecUntilNext(millis(), max_msec);
+  if (msec == 0) {
+    return;
+  }
+#if defined(NATIVE)
+  std::unique_lock<std::mutex> lock(s_idle_mutex);
+  s_idle_cv.wait_for(lock, std::chrono::milliseconds(msec), []() { return s_wake_pending; });
+  s_wake_pending = false;
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+  // Block on the task notification so the idle task (and light sleep, if enabled) can run.
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(msec));
+#elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP8266)
+  // Yield to the system until the deadline or until wake() is called.
+  esp_delay(msec, []() { return !s_wake_pending; });
+  s_wake_pending = false;
+#else
+  delay(msec);
+#endif
+}
+
 PeriodicTaskScheduler::PeriodicTaskScheduler(unsigned msec_initial, unsigned period_msec,
-                                             const Thunk& thunk, Tasks* tasks)
-    : m_scheduler(tasks), m_thunk(thunk), m_initial_msec(msec_initial), m_period_msec(period_msec) {
+                                             TaskThunk thunk, Tasks* tasks, MissedTicks policy,
+                                             unsigned slack_msec)
+    : m_scheduler(tasks),
+      m_thunk(std::move(thunk)),
+      m_initial_msec(msec_initial),
+      m_period_msec(period_msec),
+      m_policy(policy),
+      m_slack_msec(slack_msec) {
   if (tasks) {
     start(millis() + msec_initial);
   }
@@ -100,24 +340,14 @@ void PeriodicTaskScheduler::runIn(unsigned long msec) {
   }
 }
 
-void PeriodicTaskScheduler::start(unsigned long msec) {
-  m_prev_msec = millis();
-  m_scheduler.runAt(msec, [this]() { cycle(); });
+unsigned PeriodicTaskScheduler::ticks() const {
+  return m_scheduler.tasks() ? m_scheduler.tasks()->currentTicks() : 1;
 }
-void PeriodicTaskScheduler::cycle() {
-  // Run the callback.
-  m_thunk();
-  if (m_period_msec == 0) {
-    return;
-  }
-  // Schedule the next callback for the next multiple of period that is after the current time.
-  const unsigned long now_msec = millis();
-  unsigned long next_msec = m_prev_msec + m_period_msec;
-  while (isBefore(next_msec, now_msec)) {  // wrap-around-friendly comparison
-    next_msec += m_period_msec;
-  }
-  m_scheduler.runAt(next_msec, [this]() { cycle(); });
-  m_prev_msec = next_msec;
+
+void PeriodicTaskScheduler::start(unsigned long msec) {
+  // The task stays in the queue, and is rearmed in place after each run.
+  m_scheduler.runPeriodicAt(msec, m_period_msec, [this]() { m_thunk(); }, m_policy,
+                            m_slack_msec);
 }
 
 }  // namespace og3
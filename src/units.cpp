@@ -34,6 +34,7 @@ const char kMetersPerSecond[] = "m/s";
 const char kKilometersPerHour[] = "km/h";
 const char kMilesPerHour[] = "mph";
 const char kDecibel[] = "dB";
+const char kBytes[] = "B";
 const char kKilobytes[] = "kB";
 const char kMegabytes[] = "MB";
 
@@ -3,11 +3,14 @@
 
 #include "og3/variable.h"
 
+#include <cassert>
 #include <memory>
 
 #include "ArduinoJson/Object/JsonObject.hpp"
 #include "ArduinoJson/Object/JsonObjectConst.hpp"
 #include "og3/html_table.h"
+#include "og3/text_buffer.h"
+#include "og3/util.h"
 
 namespace og3 {
 
@@ -19,14 +22,35 @@ String VariableBase::formEntry() const {
   ret +=
       "' autocomplete='off' autocorrect='off' autocapitalize='off' spellcheck='false'\n"
       "  placeholder=' ' value='";
-  html::escape(&ret, string().c_str());
+  html::writeValueInto(&ret, *this);
   ret += "'>\n";
   return ret;
 }
 
+std::size_t VariableBase::formatTo(char* buf, std::size_t len) const {
+  return formatText(buf, len, string().c_str());
+}
+
+bool VariableBase::parse(const char* text, std::size_t len) {
+  String value;
+  value.reserve(len);
+  for (std::size_t i = 0; i < len; i++) {
+    value += text[i];
+  }
+  return fromString(value);
+}
+
+void VariableBase::writeJsonValue(JsonWriter* out) const { out->string(string().c_str()); }
+
 VariableGroup::VariableGroup(const char* name, const char* id, size_t initial_size)
     : m_name(name), m_id(id ? id : name) {
   m_variables.reserve(initial_size);
+  m_descriptors.reserve(initial_size);
+}
+
+uint16_t VariableGroup::addDescriptor(const VariableDescriptor& descriptor) {
+  m_descriptors.push_back(descriptor);
+  return static_cast<uint16_t>(m_descriptors.size() - 1) | kRamDescriptor;
 }
 
 void VariableGroup::add(VariableBase* variable) {
@@ -34,25 +58,73 @@ void VariableGroup::add(VariableBase* variable) {
   if (variable->config()) {
     m_num_config += 1;
   }
+  if (variable->settable()) {
+    m_num_settable += 1;
+  }
+  m_name_table.clear();
+  if (m_changed.size() * kBitsPerWord < m_variables.size()) {
+    m_changed.push_back(0);
+  }
+  setChanged(m_variables.size() - 1);
 }
 
-void VariableGroup::toJson(JsonObject out_json, unsigned flags) const {
-  for (auto* var : variables()) {
-    if (flags & var->flags() & VariableBase::kNoPublish) {
-      continue;
+bool VariableGroup::changed() const {
+  for (uint32_t word : m_changed) {
+    if (word) {
+      return true;
     }
-    if (var->config() && !(flags & VariableBase::kConfig)) {
+  }
+  return false;
+}
+
+bool VariableGroup::changedToPublish(unsigned flags) const {
+  for (std::size_t i = 0; i < m_variables.size(); i++) {
+    if (changed(i) && includes(m_variables[i], flags) && !m_variables[i]->failed()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void VariableGroup::clearChanged() const {
+  for (uint32_t& word : m_changed) {
+    word = 0;
+  }
+}
+
+void VariableGroup::clearChanged(unsigned flags) const {
+  for (std::size_t i = 0; i < m_variables.size(); i++) {
+    if (includes(m_variables[i], flags)) {
+      m_changed[i / kBitsPerWord] &= ~(1u << (i % kBitsPerWord));
+    }
+  }
+}
+
+// static
+bool VariableGroup::includes(const VariableBase* var, unsigned flags) {
+  if (flags & var->flags() & VariableBase::kNoPublish) {
+    return false;
+  }
+  return !var->config() || (flags & VariableBase::kConfig);
+}
+
+void VariableGroup::toJson(JsonObject out_json, unsigned flags, bool changed_only) const {
+  for (std::size_t i = 0; i < m_variables.size(); i++) {
+    VariableBase* var = m_variables[i];
+    if (changed_only && !changed(i)) {
       continue;
     }
-    var->toJson(out_json);
+    if (includes(var, flags)) {
+      var->toJson(out_json);
+    }
   }
 }
 
-void VariableGroup::toJson(String* out_str, unsigned flags) const {
+void VariableGroup::toJson(String* out_str, unsigned flags, bool changed_only) const {
 #ifndef NATIVE
   JsonDocument jsondoc;
   JsonObject json = jsondoc.to<JsonObject>();
-  toJson(json, flags);
+  toJson(json, flags, changed_only);
   serializeJson(jsondoc, *out_str);
 #endif
 }
@@ -64,17 +136,89 @@ void VariableGroup::toJson(std::ostream* out_str, unsigned flags) const {
   serializeJson(jsondoc, *out_str);
 }
 
-unsigned VariableGroup::updateFromJson(JsonObjectConst obj) {
-  unsigned num_updated = 0;
-  for (auto* var : variables()) {
-    if (!var->settable()) {
+void VariableGroup::buildJsonKeys() const {
+  m_json_keys.clear();
+  m_json_key_ends.clear();
+  m_json_key_ends.reserve(m_variables.size());
+  for (const VariableBase* var : m_variables) {
+    // Measure the escaped key, then write it in place.
+    JsonWriter measure(nullptr, 0);
+    measure.string(var->name());
+    measure.raw(':');
+    const std::size_t start = m_json_keys.size();
+    m_json_keys.resize(start + measure.length() + 1);
+    JsonWriter key(m_json_keys.data() + start, measure.length() + 1);
+    key.string(var->name());
+    key.raw(':');
+    m_json_keys.pop_back();  // The NUL written after the key.
+    m_json_key_ends.push_back(static_cast<uint16_t>(m_json_keys.size()));
+  }
+}
+
+void VariableGroup::writeJson(JsonWriter* out, unsigned flags, bool changed_only) const {
+  if (m_json_key_ends.size() != m_variables.size()) {
+    buildJsonKeys();
+  }
+  out->raw('{');
+  bool first = true;
+  for (std::size_t i = 0; i < m_variables.size(); i++) {
+    const VariableBase* var = m_variables[i];
+    if (changed_only && !changed(i)) {
       continue;
     }
-    JsonVariantConst val = obj[var->name()];
-    if (val.isNull()) {
+    if (!includes(var, flags) || var->failed()) {
       continue;
     }
-    if (var->fromJson(val)) {
+    if (!first) {
+      out->raw(',');
+    }
+    first = false;
+    const std::size_t start = i > 0 ? m_json_key_ends[i - 1] : 0;
+    out->raw(m_json_keys.data() + start, m_json_key_ends[i] - start);
+    var->writeJsonValue(out);
+  }
+  out->raw('}');
+}
+
+std::size_t VariableGroup::writeJson(char* buffer, std::size_t size, unsigned flags,
+                                     bool changed_only) const {
+  JsonWriter out(buffer, size);
+  writeJson(&out, flags, changed_only);
+  return out.length();
+}
+
+bool VariableGroup::writeJson(TextBufferBase* out, unsigned flags, bool changed_only) const {
+  JsonWriter writer(out);
+  writeJson(&writer, flags, changed_only);
+  out->extend(writer.length());
+  return !writer.truncated();
+}
+
+void VariableGroup::buildNameTable() const {
+  // The first variable added with a name is the one found.
+  og3::buildNameTable(
+      &m_name_table, m_variables.size(), [this](std::size_t i) { return m_variables[i]->name(); },
+      [](std::size_t) {});
+}
+
+VariableBase* VariableGroup::find(const char* name) const {
+  if (m_name_table.empty()) {
+    buildNameTable();
+  }
+  const uint16_t entry = findInNameTable(m_name_table, name, [this](std::size_t i) {
+    return m_variables[i]->name();
+  });
+  return entry ? m_variables[entry - 1] : nullptr;
+}
+
+unsigned VariableGroup::updateFromJson(JsonObjectConst obj) {
+  unsigned num_updated = 0;
+  for (JsonPairConst kv : obj) {
+    VariableBase* var = find(kv.key().c_str());
+    if (!var || !var->settable() || kv.value().isNull()) {
+      continue;
+    }
+    if (var->fromJson(kv.value())) {
       num_updated += 1;
     }
   }
@@ -83,7 +227,17 @@ unsigned VariableGroup::updateFromJson(JsonObjectConst obj) {
 
 VariableBase::VariableBase(const char* name_, const char* units_, const char* description_,
                            unsigned flags_, VariableGroup& group)
-    : m_name(name_), m_units(units_), m_description(description_), m_flags(flags_), m_group(group) {
+    : VariableBase({name_, units_, description_, static_cast<uint16_t>(flags_), 0}, group) {}
+
+VariableBase::VariableBase(const VariableDescriptor& descriptor, VariableGroup& group)
+    : VariableBase(group.addDescriptor(descriptor), group) {}
+
+VariableBase::VariableBase(uint16_t descriptor, VariableGroup& group)
+    : m_group(group),
+      m_index(static_cast<uint16_t>(group.variables().size())),
+      m_descriptor(descriptor) {
+  // An index past the end of the table would read other memory as this variable's name.
+  assert(group.hasDescriptor(descriptor));
   group.add(this);
 }
 
@@ -95,26 +249,43 @@ EnumStrVariableBase::EnumStrVariableBase(const char* name_, int value, const cha
       m_value_names(value_names),
       m_value(value) {}
 
+EnumStrVariableBase::EnumStrVariableBase(uint16_t descriptor, int value, unsigned num_values,
+                                         const char* value_names[], VariableGroup& group)
+    : EnumVariableBase(descriptor, group),
+      m_num_values(num_values),
+      m_value_names(value_names),
+      m_value(value) {}
+
 String EnumStrVariableBase::string() const {
   if (m_value < 0 || m_value >= static_cast<int>(m_num_values)) {
     return "??";
   }
   return String(m_value_names[m_value]);
 }
-bool EnumStrVariableBase::fromString(const String& value) {
+std::size_t EnumStrVariableBase::formatTo(char* buf, std::size_t len) const {
+  if (m_value < 0 || m_value >= static_cast<int>(m_num_values)) {
+    return formatText(buf, len, "??");
+  }
+  return formatText(buf, len, m_value_names[m_value]);
+}
+bool EnumStrVariableBase::parse(const char* text, std::size_t len) {
   for (unsigned i = 0; i < m_num_values; i += 1) {
-    if (0 == strcmp(m_value_names[i], value.c_str())) {
-      m_value = i;
+    if (0 == strncmp(m_value_names[i], text, len) && m_value_names[i][len] == 0) {
+      setValue(i);
       setFailed(false);
       return true;
     }
   }
-  setFailed(1 != sscanf(value.c_str(), "%d", &m_value));
+  long long ival = 0;
+  setFailed(!parseInt(text, len, &ival) || ival < INT_MIN || ival > INT_MAX);
+  if (!failed()) {
+    setValue(static_cast<int>(ival));
+  }
   return !failed();
 }
 bool EnumStrVariableBase::fromJson(JsonVariantConst json) {
   if (json.is<int>()) {
-    m_value = json.as<int>();
+    setValue(json.as<int>());
     return true;
   }
   if (!json.is<const char*>()) {
@@ -122,7 +293,7 @@ bool EnumStrVariableBase::fromJson(JsonVariantConst json) {
   }
   for (unsigned i = 0; i < m_num_values; i += 1) {
     if (0 == strcmp(m_value_names[i], json.as<const char*>())) {
-      m_value = i;
+      setValue(i);
       return true;
     }
   }
@@ -133,6 +304,10 @@ void EnumStrVariableBase::toJson(JsonObject json) {
     json[name()] = string();
   }
 }
+void EnumStrVariableBase::writeJsonValue(JsonWriter* out) const {
+  out->string(m_value < 0 || m_value >= static_cast<int>(m_num_values) ? "??"
+                                                                         : m_value_names[m_value]);
+}
 
 String EnumStrVariableBase::formEntry() const {
   String ret = "<select name=\"";
@@ -165,8 +340,7 @@ void BoolVariable::toJson(JsonObject json) {
 }
 
 BoolVariable& BoolVariable::operator=(bool value) {
-  m_value = value;
-  setFailed(false);
+  Variable<bool>::operator=(value);
   return *this;
 }
 
@@ -182,19 +356,13 @@ void BinarySensorVariable::toJson(JsonObject json) {
 
 bool BinarySensorVariable::fromJson(JsonVariantConst json) {
   if (json.is<const char*>()) {
-    m_value = fromString(json.as<const char*>());
-    return true;
-  }
-  if (json.is<const char*>()) {
-    m_value = json.as<const char*>();
-    return true;
+    return fromString(json.as<const char*>());
   }
   return false;
 }
 
 BinarySensorVariable& BinarySensorVariable::operator=(bool value) {
-  m_value = value;
-  setFailed(false);
+  Variable<bool>::operator=(value);
   return *this;
 }
 
@@ -211,8 +379,7 @@ String BoolVariable::formEntry() const {
 }
 
 BinaryCoverSensorVariable& BinaryCoverSensorVariable::operator=(bool value) {
-  m_value = value;
-  setFailed(false);
+  BinarySensorVariable::operator=(value);
   return *this;
 }
 
@@ -11,6 +11,11 @@
 
 namespace og3 {
 
+#ifdef OG3_MODULE_PROFILE
+const char WebApp::kModuleProfileUrl[] = "/profile";
+const char WebApp::kModuleProfileJsonUrl[] = "/profile.json";
+#endif
+
 #ifdef NATIVE
 WebApp::WebApp(const WifiApp::Options& options) : WifiApp(options) {}
 #else
@@ -23,6 +28,12 @@ WebApp::WebApp(const WifiApp::Options& options) : WifiApp(options), m_web_server
       .native_server()
       .serveStatic("/static/", LittleFS, "/static/")
       .setCacheControl("max-age=600");
+#endif
+#ifdef OG3_MODULE_PROFILE
+  web_server_module().on(kModuleProfileJsonUrl,
+                         [this](NetRequest* request, NetResponse* response) {
+                           return handleModuleProfileJsonRequest(request, response);
+                         });
 #endif
   // For captive portal mode, map unknown URI paths to the root page.
   wifi_manager().addSoftAPCallback([this]() {
@@ -57,6 +68,41 @@ NetHandlerStatus WebApp::handleWifiConfigRequest(NetRequest* request, NetRespons
   NET_REPLY(request, ESP_OK);
 }
 
+#ifdef OG3_MODULE_PROFILE
+NetHandlerStatus WebApp::handleModuleProfileRequest(NetRequest* request, NetResponse* response) {
+#ifndef NATIVE
+  m_web_page.clear();
+  module_system().profile().writeHtmlInto(&m_web_page);
+  m_web_page += HTML_BUTTON("/", "Back");
+  sendWrappedHTML(request, response, board_cname(), software_name(), m_web_page.c_str());
+#endif
+  NET_REPLY(request, ESP_OK);
+}
+
+NetHandlerStatus WebApp::handleModuleProfileJsonRequest(NetRequest* request,
+                                                        NetResponse* response) {
+#ifndef NATIVE
+  m_web_page.clear();
+  module_system().profile().writeJsonInto(&m_web_page);
+#if defined(ESP32)
+  request->response()->send(200, "application/json", m_web_page.c_str());
+#else
+  request->send(200, "application/json", m_web_page);
+#endif
+#endif
+  NET_REPLY(request, ESP_OK);
+}
+
+#ifndef NATIVE
+WebButton WebApp::createModuleProfileButton() {
+  return WebButton(&web_server_module().native_server(), "Module Profile", kModuleProfileUrl,
+                   [this](NetRequest* request, NetResponse* response) {
+                     return handleModuleProfileRequest(request, response);
+                   });
+}
+#endif
+#endif
+
 #ifndef NATIVE
 WebButton WebApp::createWifiConfigButton() {
   return WebButton(&web_server_module().native_server(), "WiFi Config", WifiManager::kConfigUrl,
@@ -3,6 +3,8 @@
 
 #include "og3/web_server.h"
 
+#include <vector>
+
 #include "og3/config_interface.h"
 #include "og3/wifi_manager.h"
 
@@ -34,12 +36,39 @@ bool read(NetRequest& request, VariableBase& var) {
 bool read(NetRequest& request, const VariableGroup& var_group) {
 #ifndef NATIVE
   bool ret = true;
+#if defined(ESP32)
   for (auto* var : var_group.variables()) {
     if (var->settable()) {
       ret = read(request, *var) && ret;
     }
   }
   return ret;
+#else
+  // Look up each posted field in the group, rather than each variable in the request.
+  // A field may be posted more than once, so count each variable only once.
+  std::vector<bool> is_read(var_group.variables().size());
+  unsigned num_read = 0;
+  for (size_t i = 0; i < request.params(); i++) {
+    auto* param = request.getParam(i);
+    if (!param->isPost()) {
+      continue;
+    }
+    VariableBase* var = var_group.find(param->name().c_str());
+    if (!var || !var->settable()) {
+      continue;
+    }
+    if (var->fromString(param->value())) {
+      if (!is_read[var->index()]) {
+        is_read[var->index()] = true;
+        num_read += 1;
+      }
+    } else {
+      ret = false;
+    }
+  }
+  // As for ESP32, only true if every settable variable was set.
+  return ret && num_read >= var_group.num_settable();
+#endif
 #else
   return true;
 #endif
@@ -4,6 +4,7 @@
 #include "og3/wifi_manager.h"
 
 #include <functional>
+#include <iterator>
 
 #ifndef NATIVE
 #include <DNSServer.h>
@@ -22,6 +23,8 @@ namespace og3 {
 namespace {
 #ifndef NATIVE
 constexpr uint8_t DNS_PORT = 53;
+// How often the captive-portal DNS server is polled, in AP mode.
+constexpr unsigned kDnsPollMsec = 10;
 #endif
 const IPAddress apSoftIP(192, 168, 4, 1);
 
@@ -36,6 +39,21 @@ static const char kStatusConnectionLost[] = "connection-lost";
 static const char kStatusDisconnected[] = "disconnected";
 static const char kStatusWrongPassword[] = "wrong-password";
 
+enum VarIndex : uint16_t { kVarBoard, kVarEssId, kVarPassword, kVarIpAddr, kVarRssi, kVarCount };
+
+const VariableDescriptor s_vars[] PROGMEM = {
+    {"board", "", "Device name", VariableBase::kConfig | VariableBase::kSettable, 0},
+    {"essId", "", "", VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish,
+     0},
+    {"wifiPassword", "", "",
+     VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish |
+         VariableBase::kNoDisplay,
+     0},
+    {"ipAddr", "", "", 0, 0},
+    {"rssi", units::kDecibel, "", 0, 0},
+};
+static_assert(std::size(s_vars) == kVarCount, "s_vars must describe each VarIndex");
+
 const char* nullToEmpty(const char* str) { return str ? str : ""; }
 }  // namespace
 
@@ -79,17 +97,12 @@ WifiManager::WifiManager(const char* default_board_name, Tasks* tasks,
       m_scheduler(tasks),
       m_sanity_scheduler(tasks),
       m_ap_password(options.ap_password),
-      m_vg(kName, nullptr, 4),
-      m_board("board", default_board_name, "", "Device name",
-              VariableBase::kConfig | VariableBase::kSettable, m_vg),
-      m_essid("essId", nullToEmpty(options.default_essid), "", "",
-              VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish, m_vg),
-      m_password("wifiPassword", nullToEmpty(options.default_password), "", "",
-                 VariableBase::kConfig | VariableBase::kSettable | VariableBase::kNoPublish |
-                     VariableBase::kNoDisplay,
-                 m_vg),
-      m_ip_addr("ipAddr", "", "", "", 0, m_vg),
-      m_rssi("rssi", 0, units::kDecibel, "", 0, m_vg) {
+      m_vg(kName, s_vars),
+      m_board(kVarBoard, default_board_name, m_vg),
+      m_essid(kVarEssId, nullToEmpty(options.default_essid), m_vg),
+      m_password(kVarPassword, nullToEmpty(options.default_password), m_vg),
+      m_ip_addr(kVarIpAddr, "", m_vg),
+      m_rssi(kVarRssi, 0, m_vg) {
   require(ConfigInterface::kName, &m_config);
   add_init_fn([this]() {
 #ifndef NATIVE
@@ -117,11 +130,15 @@ WifiManager::WifiManager(const char* default_board_name, Tasks* tasks,
     }
   });
 #ifndef NATIVE
-  add_update_fn([this]() {
-    if (m_ap_mode && m_dns_server) {
-      m_dns_server->processNextRequest();
-    }
-  });
+  // The DNS server is only polled in AP mode; startAp() enables this.
+  m_dns_update = add_update_fn(
+      [this]() {
+        if (m_ap_mode && m_dns_server) {
+          m_dns_server->processNextRequest();
+        }
+      },
+      kDnsPollMsec);
+  set_update_enabled(m_dns_update, false);
 #endif
   scheduleSanityCheck();
 }
@@ -266,6 +283,7 @@ void WifiManager::startAp() {
   }
   m_dns_server->setErrorReplyCode(DNSReplyCode::NoError);
   m_dns_server->start(DNS_PORT, "*", apSoftIP);
+  set_update_enabled(m_dns_update, true);
   for (const auto& callback : m_softAPCallbacks) {
     callback();
   }
@@ -286,6 +304,7 @@ void WifiManager::startClient() {
   }
   // If we have a configured ESSID, try to connect to it.
   m_ap_mode = false;
+  set_update_enabled(m_dns_update, false);
   m_start_connect_msec = millis();
   log()->logf("Wifi: connecting to essid %s (%s)", essId().c_str(), strWifiStatus());
   WiFi.mode(WIFI_STA);
@@ -13,7 +13,8 @@ const char WifiMonitor::kName[] = "wifi-monitor";
 
 WifiMonitor::WifiMonitor(Tasks* tasks)
     : Module(WifiMonitor::kName, tasks->module_system()),
-      m_scheduler(10 * kMsecInSec, kMsecInMin, [this]() { statusUpdate(); }, tasks) {
+      m_scheduler(10 * kMsecInSec, kMsecInMin, [this]() { statusUpdate(); }, tasks,
+                  MissedTicks::kSkip, 5 * kMsecInSec) {
   require(WifiManager::kName, &m_wifi_manager);
   require(MqttManager::kName, &m_mqtt_manager);
   require(HADiscovery::kName, &m_ha_discovery);
@@ -0,0 +1,196 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/alloc_guard.h"
+
+#include <ArduinoFake.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "og3/app.h"
+#include "og3/module.h"
+#include "unity.h"
+
+#ifdef OG3_ALLOC_GUARD
+#include "og3/blink_led.h"
+#include "og3/constants.h"
+#include "og3/html_table.h"
+#include "og3/relay.h"
+#endif
+
+using namespace fakeit;
+
+namespace {
+
+unsigned long s_msec = 0;
+
+constexpr unsigned kTaskId = 7;
+
+}  // namespace
+
+void setUp() {
+  ArduinoFakeReset();
+  s_msec = 0;
+  When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_msec; });
+  When(Method(ArduinoFake(), micros)).AlwaysDo([]() -> unsigned long { return s_msec * 1000; });
+  When(Method(ArduinoFake(), pinMode)).AlwaysReturn();
+  When(Method(ArduinoFake(), digitalWrite)).AlwaysReturn();
+  og3::AllocGuard::setAction(og3::AllocGuard::Action::kCount);
+}
+
+void tearDown() { og3::AllocGuard::disarm(); }
+
+// Allocations reported to the guard are charged to the running update function or task.
+void test_attribution() {
+  og3::App app({});
+  og3::Module quiet("quiet", &app.module_system());
+  quiet.add_update_fn([]() {});
+  og3::Module noisy("noisy", &app.module_system());
+  noisy.add_update_fn([]() { og3::AllocGuard::onAlloc(16); });
+  // Allocations on other threads are not tracked.
+  std::atomic<bool> go{false};
+  std::thread other([&go]() {
+    while (!go.load()) {
+    }
+    og3::AllocGuard::onAlloc(8);
+  });
+  app.setup();
+  og3::AllocGuard::arm(&app.module_system());
+  go.store(true);
+  other.join();
+
+  app.tasks().runIn(
+      10,
+      []() {
+        og3::AllocGuard::onAlloc(32);
+        og3::AllocGuard::onAlloc(32);
+      },
+      kTaskId);
+  og3::AllocGuard::onAlloc(8);  // Outside any callback.
+  for (int i = 0; i < 3; i++) {
+    s_msec += 10;
+    app.loop();
+  }
+
+  TEST_ASSERT_EQUAL(0, og3::AllocGuard::moduleAllocs(quiet.sorted_index()));
+  TEST_ASSERT_EQUAL(3, og3::AllocGuard::moduleAllocs(noisy.sorted_index()));
+  TEST_ASSERT_EQUAL(1, og3::AllocGuard::taskAllocs().size());
+  TEST_ASSERT_EQUAL(kTaskId, og3::AllocGuard::taskAllocs()[0].id);
+  TEST_ASSERT_EQUAL(2, og3::AllocGuard::taskAllocs()[0].count);
+  TEST_ASSERT_EQUAL(1, og3::AllocGuard::loopAllocs());
+  TEST_ASSERT_EQUAL(6, og3::AllocGuard::total());
+
+  og3::AllocGuard::disarm();
+  app.loop();
+  TEST_ASSERT_EQUAL(6, og3::AllocGuard::total());
+}
+
+#ifdef OG3_ALLOC_GUARD
+namespace {
+
+// The module of the blink example.
+class Blink : public og3::Module {
+ public:
+  explicit Blink(og3::App* app) : og3::Module("blink", &app->module_system()), m_app(app) {
+    add_init_fn([]() { pinMode(7, OUTPUT); });
+    add_start_fn([this]() { blink(); });
+  }
+  void blink() {
+    digitalWrite(7, m_high ? HIGH : LOW);
+    m_high = !m_high;
+    m_app->tasks().runIn(1000, [this]() { blink(); });
+    m_app->log().logf("blink: %s", m_high ? "on" : "off");
+  }
+
+ private:
+  og3::App* m_app;
+  bool m_high = false;
+};
+
+// Does what MqttManager::mqttSend() and a web status page do with a VariableGroup.
+class Publisher : public og3::Module {
+ public:
+  Publisher(og3::App* app, const og3::VariableGroup& vg)
+      : og3::Module("publisher", &app->module_system()), m_vg(vg) {
+    add_update_fn([this]() { publish(); }, 10 * og3::kMsecInSec);
+  }
+  void publish() {
+    String json;
+    m_vg.toJson(&json, 0);
+    if (++m_count % 6 == 0) {
+      String html;
+      og3::html::writeTableInto(&html, m_vg);
+    }
+  }
+
+ private:
+  const og3::VariableGroup& m_vg;
+  unsigned m_count = 0;
+};
+
+}  // namespace
+
+// Runs a typical app for a simulated hour and reports who allocates in the loop.
+void test_simulated_hour() {
+  constexpr unsigned kLoopMsec = 10;
+  constexpr unsigned long kNumLoops = og3::kMsecInHour / kLoopMsec;
+
+  og3::App app({});
+  og3::VariableGroup vg("relays");
+  og3::Relay relay("relay", &app.tasks(), 5, "relay", true, vg);
+  og3::BlinkLed led("led", 6, &app, 100);
+  Blink blink(&app);
+  Publisher publisher(&app, vg);
+  // Cycle the relay every five minutes.
+  app.tasks().runPeriodicAt(0, 5 * og3::kMsecInMin, [&relay]() { relay.turnOn(og3::kMsecInMin); },
+                            kTaskId);
+  app.setup();
+  TEST_ASSERT_TRUE(og3::AllocGuard::armed());
+
+  for (unsigned long i = 0; i < kNumLoops; i++) {
+    s_msec += kLoopMsec;
+    app.loop();
+  }
+  og3::AllocGuard::disarm();
+
+  printf("Allocations after setup in %lu loops:\n", kNumLoops);
+  for (std::size_t i = 0; i < app.module_system().num_modules(); i++) {
+    const uint32_t count = og3::AllocGuard::moduleAllocs(i);
+    printf("  update of %-16s %8lu  %.4f/loop\n", app.module_system().find_sorted(i)->name(),
+           static_cast<unsigned long>(count), static_cast<double>(count) / kNumLoops);
+  }
+  for (const og3::AllocGuard::TaskAllocs& entry : og3::AllocGuard::taskAllocs()) {
+    printf("  task %-24u %8lu  %.4f/loop\n", entry.id, static_cast<unsigned long>(entry.count),
+           static_cast<double>(entry.count) / kNumLoops);
+  }
+  printf("  %-29s %8lu\n", "loop", static_cast<unsigned long>(og3::AllocGuard::loopAllocs()));
+
+  // The scheduler, the module system and the blink example do not allocate.
+  TEST_ASSERT_EQUAL(0, og3::AllocGuard::loopAllocs());
+  TEST_ASSERT_EQUAL(0, og3::AllocGuard::moduleAllocs(blink.sorted_index()));
+  TEST_ASSERT_EQUAL(0, og3::AllocGuard::moduleAllocs(app.tasks().sorted_index()));
+  // Formatting JSON and HTML into Strings does.
+  TEST_ASSERT_GREATER_THAN(0, og3::AllocGuard::moduleAllocs(publisher.sorted_index()));
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_attribution);
+#ifdef OG3_ALLOC_GUARD
+  RUN_TEST(test_simulated_hour);
+#endif
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
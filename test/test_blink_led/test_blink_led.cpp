@@ -65,10 +65,28 @@ void test_blink_sequence() {
       .Exactly(3);  // Initial + 1st off + 2nd off
 }
 
+void test_blink_stop() {
+  og3::App app({});
+  uint8_t pin = 13;
+
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(0);
+  When(Method(ArduinoFake(), pinMode)).AlwaysReturn();
+  When(Method(ArduinoFake(), digitalWrite)).AlwaysReturn();
+
+  og3::BlinkLed led("myled", pin, &app, 100, false /*onLow*/);
+  app.setup();
+  led.blink(3);
+  TEST_ASSERT_EQUAL(1, app.tasks().size());
+  led.stop();
+  TEST_ASSERT_TRUE(app.tasks().queue().empty());
+  Verify(Method(ArduinoFake(), digitalWrite).Using(pin, LOW)).Exactly(2);  // Initial + stop
+}
+
 int runUnityTests() {
   UNITY_BEGIN();
   RUN_TEST(test_blink_led_basic);
   RUN_TEST(test_blink_sequence);
+  RUN_TEST(test_blink_stop);
   return UNITY_END();
 }
 
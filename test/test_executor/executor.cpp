@@ -0,0 +1,159 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/executor.h"
+
+#include <ArduinoFake.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "og3/app.h"
+#include "unity.h"
+
+using namespace fakeit;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Runs the app loop until done is set or a second passes.
+bool loopUntil(og3::App* app, const bool& done) {
+  const Clock::time_point start = Clock::now();
+  while (!done && Clock::now() - start < std::chrono::seconds(1)) {
+    app->loop();
+  }
+  return done;
+}
+
+}  // namespace
+
+void setUp() {
+  ArduinoFakeReset();
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
+}
+
+void tearDown() {}
+
+void test_work_off_loop() {
+  og3::App app({});
+  og3::Executor executor(&app.tasks(), 1);
+  app.setup();
+  TEST_ASSERT_EQUAL(1, executor.numWorkers());
+
+  std::thread::id work_thread;
+  std::thread::id done_thread;
+  bool done = false;
+  TEST_ASSERT_TRUE(executor.runIn(0, [&work_thread]() { work_thread = std::this_thread::get_id(); },
+                                  [&done_thread, &done]() {
+                                    done_thread = std::this_thread::get_id();
+                                    done = true;
+                                  }));
+  TEST_ASSERT_EQUAL(1, executor.pending());
+  TEST_ASSERT_TRUE(loopUntil(&app, done));
+  // Work ran on a worker, and the completion callback ran on the loop thread.
+  TEST_ASSERT_TRUE(work_thread != std::this_thread::get_id());
+  TEST_ASSERT_TRUE(done_thread == std::this_thread::get_id());
+  TEST_ASSERT_EQUAL(0, executor.pending());
+}
+
+void test_parallel_workers() {
+  og3::App app({});
+  og3::Executor executor(&app.tasks(), 2);
+  app.setup();
+
+  // Each job waits until both workers are busy at once.
+  std::atomic<int> active{0};
+  std::atomic<int> max_active{0};
+  int completed = 0;
+  auto work = [&active, &max_active]() {
+    const int now_active = ++active;
+    if (now_active > max_active) {
+      max_active = now_active;
+    }
+    const Clock::time_point start = Clock::now();
+    while (max_active < 2 && Clock::now() - start < std::chrono::milliseconds(500)) {
+      std::this_thread::yield();
+    }
+    --active;
+  };
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(executor.runIn(0, work, [&completed]() { completed += 1; }));
+  }
+  const Clock::time_point start = Clock::now();
+  while (completed < 4 && Clock::now() - start < std::chrono::seconds(1)) {
+    app.loop();
+  }
+  TEST_ASSERT_EQUAL(4, completed);
+  TEST_ASSERT_EQUAL(2, max_active.load());
+}
+
+void test_slots() {
+  og3::App app({});
+  og3::Executor executor(&app.tasks(), 1);
+  app.setup();
+  int runs = 0;
+  // A job with the same ID replaces one which has not started.
+  const unsigned id = app.tasks().getId();
+  TEST_ASSERT_TRUE(executor.runIn(10, [&runs]() { runs += 1; }, nullptr, id));
+  TEST_ASSERT_TRUE(executor.runIn(10, [&runs]() { runs += 10; }, nullptr, id));
+  TEST_ASSERT_EQUAL(1, executor.pending());
+  for (std::size_t i = 1; i < og3::Executor::kMaxJobs; i++) {
+    TEST_ASSERT_TRUE(executor.runIn(10, []() {}));
+  }
+  TEST_ASSERT_FALSE(executor.runIn(10, []() {}));
+
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(1010);
+  const Clock::time_point start = Clock::now();
+  while (executor.pending() > 0 && Clock::now() - start < std::chrono::seconds(1)) {
+    app.loop();
+  }
+  TEST_ASSERT_EQUAL(0, executor.pending());
+  TEST_ASSERT_EQUAL(10, runs);
+}
+
+void test_task_queue_full() {
+  og3::App app(og3::App::Options().withReserveTasks(4));
+  og3::Executor executor(&app.tasks(), 1);
+  app.setup();
+  int runs = 0;
+  const unsigned id = app.tasks().getId();
+  TEST_ASSERT_TRUE(executor.runIn(10, [&runs]() { runs += 1; }, nullptr, id));
+  while (!app.tasks().queue().full()) {
+    TEST_ASSERT_TRUE(app.tasks().runIn(1000, []() {}));
+  }
+  // The job slot is freed when its task cannot be scheduled.
+  TEST_ASSERT_FALSE(executor.runIn(10, [&runs]() { runs += 100; }));
+  TEST_ASSERT_EQUAL(1, executor.pending());
+  // Replacing a job cancels its task, which makes room for the new one.
+  TEST_ASSERT_TRUE(executor.runIn(10, [&runs]() { runs += 10; }, nullptr, id));
+  TEST_ASSERT_EQUAL(1, executor.pending());
+
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(1010);
+  const Clock::time_point start = Clock::now();
+  while (executor.pending() > 0 && Clock::now() - start < std::chrono::seconds(1)) {
+    app.loop();
+  }
+  TEST_ASSERT_EQUAL(0, executor.pending());
+  TEST_ASSERT_EQUAL(10, runs);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_work_off_loop);
+  RUN_TEST(test_parallel_workers);
+  RUN_TEST(test_slots);
+  RUN_TEST(test_task_queue_full);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -0,0 +1,67 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/heap_stats.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "unity.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_read() {
+  // Leave some free space in the heap.
+  void* block = malloc(64 * 1024);
+  memset(block, 1, 64 * 1024);
+  free(block);
+
+  og3::HeapStats stats;
+  stats.read();
+  TEST_ASSERT_GREATER_THAN(0, stats.free_bytes);
+  TEST_ASSERT_LESS_OR_EQUAL(stats.free_bytes, stats.largest_free_block);
+  TEST_ASSERT_LESS_OR_EQUAL(100, stats.fragmentation_pct);
+  TEST_ASSERT_EQUAL(stats.free_bytes, stats.min_free_bytes);
+
+  // The minimum is kept across reads.
+  const uint32_t first_free = stats.free_bytes;
+  stats.read();
+  TEST_ASSERT_LESS_OR_EQUAL(first_free, stats.min_free_bytes);
+  TEST_ASSERT_LESS_OR_EQUAL(stats.free_bytes, stats.min_free_bytes);
+}
+
+#ifdef OG3_ALLOC_HOOK
+void test_alloc_counts() {
+  og3::HeapStats before;
+  before.read();
+  for (int i = 0; i < 10; i++) {
+    void* volatile block = malloc(32);
+    free(block);
+  }
+  og3::HeapStats after;
+  after.read();
+  TEST_ASSERT_GREATER_OR_EQUAL(before.num_allocs + 10, after.num_allocs);
+  TEST_ASSERT_GREATER_OR_EQUAL(before.num_frees + 10, after.num_frees);
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_read);
+#ifdef OG3_ALLOC_HOOK
+  RUN_TEST(test_alloc_counts);
+#endif
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -0,0 +1,139 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include <ArduinoFake.h>
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include "og3/app.h"
+#include "og3/tasks.h"
+#include "unity.h"
+
+using namespace fakeit;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+const Clock::time_point s_start = Clock::now();
+
+// millis() follows the real clock so that idle time is real time.
+unsigned long realMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - s_start).count();
+}
+
+unsigned long msecSince(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+}
+
+void setFlag(void* flag) { *static_cast<bool*>(flag) = true; }
+
+struct LoopResult {
+  double cpu_msec;
+  unsigned ticks;
+};
+
+// Runs the app for wall_msec with a 20 msec periodic task, measuring CPU time used.
+LoopResult runFor(unsigned max_idle_msec, unsigned long wall_msec) {
+  og3::App app(og3::App::Options().withMaxIdleMsec(max_idle_msec));
+  unsigned ticks = 0;
+  og3::PeriodicTaskScheduler periodic(20, 20, [&ticks]() { ticks += 1; }, &app.tasks());
+  app.setup();
+
+  const std::clock_t cpu_start = std::clock();
+  const Clock::time_point start = Clock::now();
+  while (msecSince(start) < wall_msec) {
+    app.loop();
+  }
+  const double cpu_msec = 1000.0 * (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  return {cpu_msec, ticks};
+}
+
+}  // namespace
+
+void setUp() {
+  ArduinoFakeReset();
+  When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return realMillis(); });
+}
+
+void tearDown() {}
+
+void test_msec_until_next() {
+  og3::App app({});
+  og3::Tasks& tasks = app.tasks();
+  TEST_ASSERT_EQUAL(50, tasks.msecUntilNext(1000, 50));
+  tasks.runAt(1030, []() {});
+  TEST_ASSERT_EQUAL(30, tasks.msecUntilNext(1000, 50));
+  TEST_ASSERT_EQUAL(10, tasks.msecUntilNext(1000, 10));
+  TEST_ASSERT_EQUAL(0, tasks.msecUntilNext(1030, 50));
+  TEST_ASSERT_EQUAL(0, tasks.msecUntilNext(1040, 50));
+
+  bool flag = false;
+  og3::Tasks::run_next(setFlag, &flag);
+  TEST_ASSERT_EQUAL(0, tasks.msecUntilNext(1000, 50));
+  tasks.loop();
+  TEST_ASSERT_TRUE(flag);
+}
+
+void test_idle_sleeps_until_deadline() {
+  og3::App app(og3::App::Options().withMaxIdleMsec(1000));
+  app.setup();
+  const Clock::time_point start = Clock::now();
+  unsigned long ran_msec = 0;
+  app.tasks().runIn(50, [&ran_msec, start]() { ran_msec = msecSince(start); });
+  while (ran_msec == 0 && msecSince(start) < 2000) {
+    app.loop();
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(50, ran_msec);
+  TEST_ASSERT_LESS_THAN(100, ran_msec);
+}
+
+void test_idle_wakes_on_event() {
+  og3::App app(og3::App::Options().withMaxIdleMsec(1000));
+  app.setup();
+  bool flag = false;
+  std::thread poster([&flag]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    og3::Tasks::run_next(setFlag, &flag);
+  });
+  // Nothing is scheduled, so the loop sleeps until the event is posted.
+  const Clock::time_point start = Clock::now();
+  app.loop();
+  const unsigned long slept_msec = msecSince(start);
+  poster.join();
+  app.loop();
+  TEST_ASSERT_TRUE(flag);
+  TEST_ASSERT_GREATER_OR_EQUAL(20, slept_msec);
+  TEST_ASSERT_LESS_THAN(500, slept_msec);
+}
+
+void test_idle_cpu() {
+  const LoopResult spin = runFor(0, 300);
+  const LoopResult idle = runFor(100, 300);
+  printf("300 msec with a 20 msec task: spin %.1f msec CPU (%u ticks),"
+         " idle %.1f msec CPU (%u ticks)\n",
+         spin.cpu_msec, spin.ticks, idle.cpu_msec, idle.ticks);
+  TEST_ASSERT_GREATER_OR_EQUAL(10, idle.ticks);
+  TEST_ASSERT_GREATER_OR_EQUAL(spin.ticks - 2, idle.ticks);
+  TEST_ASSERT_TRUE(idle.cpu_msec < spin.cpu_msec / 4);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_msec_until_next);
+  RUN_TEST(test_idle_sleeps_until_deadline);
+  RUN_TEST(test_idle_wakes_on_event);
+  RUN_TEST(test_idle_cpu);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -0,0 +1,150 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/inline_function.h"
+
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#include "og3/task_queue.h"
+#include "unity.h"
+
+// Count heap allocations made through the global operator new.
+static unsigned long s_num_allocs = 0;
+
+void* operator new(std::size_t size) {
+  s_num_allocs += 1;
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+
+// Tracks the number of live copies of a captured object.
+struct Counted {
+  static int s_live;
+  Counted() { s_live += 1; }
+  Counted(const Counted&) { s_live += 1; }
+  Counted(Counted&&) { s_live += 1; }
+  ~Counted() { s_live -= 1; }
+};
+int Counted::s_live = 0;
+
+int s_calls = 0;
+void increment() { s_calls += 1; }
+
+}  // namespace
+
+void test_call() {
+  og3::TaskThunk empty;
+  TEST_ASSERT_FALSE(empty);
+  og3::TaskThunk null_fn(nullptr);
+  TEST_ASSERT_FALSE(null_fn);
+  void (*null_ptr)() = nullptr;
+  og3::TaskThunk null_ptr_fn(null_ptr);
+  TEST_ASSERT_FALSE(null_ptr_fn);
+
+  s_calls = 0;
+  og3::TaskThunk fn_ptr(&increment);
+  TEST_ASSERT_TRUE(fn_ptr);
+  fn_ptr();
+  TEST_ASSERT_EQUAL(1, s_calls);
+
+  int a = 0;
+  int b = 0;
+  int c = 0;
+  og3::TaskThunk lambda([&a, &b, &c]() {
+    a += 1;
+    b += 2;
+    c += 3;
+  });
+  lambda();
+  lambda();
+  TEST_ASSERT_EQUAL(2, a);
+  TEST_ASSERT_EQUAL(4, b);
+  TEST_ASSERT_EQUAL(6, c);
+
+  og3::InlineFunction<int(int, int), 8> add([](int x, int y) { return x + y; });
+  TEST_ASSERT_EQUAL(7, add(3, 4));
+}
+
+void test_move() {
+  Counted::s_live = 0;
+  {
+    int calls = 0;
+    Counted counted;
+    og3::TaskThunk first([counted, &calls]() { calls += 1; });
+    TEST_ASSERT_EQUAL(2, Counted::s_live);
+
+    og3::TaskThunk second(std::move(first));
+    TEST_ASSERT_FALSE(first);
+    TEST_ASSERT_TRUE(second);
+    TEST_ASSERT_EQUAL(2, Counted::s_live);
+    second();
+    TEST_ASSERT_EQUAL(1, calls);
+
+    og3::TaskThunk third;
+    third = std::move(second);
+    TEST_ASSERT_FALSE(second);
+    third();
+    TEST_ASSERT_EQUAL(2, calls);
+    TEST_ASSERT_EQUAL(2, Counted::s_live);
+
+    third = nullptr;
+    TEST_ASSERT_FALSE(third);
+    TEST_ASSERT_EQUAL(1, Counted::s_live);
+
+    third = [counted]() {};
+    TEST_ASSERT_EQUAL(2, Counted::s_live);
+  }
+  TEST_ASSERT_EQUAL(0, Counted::s_live);
+}
+
+void test_no_allocations() {
+  og3::TaskQueue queue(32);
+  unsigned long sum = 0;
+  unsigned long* psum = &sum;
+  const unsigned id = queue.getId();
+  s_calls = 0;
+
+  const unsigned long allocs_before = s_num_allocs;
+  for (unsigned long i = 0; i < 100000; i++) {
+    // A capture of a pointer and two integers, similar to [this, id] callbacks in modules.
+    queue.insertReplace(i, [psum, i, id]() { *psum += id ? i : 0; }, id);
+    queue.insert(i, &increment);
+    TEST_ASSERT_TRUE(queue.runNext());
+    TEST_ASSERT_TRUE(queue.runNext());
+  }
+  TEST_ASSERT_EQUAL(0, s_num_allocs - allocs_before);
+  TEST_ASSERT_TRUE(queue.empty());
+  TEST_ASSERT_TRUE(sum == 100000ul * 99999ul / 2);
+  TEST_ASSERT_EQUAL(100000, s_calls);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_call);
+  RUN_TEST(test_move);
+  RUN_TEST(test_no_allocations);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -0,0 +1,174 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/isr_event_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "unity.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+
+int s_calls = 0;
+void onEvent(void* ctx) { s_calls += static_cast<int>(reinterpret_cast<uintptr_t>(ctx)); }
+
+// Events from producer threads carry (producer << 24 | sequence) as their context.
+constexpr uintptr_t kSeqBits = 24;
+constexpr uintptr_t kSeqMask = (uintptr_t(1) << kSeqBits) - 1;
+
+void* eventCtx(unsigned producer, unsigned seq) {
+  return reinterpret_cast<void*>((uintptr_t(producer) << kSeqBits) | seq);
+}
+unsigned ctxProducer(void* ctx) {
+  return static_cast<unsigned>(reinterpret_cast<uintptr_t>(ctx) >> kSeqBits);
+}
+unsigned ctxSeq(void* ctx) {
+  return static_cast<unsigned>(reinterpret_cast<uintptr_t>(ctx) & kSeqMask);
+}
+
+}  // namespace
+
+void test_fifo() {
+  og3::IsrEventQueue queue(5);
+  TEST_ASSERT_EQUAL(8, queue.capacity());
+
+  og3::IsrEvent event;
+  TEST_ASSERT_FALSE(queue.pop(&event));
+
+  // Fill the queue, then overflow it.
+  for (uintptr_t i = 1; i <= 10; i++) {
+    TEST_ASSERT_EQUAL(i <= 8, queue.post(onEvent, reinterpret_cast<void*>(i), 100 + i));
+  }
+  TEST_ASSERT_EQUAL(2, queue.dropped());
+
+  s_calls = 0;
+  for (uintptr_t i = 1; i <= 8; i++) {
+    TEST_ASSERT_TRUE(queue.pop(&event));
+    TEST_ASSERT_EQUAL(i, reinterpret_cast<uintptr_t>(event.ctx));
+    TEST_ASSERT_EQUAL(100 + i, event.msec);
+    event.fn(event.ctx);
+  }
+  TEST_ASSERT_EQUAL(36, s_calls);
+  TEST_ASSERT_FALSE(queue.pop(&event));
+
+  // The ring wraps around.
+  for (uintptr_t lap = 0; lap < 100; lap++) {
+    TEST_ASSERT_TRUE(queue.post(onEvent, reinterpret_cast<void*>(lap), lap));
+    TEST_ASSERT_TRUE(queue.post(onEvent, reinterpret_cast<void*>(lap + 1), lap));
+    TEST_ASSERT_TRUE(queue.pop(&event));
+    TEST_ASSERT_EQUAL(lap, reinterpret_cast<uintptr_t>(event.ctx));
+    TEST_ASSERT_TRUE(queue.pop(&event));
+    TEST_ASSERT_EQUAL(lap + 1, reinterpret_cast<uintptr_t>(event.ctx));
+  }
+  TEST_ASSERT_EQUAL(2, queue.dropped());
+}
+
+// Producers posting no more than the capacity between drains never lose an event.
+void test_threads_below_capacity() {
+  constexpr unsigned kProducers = 4;
+  constexpr unsigned kPerProducer = 16;
+  constexpr unsigned kRounds = 500;
+  og3::IsrEventQueue queue(kProducers * kPerProducer);
+
+  std::vector<unsigned> next_seq(kProducers, 0);
+  for (unsigned round = 0; round < kRounds; round++) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < kProducers; p++) {
+      threads.emplace_back([&queue, &go, p, round]() {
+        while (!go.load()) {
+        }
+        for (unsigned i = 0; i < kPerProducer; i++) {
+          queue.post(onEvent, eventCtx(p, round * kPerProducer + i), round);
+        }
+      });
+    }
+    go.store(true);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    og3::IsrEvent event;
+    unsigned received = 0;
+    while (queue.pop(&event)) {
+      const unsigned p = ctxProducer(event.ctx);
+      TEST_ASSERT_LESS_THAN(kProducers, p);
+      // Each producer's events arrive in the order it posted them.
+      TEST_ASSERT_EQUAL(next_seq[p], ctxSeq(event.ctx));
+      next_seq[p] += 1;
+      received += 1;
+    }
+    TEST_ASSERT_EQUAL(kProducers * kPerProducer, received);
+  }
+  TEST_ASSERT_EQUAL(0, queue.dropped());
+}
+
+// With a concurrent consumer, every event is either received once or counted as dropped.
+void test_threads_concurrent() {
+  constexpr unsigned kProducers = 4;
+  constexpr unsigned kPerProducer = 100000;
+  og3::IsrEventQueue queue(64);
+
+  std::atomic<unsigned> done{0};
+  std::vector<std::thread> threads;
+  for (unsigned p = 0; p < kProducers; p++) {
+    threads.emplace_back([&queue, &done, p]() {
+      for (unsigned i = 0; i < kPerProducer; i++) {
+        queue.post(onEvent, eventCtx(p, i), i);
+      }
+      done.fetch_add(1);
+    });
+  }
+
+  std::vector<unsigned> last_seq(kProducers, 0);
+  std::vector<bool> seen_any(kProducers, false);
+  unsigned long received = 0;
+  og3::IsrEvent event;
+  while (true) {
+    const bool finished = done.load() == kProducers;
+    while (queue.pop(&event)) {
+      const unsigned p = ctxProducer(event.ctx);
+      const unsigned seq = ctxSeq(event.ctx);
+      TEST_ASSERT_LESS_THAN(kProducers, p);
+      // Events may be dropped, but never duplicated or reordered.
+      if (seen_any[p]) {
+        TEST_ASSERT_GREATER_THAN(last_seq[p], seq);
+      }
+      seen_any[p] = true;
+      last_seq[p] = seq;
+      received += 1;
+    }
+    if (finished) {
+      break;
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  TEST_ASSERT_TRUE(received + queue.dropped() == kProducers * kPerProducer);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fifo);
+  RUN_TEST(test_threads_below_capacity);
+  RUN_TEST(test_threads_concurrent);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
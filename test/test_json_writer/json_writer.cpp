@@ -0,0 +1,229 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/json_writer.h"
+
+#include <ArduinoFake.h>
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "og3/heap_stats.h"
+#include "og3/text_buffer.h"
+#include "og3/variable.h"
+#include "unity.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_writer() {
+  char buffer[128];
+  og3::JsonWriter out(buffer, sizeof(buffer));
+  out.raw('[');
+  out.string("a \"b\"\\\n\x01");
+  out.raw(',');
+  out.value(-42);
+  out.raw(',');
+  out.value(LLONG_MIN);
+  out.raw(',');
+  out.value(4000000000u);
+  out.raw(',');
+  out.value(-2.345, 2);
+  out.raw(',');
+  out.value(1.0 / 3, 0);
+  out.raw(',');
+  out.value(NAN, 2);
+  out.raw(',');
+  out.value(true);
+  out.raw(']');
+  TEST_ASSERT_EQUAL_STRING(
+      "[\"a \\\"b\\\"\\\\\\n\\u0001\",-42,-9223372036854775808,4000000000,-2.35,0,null,true]",
+      buffer);
+  TEST_ASSERT_EQUAL(strlen(buffer), out.length());
+  TEST_ASSERT_FALSE(out.truncated());
+}
+
+void test_truncation() {
+  char buffer[8];
+  og3::JsonWriter out(buffer, sizeof(buffer));
+  out.string("abcdefghij");
+  TEST_ASSERT_TRUE(out.truncated());
+  TEST_ASSERT_EQUAL(12, out.length());
+  TEST_ASSERT_EQUAL_STRING("\"abcdef", buffer);
+
+  og3::VariableGroup vg("small");
+  og3::Variable<int> ival("ival", 12345, "", "", 0, vg);
+  TEST_ASSERT_EQUAL(14, vg.writeJson(buffer, sizeof(buffer), 0));
+  TEST_ASSERT_EQUAL_STRING("{\"ival\"", buffer);
+
+  og3::TextBuffer<16> text;
+  text.add("value:");
+  TEST_ASSERT_FALSE(vg.writeJson(&text, 0));
+  TEST_ASSERT_EQUAL(20, text.length());
+  TEST_ASSERT_EQUAL_STRING("value:{\"ival\":1", text.text());
+}
+
+void test_group() {
+  enum class Mode { kOff, kOn };
+  const char* mode_names[] = {"off", "on"};
+  og3::VariableGroup vg("group");
+  og3::Variable<int> ival("ival", -3, "", "", 0, vg);
+  og3::Variable<unsigned> uval("uval", 7, "", "", og3::VariableBase::kNoPublish, vg);
+  og3::FloatVariable fval("fval", 21.456, "", "", 0, 1, vg);
+  og3::Variable<String> sval("sval", String("say \"hi\""), "", "", 0, vg);
+  og3::BoolVariable bval("bval", true, "", 0, vg);
+  og3::BinarySensorVariable motion("motion", false, "", vg);
+  og3::EnumStrVariable<Mode> mode("mode", Mode::kOn, "", Mode::kOn, mode_names, 0, vg);
+  og3::DoubleVariable failed("failed", 1.0, "", "", 0, 2, vg);
+  failed.setFailed();
+
+  og3::TextBuffer<256> text;
+  TEST_ASSERT_TRUE(vg.writeJson(&text, og3::VariableBase::kNoPublish));
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"ival\":-3,\"fval\":21.5,\"sval\":\"say \\\"hi\\\"\",\"bval\":\"true\","
+      "\"motion\":\"OFF\",\"mode\":\"on\"}",
+      text.text());
+
+  // The output parses back to the same values.
+  JsonDocument doc;
+  TEST_ASSERT_FALSE(deserializeJson(doc, text.text()));
+  TEST_ASSERT_EQUAL(-3, doc["ival"].as<int>());
+  TEST_ASSERT_EQUAL_STRING("say \"hi\"", doc["sval"].as<const char*>());
+
+  // Only changed variables.
+  vg.clearChanged();
+  uval = 8;
+  ival = 4;
+  text.clear();
+  TEST_ASSERT_TRUE(vg.writeJson(&text, 0, true));
+  TEST_ASSERT_EQUAL_STRING("{\"ival\":4,\"uval\":8}", text.text());
+}
+
+// writeJson() selects the same variables as toJson(), which keeps config variables out
+//  of MQTT messages unless kConfig is passed.
+void test_matches_to_json() {
+  og3::VariableGroup vg("config");
+  og3::Variable<int> ival("ival", 5, "", "", 0, vg);
+  og3::Variable<String> board("board", String("esp"), "", "", og3::VariableBase::kConfig, vg);
+  og3::Variable<unsigned> uval("uval", 7, "", "",
+                               og3::VariableBase::kConfig | og3::VariableBase::kSettable, vg);
+  og3::Variable<int> hidden("hidden", 1, "", "", og3::VariableBase::kNoPublish, vg);
+
+  constexpr unsigned kConfig = og3::VariableBase::kConfig;
+  constexpr unsigned kNoPublish = og3::VariableBase::kNoPublish;
+  for (unsigned flags : {0u, kConfig, kNoPublish, kConfig | kNoPublish}) {
+    JsonDocument doc;
+    vg.toJson(doc.to<JsonObject>(), flags);
+    std::string expected;
+    serializeJson(doc, expected);
+    og3::TextBuffer<128> text;
+    TEST_ASSERT_TRUE(vg.writeJson(&text, flags));
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), text.text());
+  }
+  og3::TextBuffer<128> text;
+  vg.writeJson(&text, kNoPublish);
+  TEST_ASSERT_EQUAL_STRING("{\"ival\":5}", text.text());
+}
+
+namespace {
+
+// A group of num_vars variables of mixed types, with their names.
+struct BenchGroup {
+  explicit BenchGroup(unsigned num_vars) : vg("bench", nullptr, num_vars) {
+    names.reserve(num_vars);
+    for (unsigned i = 0; i < num_vars; i++) {
+      names.push_back("variable" + std::to_string(i));
+      const char* name = names.back().c_str();
+      switch (i % 4) {
+        case 0:
+          vars.emplace_back(new og3::FloatVariable(name, 20.5f + i, "", "", 0, 2, vg));
+          break;
+        case 1:
+          vars.emplace_back(new og3::Variable<unsigned>(name, 1000 * i, "", "", 0, vg));
+          break;
+        case 2:
+          vars.emplace_back(new og3::Variable<int>(name, -static_cast<int>(i), "", "", 0, vg));
+          break;
+        default:
+          vars.emplace_back(new og3::BinarySensorVariable(name, i % 8 == 3, "", vg));
+          break;
+      }
+    }
+  }
+  std::vector<std::string> names;
+  og3::VariableGroup vg;
+  std::vector<std::unique_ptr<og3::VariableBase>> vars;
+};
+
+template <typename Fn>
+double nsecPerCall(unsigned num_calls, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < num_calls; i++) {
+    fn();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / num_calls;
+}
+
+}  // namespace
+
+// Compares a JsonDocument plus serializeJson(), the path behind VariableGroup::toJson(),
+//  with writing the group straight into a buffer.
+void test_benchmark() {
+  static char buffer[16 * 1024];
+  for (unsigned num_vars : {8u, 32u, 128u, 256u}) {
+    BenchGroup bench(num_vars);
+    const unsigned num_calls = 200000 / num_vars;
+    std::string dom_out;
+    const double dom_nsec = nsecPerCall(num_calls, [&]() {
+      JsonDocument doc;
+      bench.vg.toJson(doc.to<JsonObject>(), 0);
+      dom_out.clear();
+      serializeJson(doc, dom_out);
+    });
+    size_t len = 0;
+    const double stream_nsec =
+        nsecPerCall(num_calls, [&]() { len = bench.vg.writeJson(buffer, sizeof(buffer), 0); });
+    TEST_ASSERT_LESS_THAN(sizeof(buffer), len);
+    printf("%3u variables: JsonDocument %8.0f nsec, writeJson %7.0f nsec (%.1f nsec/var)\n",
+           num_vars, dom_nsec, stream_nsec, stream_nsec / num_vars);
+    TEST_ASSERT_LESS_THAN(dom_nsec, stream_nsec);
+
+    if (og3::HeapStats::countsAllocations()) {
+      og3::HeapStats before;
+      before.read();
+      bench.vg.writeJson(buffer, sizeof(buffer), 0);
+      og3::HeapStats after;
+      after.read();
+      TEST_ASSERT_EQUAL(before.num_allocs, after.num_allocs);
+    }
+  }
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_writer);
+  RUN_TEST(test_truncation);
+  RUN_TEST(test_group);
+  RUN_TEST(test_matches_to_json);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -0,0 +1,119 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include <ArduinoFake.h>
+
+#include <vector>
+
+#include "og3/app.h"
+#include "og3/module.h"
+#include "og3/tasks.h"
+#include "unity.h"
+
+using namespace fakeit;
+
+namespace {
+
+// A fake microsecond clock, which work advances explicitly.
+unsigned long s_usec = 0;
+
+}  // namespace
+
+void setUp() {
+  ArduinoFakeReset();
+  s_usec = 0;
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
+  When(Method(ArduinoFake(), micros)).AlwaysDo([]() -> unsigned long { return s_usec; });
+}
+
+void tearDown() {}
+
+void test_task_count_budget() {
+  og3::App app(og3::App::Options().withLoopBudget(0, 2));
+  og3::Tasks& tasks = app.tasks();
+  std::vector<int> order;
+  for (int i = 0; i < 5; i++) {
+    tasks.runAt(1000, [&order, i]() { order.push_back(i); });
+  }
+  TEST_ASSERT_EQUAL(2, tasks.loop());
+  TEST_ASSERT_EQUAL(1, tasks.deferrals());
+  // Nothing is left to wait for, so the loop does not sleep.
+  TEST_ASSERT_EQUAL(0, tasks.msecUntilNext(1000, 100));
+  TEST_ASSERT_EQUAL(2, tasks.loop());
+  TEST_ASSERT_EQUAL(1, tasks.loop());
+  TEST_ASSERT_EQUAL(2, tasks.deferrals());
+  TEST_ASSERT_EQUAL(0, tasks.loop());
+  // Deferred tasks ran in their original order.
+  TEST_ASSERT_EQUAL(5, order.size());
+  for (int i = 0; i < 5; i++) {
+    TEST_ASSERT_EQUAL(i, order[i]);
+  }
+}
+
+void test_task_time_budget() {
+  og3::App app(og3::App::Options().withLoopBudget(250));
+  og3::Tasks& tasks = app.tasks();
+  int runs = 0;
+  for (int i = 0; i < 5; i++) {
+    tasks.runAt(1000, [&runs]() {
+      runs += 1;
+      s_usec += 100;
+    });
+  }
+  // The third task uses up the budget.
+  TEST_ASSERT_EQUAL(3, tasks.loop());
+  TEST_ASSERT_EQUAL(1, tasks.deferrals());
+  TEST_ASSERT_EQUAL(2, tasks.loop());
+  TEST_ASSERT_EQUAL(5, runs);
+  TEST_ASSERT_EQUAL(1, tasks.deferrals());
+
+  // A single task longer than the budget still runs.
+  tasks.runAt(1000, []() { s_usec += 1000; });
+  TEST_ASSERT_EQUAL(1, tasks.loop());
+  TEST_ASSERT_EQUAL(1, tasks.deferrals());
+}
+
+void test_update_round_robin() {
+  og3::App app(og3::App::Options().withLoopBudget(150));
+  og3::ModuleSystem& modules = app.module_system();
+  int updates[3] = {0, 0, 0};
+  og3::Module m1("m1", &modules);
+  og3::Module m2("m2", &modules);
+  og3::Module m3("m3", &modules);
+  og3::Module* mods[3] = {&m1, &m2, &m3};
+  for (int i = 0; i < 3; i++) {
+    mods[i]->add_update_fn([&updates, i]() {
+      updates[i] += 1;
+      s_usec += 100;
+    });
+  }
+  app.setup();
+
+  // Each call runs only part of the update functions, but all take turns.
+  for (int i = 0; i < 6; i++) {
+    TEST_ASSERT_LESS_THAN(4, modules.update());
+  }
+  TEST_ASSERT_TRUE(modules.update_deferrals() > 0);
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_TRUE(updates[i] >= 3);
+  }
+  TEST_ASSERT_TRUE(updates[0] - updates[2] <= 1);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_task_count_budget);
+  RUN_TEST(test_task_time_budget);
+  RUN_TEST(test_update_round_robin);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -0,0 +1,145 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/loop_stats.h"
+
+#include <ArduinoFake.h>
+
+#include <cstring>
+
+#include "og3/app.h"
+#include "og3/module.h"
+#include "unity.h"
+
+using namespace fakeit;
+
+namespace {
+
+// A fake clock, which callbacks advance explicitly.
+unsigned long s_usec = 0;
+unsigned s_micros_calls = 0;
+
+String stringOf(const og3::VariableGroup& vg, const char* name) {
+  for (const og3::VariableBase* var : vg.variables()) {
+    if (0 == strcmp(var->name(), name)) {
+      return var->string();
+    }
+  }
+  TEST_FAIL_MESSAGE(name);
+  return "";
+}
+
+}  // namespace
+
+void setUp() {
+  ArduinoFakeReset();
+  s_usec = 0;
+  s_micros_calls = 0;
+  When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_usec / 1000; });
+  When(Method(ArduinoFake(), micros)).AlwaysDo([]() -> unsigned long {
+    s_micros_calls += 1;
+    return s_usec;
+  });
+}
+
+void tearDown() {}
+
+void test_record() {
+  og3::LoopStats stats;
+  stats.reset(0);
+  // 1000 loops of 100 usec and one of 5000, with 30 usec of tasks each, over 2 seconds.
+  for (int i = 0; i < 1000; i++) {
+    stats.addTasksUsec(30);
+    stats.record(100);
+  }
+  stats.record(5000);
+  TEST_ASSERT_EQUAL(1001, stats.windowLoops());
+  TEST_ASSERT_EQUAL(1001, stats.latency().count());
+  stats.update(2000);
+
+  const og3::VariableGroup& vg = stats.variables();
+  TEST_ASSERT_EQUAL_STRING("500.5", stringOf(vg, "loopRate").c_str());
+  TEST_ASSERT_EQUAL_STRING("5000", stringOf(vg, "loopMax").c_str());
+  TEST_ASSERT_EQUAL_STRING("127", stringOf(vg, "loopP50").c_str());
+  TEST_ASSERT_EQUAL_STRING("127", stringOf(vg, "loopP99").c_str());
+  // (100000 + 5000 - 30000) usec of module updates and 30000 usec of tasks in 2 sec.
+  TEST_ASSERT_EQUAL_STRING("3.8", stringOf(vg, "modulesPct").c_str());
+  TEST_ASSERT_EQUAL_STRING("1.5", stringOf(vg, "tasksPct").c_str());
+
+  // The next window starts empty, histogram included, so that the percentiles follow
+  // recent loops rather than everything since boot.
+  TEST_ASSERT_EQUAL(0, stats.windowLoops());
+  TEST_ASSERT_EQUAL(0, stats.latency().count());
+  for (int i = 0; i < 100; i++) {
+    stats.record(3000);
+  }
+  stats.update(3000);
+  TEST_ASSERT_EQUAL_STRING("100.0", stringOf(vg, "loopRate").c_str());
+  TEST_ASSERT_EQUAL_STRING("3000", stringOf(vg, "loopMax").c_str());
+  // Not 127, as it would be with the 1001 faster loops of the first window.
+  TEST_ASSERT_EQUAL_STRING("3000", stringOf(vg, "loopP50").c_str());
+  stats.update(4000);
+  TEST_ASSERT_EQUAL_STRING("0.0", stringOf(vg, "loopRate").c_str());
+  TEST_ASSERT_EQUAL_STRING("0", stringOf(vg, "loopMax").c_str());
+  TEST_ASSERT_EQUAL_STRING("0", stringOf(vg, "loopP50").c_str());
+}
+
+void test_app_loop() {
+  og3::App app(og3::App::Options().withLoopStats());
+  og3::Module busy("busy", &app.module_system());
+  busy.add_update_fn([]() { s_usec += 200; });
+  app.setup();
+  og3::LoopStats& stats = app.tasks().loopStats();
+  TEST_ASSERT_TRUE(stats.enabled());
+  stats.reset(0);
+  for (int i = 0; i < 100; i++) {
+    app.tasks().runIn(0, []() { s_usec += 50; });
+    s_usec += 1000;  // Outside the update, as if the loop slept.
+    app.loop();
+  }
+  TEST_ASSERT_EQUAL(100, stats.windowLoops());
+  TEST_ASSERT_EQUAL(250, stats.latency().max());
+  stats.update(s_usec / 1000);
+  const og3::VariableGroup& vg = stats.variables();
+  // 125 msec in total: 100 * 200 usec of updates and 100 * 50 usec of tasks.
+  TEST_ASSERT_EQUAL_STRING("800.0", stringOf(vg, "loopRate").c_str());
+  TEST_ASSERT_EQUAL_STRING("16.0", stringOf(vg, "modulesPct").c_str());
+  TEST_ASSERT_EQUAL_STRING("4.0", stringOf(vg, "tasksPct").c_str());
+}
+
+void test_disabled() {
+  og3::App app({});
+  app.setup();
+  s_micros_calls = 0;
+  app.loop();
+  // Without loop stats, the loop does not read micros(), apart from the module profiler
+  // timing each update callback.
+  unsigned profile_calls = 0;
+#ifdef OG3_MODULE_PROFILE
+  const og3::ModuleProfile& profile = app.module_system().profile();
+  for (std::size_t i = 0; i < profile.numEntries(); i++) {
+    profile_calls += 2 * profile.entry(i).timing(og3::ModuleProfile::Phase::kUpdate).count;
+  }
+#endif
+  TEST_ASSERT_EQUAL(profile_calls, s_micros_calls);
+  TEST_ASSERT_FALSE(app.tasks().loopStats().enabled());
+  TEST_ASSERT_EQUAL(0, app.tasks().loopStats().windowLoops());
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_record);
+  RUN_TEST(test_app_loop);
+  RUN_TEST(test_disabled);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
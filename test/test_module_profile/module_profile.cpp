@@ -0,0 +1,139 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/module_profile.h"
+
+#include <ArduinoFake.h>
+
+#include <cstring>
+
+#include "og3/app.h"
+#include "og3/module.h"
+#include "unity.h"
+
+using namespace fakeit;
+
+namespace {
+
+// A fake microsecond clock, which callbacks advance explicitly.
+unsigned long s_usec = 0;
+
+unsigned valueOf(const og3::VariableGroup& vg, const char* name) {
+  for (const og3::VariableBase* var : vg.variables()) {
+    if (0 == strcmp(var->name(), name)) {
+      return static_cast<unsigned>(var->string().toInt());
+    }
+  }
+  TEST_FAIL_MESSAGE(name);
+  return 0;
+}
+
+String stringOf(const og3::VariableGroup& vg, const char* name) {
+  for (const og3::VariableBase* var : vg.variables()) {
+    if (0 == strcmp(var->name(), name)) {
+      return var->string();
+    }
+  }
+  TEST_FAIL_MESSAGE(name);
+  return "";
+}
+
+}  // namespace
+
+void setUp() {
+  ArduinoFakeReset();
+  s_usec = 0;
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
+  When(Method(ArduinoFake(), micros)).AlwaysDo([]() -> unsigned long { return s_usec; });
+}
+
+void tearDown() {}
+
+void test_record() {
+  using Phase = og3::ModuleProfile::Phase;
+  og3::ModuleProfile profile;
+  profile.setNumModules(2);
+  profile.setName(0, "fast");
+  profile.setName(1, "slow");
+  profile.record(0, Phase::kInit, 300);
+  profile.record(1, Phase::kStart, 40);
+  for (int i = 0; i < 10; i++) {
+    profile.record(0, Phase::kUpdate, 5);
+    profile.record(1, Phase::kUpdate, i == 3 ? 900 : 10);
+  }
+  // Modules beyond the table are ignored.
+  profile.record(2, Phase::kUpdate, 100000);
+
+  const og3::ModuleProfile::Timing& slow = profile.entry(1).timing(Phase::kUpdate);
+  TEST_ASSERT_EQUAL(10, slow.count);
+  TEST_ASSERT_EQUAL(990, slow.total_usec);
+  TEST_ASSERT_EQUAL(900, slow.max_usec);
+
+  profile.update();
+  const og3::VariableGroup& vg = profile.variables();
+  TEST_ASSERT_EQUAL(300, valueOf(vg, "initUsec"));
+  TEST_ASSERT_EQUAL(40, valueOf(vg, "startUsec"));
+  TEST_ASSERT_EQUAL_STRING("slow", stringOf(vg, "slowestUpdate").c_str());
+  TEST_ASSERT_EQUAL(900, valueOf(vg, "slowestUpdateMax"));
+
+  String json;
+  profile.writeJsonInto(&json);
+  TEST_ASSERT_EQUAL_STRING(
+      "[{\"name\":\"fast\",\"init\":{\"count\":1,\"totalUsec\":300,\"maxUsec\":300},"
+      "\"start\":{\"count\":0,\"totalUsec\":0,\"maxUsec\":0},"
+      "\"update\":{\"count\":10,\"totalUsec\":50,\"maxUsec\":5}},"
+      "{\"name\":\"slow\",\"init\":{\"count\":0,\"totalUsec\":0,\"maxUsec\":0},"
+      "\"start\":{\"count\":1,\"totalUsec\":40,\"maxUsec\":40},"
+      "\"update\":{\"count\":10,\"totalUsec\":990,\"maxUsec\":900}}]",
+      json.c_str());
+  String html;
+  profile.writeHtmlInto(&html);
+  TEST_ASSERT_NOT_NULL(strstr(html.c_str(), "<tr><td>slow</td><td>0</td><td>40</td><td>10</td>"
+                                            "<td>99</td><td>900</td></tr>"));
+
+  // Reset clears update timings, but boot timings are kept.
+  profile.reset();
+  TEST_ASSERT_EQUAL(0, profile.entry(1).timing(Phase::kUpdate).count);
+  TEST_ASSERT_EQUAL(300, valueOf(vg, "initUsec"));
+  TEST_ASSERT_EQUAL(0, valueOf(vg, "slowestUpdateMax"));
+}
+
+#ifdef OG3_MODULE_PROFILE
+void test_module_system() {
+  using Phase = og3::ModuleProfile::Phase;
+  og3::App app({});
+  og3::Module busy("busy", &app.module_system());
+  busy.add_init_fn([]() { s_usec += 1000; });
+  busy.add_update_fn([]() { s_usec += 70; });
+  app.setup();
+  for (int i = 0; i < 3; i++) {
+    app.loop();
+  }
+  const og3::ModuleProfile& profile = app.module_system().profile();
+  TEST_ASSERT_EQUAL(app.module_system().num_modules(), profile.numEntries());
+  const og3::ModuleProfile::Entry& entry = profile.entry(busy.sorted_index());
+  TEST_ASSERT_EQUAL_STRING("busy", entry.name);
+  TEST_ASSERT_EQUAL(1000, entry.timing(Phase::kInit).total_usec);
+  TEST_ASSERT_EQUAL(3, entry.timing(Phase::kUpdate).count);
+  TEST_ASSERT_EQUAL(210, entry.timing(Phase::kUpdate).total_usec);
+}
+#endif
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_record);
+#ifdef OG3_MODULE_PROFILE
+  RUN_TEST(test_module_system);
+#endif
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
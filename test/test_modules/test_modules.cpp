@@ -3,7 +3,9 @@
 
 #include <ArduinoFake.h>
 
+#include <chrono>
 #include <cstdio>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -110,11 +112,135 @@ void test3() {
   TEST_ASSERT_TRUE(log.check("Circular dependency detected involving module 'test2'.\n"));
 }
 
+void test_find() {
+  og3::TestLogger log;
+  og3::Logger* plog = &log;
+  og3::ModuleSystem depends(&plog);
+  // Names in separate buffers, so requirements only match by string comparison.
+  char name1[] = "test1";
+  char name2[] = "test2";
+  char required[] = "test1";
+  og3::TestModule test1(name1, {}, &depends);
+  og3::TestModule test2(name2, {required}, &depends);
+  char lookup[] = "test2";
+  TEST_ASSERT_EQUAL_PTR(&test2, depends.find(lookup));
+  TEST_ASSERT_TRUE(depends.link());
+  TEST_ASSERT_EQUAL_PTR(&test1, depends.find("test1"));
+  TEST_ASSERT_EQUAL_PTR(&test2, depends.find(lookup));
+  TEST_ASSERT_NULL(depends.find("test3"));
+  TEST_ASSERT_TRUE(test1.sorted_index() < test2.sorted_index());
+}
+
+void test_duplicate_name() {
+  og3::TestLogger log;
+  og3::Logger* plog = &log;
+  og3::ModuleSystem depends(&plog);
+  og3::TestModule first("test1", {}, &depends);
+  og3::TestModule second("test1", {}, &depends);
+  TEST_ASSERT_TRUE(depends.link());
+  TEST_ASSERT_TRUE(log.check("Duplicate module name 'test1'.\n"));
+  TEST_ASSERT_EQUAL_PTR(&first, depends.find("test1"));
+}
+
+namespace {
+unsigned long s_now = 0;
+}  // namespace
+
+void test_update_rates() {
+  using namespace fakeit;
+  unsigned long& now = s_now;
+  now = 1000;
+  When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_now; });
+  og3::TestLogger log;
+  og3::Logger* plog = &log;
+  og3::ModuleSystem depends(&plog);
+  og3::Module dns("dns", &depends);
+  og3::Module ota("ota", &depends);
+  og3::Module tasks("tasks", &depends);
+  int calls[3] = {0, 0, 0};
+  const auto dns_id = dns.add_update_fn([&calls]() { calls[0] += 1; }, 10);
+  ota.add_update_fn([&calls]() { calls[1] += 1; }, 50);
+  tasks.add_update_fn([](void* count) { *static_cast<int*>(count) += 1; }, &calls[2]);
+  dns.set_update_enabled(dns_id, false);
+  TEST_ASSERT_TRUE(depends.link());
+
+  // One second of a loop running every millisecond.
+  int total = 0;
+  for (; now < 2000; now++) {
+    total += depends.update();
+  }
+  TEST_ASSERT_EQUAL(0, calls[0]);
+  TEST_ASSERT_EQUAL(20, calls[1]);
+  TEST_ASSERT_EQUAL(1000, calls[2]);
+  TEST_ASSERT_EQUAL(1020, total);
+
+  // An enabled callback runs at once, then at its interval.
+  dns.set_update_enabled(dns_id, true);
+  TEST_ASSERT_TRUE(depends.update_enabled(dns_id));
+  for (; now < 2100; now++) {
+    depends.update();
+  }
+  TEST_ASSERT_EQUAL(10, calls[0]);
+  TEST_ASSERT_EQUAL(22, calls[1]);
+  TEST_ASSERT_EQUAL(1100, calls[2]);
+}
+
+namespace {
+
+// Links num_modules synthetic modules, each requiring up to two earlier ones, registered
+// in reverse dependency order. Returns the time to link in microseconds per module.
+double linkUsecPerModule(std::size_t num_modules) {
+  og3::TestLogger log;
+  og3::Logger* plog = &log;
+  og3::ModuleSystem depends(&plog, num_modules);
+  std::vector<std::string> names(num_modules);
+  for (std::size_t i = 0; i < num_modules; i++) {
+    names[i] = "m" + std::to_string(i);
+  }
+  std::vector<std::unique_ptr<og3::TestModule>> modules;
+  modules.reserve(num_modules);
+  for (std::size_t i = num_modules; i-- > 0;) {
+    std::vector<const char*> preds;
+    if (i > 0) {
+      preds.push_back(names[i - 1].c_str());
+      preds.push_back(names[i / 2].c_str());
+    }
+    modules.emplace_back(new og3::TestModule(names[i].c_str(), preds, &depends));
+  }
+  const auto start = std::chrono::steady_clock::now();
+  TEST_ASSERT_TRUE(depends.link());
+  const auto usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  // Every module comes after its requirements.
+  for (std::size_t i = 1; i < num_modules; i++) {
+    const og3::TestModule& mod = *modules[num_modules - 1 - i];
+    TEST_ASSERT_TRUE(mod.sorted_index() > modules[num_modules - i]->sorted_index());
+  }
+  return static_cast<double>(usec) / num_modules;
+}
+
+}  // namespace
+
+// Links large module graphs in dependency order. Boot time per module should stay
+// roughly flat as the number of modules grows; the times are printed, not checked, since
+// they depend on the load of the machine running the test.
+void test_link_scaling() {
+  for (std::size_t num_modules : {1000, 2000, 5000, 10000}) {
+    const double usec = linkUsecPerModule(num_modules);
+    printf("link %5zu modules: %.3f usec/module\n", num_modules, usec);
+  }
+}
+
 int runUnityTests() {
   UNITY_BEGIN();
   RUN_TEST(test1);
   RUN_TEST(test2);
   RUN_TEST(test3);
+  RUN_TEST(test_find);
+  RUN_TEST(test_duplicate_name);
+  RUN_TEST(test_update_rates);
+  RUN_TEST(test_link_scaling);
   return UNITY_END();
 }
 
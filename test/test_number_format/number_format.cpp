@@ -0,0 +1,220 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/number_format.h"
+
+#include <ArduinoFake.h>
+
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "og3/html_table.h"
+#include "og3/variable.h"
+#include "unity.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_format() {
+  char buf[64];
+  TEST_ASSERT_EQUAL(1, og3::formatUnsigned(buf, sizeof(buf), 0));
+  TEST_ASSERT_EQUAL_STRING("0", buf);
+  og3::formatUnsigned(buf, sizeof(buf), ULLONG_MAX);
+  TEST_ASSERT_EQUAL_STRING("18446744073709551615", buf);
+  og3::formatInt(buf, sizeof(buf), LLONG_MIN);
+  TEST_ASSERT_EQUAL_STRING("-9223372036854775808", buf);
+
+  og3::formatFixed(buf, sizeof(buf), 21.456, 1);
+  TEST_ASSERT_EQUAL_STRING("21.5", buf);
+  og3::formatFixed(buf, sizeof(buf), -0.05, 3);
+  TEST_ASSERT_EQUAL_STRING("-0.050", buf);
+  og3::formatFixed(buf, sizeof(buf), -0.001, 2);
+  TEST_ASSERT_EQUAL_STRING("0.00", buf);
+  og3::formatFixed(buf, sizeof(buf), 99.996, 2);
+  TEST_ASSERT_EQUAL_STRING("100.00", buf);
+  og3::formatFixed(buf, sizeof(buf), 1e20, 1);
+  TEST_ASSERT_EQUAL_STRING("100000000000000000000.0", buf);
+  og3::formatFixed(buf, sizeof(buf), NAN, 2);
+  TEST_ASSERT_EQUAL_STRING("nan", buf);
+  og3::formatFixed(buf, sizeof(buf), -INFINITY, 2);
+  TEST_ASSERT_EQUAL_STRING("-inf", buf);
+
+  // Truncated output reports the full length.
+  TEST_ASSERT_EQUAL(6, og3::formatFixed(buf, 4, -12.345, 2));
+  TEST_ASSERT_EQUAL_STRING("-12", buf);
+
+  // Agrees with printf() on random values.
+  std::mt19937 gen32;
+  std::uniform_real_distribution<double> dist(-1e6, 1e6);
+  char expected[64];
+  for (int i = 0; i < 10000; i++) {
+    const double val = dist(gen32);
+    const unsigned decimals = i % 5;
+    og3::formatFixed(buf, sizeof(buf), val, decimals);
+    snprintf(expected, sizeof(expected), "%.*f", decimals, val);
+    TEST_ASSERT_EQUAL_STRING(expected, buf);
+  }
+}
+
+void test_parse() {
+  long long ival = 0;
+  TEST_ASSERT_TRUE(og3::parseInt(" -42x", 5, &ival));
+  TEST_ASSERT_EQUAL(-42, ival);
+  TEST_ASSERT_TRUE(og3::parseInt("-9223372036854775808", 20, &ival));
+  TEST_ASSERT_EQUAL(LLONG_MIN, ival);
+  TEST_ASSERT_FALSE(og3::parseInt("9223372036854775808", 19, &ival));
+  TEST_ASSERT_FALSE(og3::parseInt("-", 1, &ival));
+  // Only len characters are read.
+  TEST_ASSERT_TRUE(og3::parseInt("12345", 2, &ival));
+  TEST_ASSERT_EQUAL(12, ival);
+
+  unsigned long long uval = 0;
+  TEST_ASSERT_TRUE(og3::parseUnsigned("+7", 2, &uval));
+  TEST_ASSERT_EQUAL(7, uval);
+  TEST_ASSERT_FALSE(og3::parseUnsigned("-7", 2, &uval));
+
+  double dval = 0;
+  TEST_ASSERT_TRUE(og3::parseDouble("5.25", 4, &dval));
+  TEST_ASSERT_EQUAL_DOUBLE(5.25, dval);
+  TEST_ASSERT_TRUE(og3::parseDouble("-.5e2", 5, &dval));
+  TEST_ASSERT_EQUAL_DOUBLE(-50.0, dval);
+  TEST_ASSERT_TRUE(og3::parseDouble("1e", 2, &dval));
+  TEST_ASSERT_EQUAL_DOUBLE(1.0, dval);
+  TEST_ASSERT_TRUE(og3::parseDouble("0.000123", 8, &dval));
+  TEST_ASSERT_EQUAL_DOUBLE(0.000123, dval);
+  TEST_ASSERT_TRUE(og3::parseDouble("123456789012345678901234", 24, &dval));
+  TEST_ASSERT_EQUAL_DOUBLE(123456789012345678901234.0, dval);
+  TEST_ASSERT_TRUE(og3::parseDouble("1.5e-300", 8, &dval));
+  TEST_ASSERT_EQUAL_DOUBLE(1.5e-300, dval);
+  TEST_ASSERT_TRUE(og3::parseDouble("-INF", 4, &dval));
+  TEST_ASSERT_TRUE(std::isinf(dval) && dval < 0);
+  TEST_ASSERT_FALSE(og3::parseDouble(" .", 2, &dval));
+  TEST_ASSERT_FALSE(og3::parseDouble("", 0, &dval));
+
+  // Agrees with strtod() on random values, to the bit.
+  std::mt19937 gen32;
+  std::uniform_real_distribution<double> dist(-1e6, 1e6);
+  char text[64];
+  for (int i = 0; i < 10000; i++) {
+    const int len = snprintf(text, sizeof(text), "%.*g", 1 + i % 15, dist(gen32));
+    TEST_ASSERT_TRUE(og3::parseDouble(text, len, &dval));
+    TEST_ASSERT_EQUAL_DOUBLE(strtod(text, nullptr), dval);
+  }
+}
+
+void test_variables() {
+  enum class Mode { kOff, kOn };
+  const char* mode_names[] = {"off", "on"};
+  og3::VariableGroup vg("vars");
+  og3::FloatVariable fval("fval", 10.0, "", "", 0, 2, vg);
+  og3::Variable<int> ival("ival", 0, "", "", 0, vg);
+  og3::Variable<unsigned> uval("uval", 0, "", "", 0, vg);
+  og3::BoolVariable bval("bval", false, "", 0, vg);
+  og3::EnumStrVariable<Mode> mode("mode", Mode::kOff, "", Mode::kOn, mode_names, 0, vg);
+  char buf[32];
+
+  TEST_ASSERT_TRUE(fval.parse("2.5", 3));
+  TEST_ASSERT_EQUAL(4, fval.formatTo(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("2.50", buf);
+  TEST_ASSERT_EQUAL_STRING(buf, fval.string().c_str());
+  TEST_ASSERT_FALSE(fval.parse("x", 1));
+  TEST_ASSERT_TRUE(fval.failed());
+
+  TEST_ASSERT_TRUE(ival.parse("-12", 3));
+  ival.formatTo(buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("-12", buf);
+  TEST_ASSERT_FALSE(ival.parse("4294967296", 10));
+  TEST_ASSERT_TRUE(uval.parse("4294967295", 10));
+  TEST_ASSERT_EQUAL(UINT_MAX, uval.value());
+
+  TEST_ASSERT_TRUE(bval.parse("on", 2));
+  bval.formatTo(buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("true", buf);
+  TEST_ASSERT_TRUE(bval.parse("off", 3));
+  TEST_ASSERT_FALSE(bval.value());
+
+  // "on" is matched by name, and "o" is not a name.
+  TEST_ASSERT_TRUE(mode.parse("onx", 2));
+  TEST_ASSERT_EQUAL(Mode::kOn, mode.value());
+  TEST_ASSERT_FALSE(mode.parse("o", 1));
+  TEST_ASSERT_TRUE(mode.parse("0", 1));
+  mode.formatTo(buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("off", buf);
+
+  String html;
+  og3::html::writeValueInto(&html, fval);
+  TEST_ASSERT_EQUAL_STRING("2.50", html.c_str());
+}
+
+namespace {
+
+template <typename Fn>
+double nsecPerCall(unsigned num_calls, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < num_calls; i++) {
+    fn(i);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / num_calls;
+}
+
+}  // namespace
+
+// Compares formatting a float variable through string() as before (a String built with
+//  printf-style conversion) and parsing with sscanf(), with formatTo() and parse().
+void test_benchmark() {
+  constexpr unsigned kNumCalls = 200000;
+  og3::VariableGroup vg("bench");
+  og3::FloatVariable fval("fval", 21.5, "", "", 0, 2, vg);
+  char buf[32];
+  volatile size_t sink = 0;
+
+  const double string_nsec = nsecPerCall(kNumCalls, [&](unsigned i) {
+    fval.value() = 0.37f * i;
+    sink = sink + String(fval.value(), fval.decimals()).length();
+  });
+  const double format_nsec = nsecPerCall(kNumCalls, [&](unsigned i) {
+    fval.value() = 0.37f * i;
+    sink = sink + fval.formatTo(buf, sizeof(buf));
+  });
+  printf("format: String %.1f nsec, formatTo %.1f nsec per variable\n", string_nsec,
+         format_nsec);
+
+  const char* texts[] = {"21.50", "-3.25", "1013.2", "0.004", "65.5"};
+  float parsed = 0;
+  const double sscanf_nsec = nsecPerCall(kNumCalls, [&](unsigned i) {
+    sink = sink + sscanf(texts[i % 5], "%g", &parsed);
+  });
+  const double parse_nsec = nsecPerCall(kNumCalls, [&](unsigned i) {
+    const char* text = texts[i % 5];
+    sink = sink + fval.parse(text, strlen(text));
+  });
+  printf("parse: sscanf %.1f nsec, parse %.1f nsec per variable\n", sscanf_nsec, parse_nsec);
+
+  TEST_ASSERT_LESS_THAN(string_nsec, format_nsec);
+  TEST_ASSERT_LESS_THAN(sscanf_nsec, parse_nsec);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_format);
+  RUN_TEST(test_parse);
+  RUN_TEST(test_variables);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -0,0 +1,186 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include <ArduinoFake.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "og3/app.h"
+#include "og3/module.h"
+#include "unity.h"
+
+using namespace fakeit;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+const Clock::time_point s_start = Clock::now();
+
+unsigned long realMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - s_start).count();
+}
+
+constexpr unsigned kNumSensors = 4;
+constexpr unsigned kProbeMsec = 20;
+constexpr unsigned kMaxWaitMsec = 5000;
+
+// Number of init functions running now, and the most which ran at once.
+std::atomic<unsigned> s_active{0};
+std::atomic<unsigned> s_max_active{0};
+// Probes wait for this many to run at once, so that the count does not depend on timing.
+unsigned s_expect_active = 1;
+
+void enterInit() {
+  const unsigned active = s_active.fetch_add(1) + 1;
+  for (unsigned prev = s_max_active.load(); active > prev;) {
+    if (s_max_active.compare_exchange_weak(prev, active)) {
+      break;
+    }
+  }
+}
+
+// A sensor which takes a while to probe, split over two init functions.
+class Sensor : public og3::Module {
+ public:
+  Sensor(const char* name, og3::ModuleSystem* module_system) : og3::Module(name, module_system) {
+    set_concurrent_init();
+    add_init_fn([this]() {
+      enterInit();
+      const auto deadline = Clock::now() + std::chrono::milliseconds(kMaxWaitMsec);
+      while (s_max_active.load() < s_expect_active && Clock::now() < deadline) {
+        std::this_thread::yield();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(kProbeMsec));
+      m_probed = true;
+      s_active -= 1;
+    });
+    add_init_fn([this]() { m_ready = m_probed.load(); });
+  }
+  bool ready() const { return m_ready; }
+
+ private:
+  std::atomic<bool> m_probed{false};
+  std::atomic<bool> m_ready{false};
+};
+
+// A module at the same depth as the sensors, which is not safe to initialize concurrently.
+class Plain : public og3::Module {
+ public:
+  explicit Plain(og3::ModuleSystem* module_system) : og3::Module("plain", module_system) {
+    add_init_fn([this]() {
+      m_alone = s_active.fetch_add(1) == 0;
+      std::this_thread::sleep_for(std::chrono::milliseconds(kProbeMsec));
+      s_active -= 1;
+    });
+  }
+  bool alone() const { return m_alone; }
+
+ private:
+  bool m_alone = false;
+};
+
+// Requires all of the sensors.
+class Hub : public og3::Module {
+ public:
+  explicit Hub(og3::ModuleSystem* module_system) : og3::Module("hub", module_system) {
+    for (unsigned i = 0; i < kNumSensors; i++) {
+      require(kSensorNames[i], &m_sensors[i]);
+    }
+    add_init_fn([this]() {
+      m_all_ready = true;
+      for (const Sensor* sensor : m_sensors) {
+        m_all_ready = m_all_ready && sensor->ready();
+      }
+    });
+  }
+  bool allReady() const { return m_all_ready; }
+
+  static constexpr const char* kSensorNames[kNumSensors] = {"s0", "s1", "s2", "s3"};
+
+ private:
+  Sensor* m_sensors[kNumSensors] = {};
+  bool m_all_ready = false;
+};
+
+// Boots an app with four sensors and a hub, and returns the most probes which ran at once.
+unsigned bootMaxActive(unsigned init_workers) {
+  s_active = 0;
+  s_max_active = 0;
+  s_expect_active = init_workers > 1 ? std::min(init_workers, kNumSensors) : 1;
+  og3::App app(og3::App::Options().withParallelInit(init_workers));
+  og3::ModuleSystem& modules = app.module_system();
+  // The hub registers first, but is initialized last.
+  Hub hub(&modules);
+  Sensor s0(Hub::kSensorNames[0], &modules);
+  Sensor s1(Hub::kSensorNames[1], &modules);
+  Plain plain(&modules);
+  Sensor s2(Hub::kSensorNames[2], &modules);
+  Sensor s3(Hub::kSensorNames[3], &modules);
+  const unsigned long start = realMicros();
+  app.setup();
+  printf("Init on %u workers: %lu usec, at most %u probes at once\n", init_workers,
+         realMicros() - start, s_max_active.load());
+  TEST_ASSERT_TRUE(hub.allReady());
+  TEST_ASSERT_TRUE(plain.alone());
+
+  if (init_workers > 1) {
+    const auto& levels = modules.init_levels();
+    TEST_ASSERT_EQUAL(2, levels.size());
+    TEST_ASSERT_EQUAL(0, levels[0].level);
+    TEST_ASSERT_EQUAL(kNumSensors + 1, levels[0].num_modules);
+    TEST_ASSERT_EQUAL(kNumSensors, levels[0].num_concurrent);
+    TEST_ASSERT_EQUAL(1, levels[1].level);
+    TEST_ASSERT_EQUAL(1, levels[1].num_modules);
+    TEST_ASSERT_EQUAL(0, levels[1].num_concurrent);
+    for (const auto& level : levels) {
+      printf("  level %u: %u modules in %u usec\n", level.level, level.num_modules, level.usec);
+    }
+  }
+  return s_max_active.load();
+}
+
+}  // namespace
+
+void setUp() {
+  ArduinoFakeReset();
+  When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long {
+    return realMicros() / 1000;
+  });
+  When(Method(ArduinoFake(), micros)).AlwaysDo([]() -> unsigned long { return realMicros(); });
+}
+
+void tearDown() {}
+
+void test_sequential() { TEST_ASSERT_EQUAL(1, bootMaxActive(0)); }
+
+void test_parallel() {
+  // The sensors probe at the same time.
+  TEST_ASSERT_EQUAL(kNumSensors, bootMaxActive(og3::ModuleSystem::kMaxInitWorkers));
+}
+
+void test_fewer_workers() {
+  // Two workers probe four sensors, two at a time.
+  TEST_ASSERT_EQUAL(2, bootMaxActive(2));
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_sequential);
+  RUN_TEST(test_parallel);
+  RUN_TEST(test_fewer_workers);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
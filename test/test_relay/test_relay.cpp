@@ -92,6 +92,38 @@ void test_relay_timed() {
 
   TEST_ASSERT_FALSE(relay.isOn());
   TEST_ASSERT_TRUE(callback_called);
+
+  // Once the turn-off has run, turning off does not cancel a task which reuses its node.
+  const og3::TaskHandle other = app.tasks().runIn(100, []() {});
+  relay.turnOff();
+  TEST_ASSERT_TRUE(app.tasks().pending(other));
+}
+
+void test_relay_retimed() {
+  og3::App app({});
+  og3::VariableGroup vg("test_vg");
+  uint8_t pin = 5;
+
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
+  When(Method(ArduinoFake(), digitalWrite)).AlwaysReturn();
+
+  og3::Relay relay("myrelay", &app.tasks(), pin, "desc", true, vg, og3::Relay::OnLevel::kHigh);
+
+  // Turning on again for longer replaces the first turn-off time.
+  relay.turnOn(500);
+  relay.turnOn(2000);
+  TEST_ASSERT_EQUAL(1, app.tasks().size());
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(1500);
+  app.tasks().loop();
+  TEST_ASSERT_TRUE(relay.isOn());
+  When(Method(ArduinoFake(), millis)).AlwaysReturn(3000);
+  app.tasks().loop();
+  TEST_ASSERT_FALSE(relay.isOn());
+
+  // Turning off cancels the scheduled turn-off, so it can't cut short a later cycle.
+  relay.turnOn(500);
+  relay.turnOff();
+  TEST_ASSERT_TRUE(app.tasks().queue().empty());
 }
 
 int runUnityTests() {
@@ -99,6 +131,7 @@ int runUnityTests() {
   RUN_TEST(test_relay_basic);
   RUN_TEST(test_relay_low_active);
   RUN_TEST(test_relay_timed);
+  RUN_TEST(test_relay_retimed);
   return UNITY_END();
 }
 
@@ -0,0 +1,125 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/stall_watchdog.h"
+
+#include <ArduinoFake.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "og3/app.h"
+#include "og3/module.h"
+#include "unity.h"
+
+using namespace fakeit;
+
+namespace {
+
+const char kPath[] = "og3_stall_test.bin";
+
+unsigned long s_msec = 0;
+
+og3::StallWatchdog::Options options() {
+  return og3::StallWatchdog::Options().withWarnMsec(300).withCheckMsec(0).withPath(kPath);
+}
+
+}  // namespace
+
+void setUp() {
+  ArduinoFakeReset();
+  s_msec = 0;
+  When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_msec; });
+  remove(kPath);
+}
+
+void tearDown() { remove(kPath); }
+
+// A stall which recovers is counted and reported as a near miss, and leaves no record.
+void test_near_miss() {
+  og3::App app({});
+  og3::StallWatchdog watchdog(options(), &app.tasks());
+  og3::Module slow("slow", &app.module_system());
+  slow.add_update_fn([&watchdog]() {
+    // Simulate the monitor sampling the loop while this update is stuck.
+    for (int i = 0; i < 5; i++) {
+      watchdog.check(100);
+    }
+    FILE* record = fopen(kPath, "rb");
+    TEST_ASSERT_NOT_NULL(record);
+    fclose(record);
+  });
+  app.setup();
+  TEST_ASSERT_FALSE(watchdog.resetByStall());
+  app.loop();
+  TEST_ASSERT_EQUAL(0, watchdog.nearMisses());
+  watchdog.check(100);
+  TEST_ASSERT_EQUAL(1, watchdog.nearMisses());
+  TEST_ASSERT_NULL(fopen(kPath, "rb"));
+  // Short stalls are not counted.
+  watchdog.check(100);
+  watchdog.check(100);
+  TEST_ASSERT_EQUAL(1, watchdog.nearMisses());
+}
+
+// A stall which never recovers is reported by the next watchdog, as after a reset.
+void test_reset_during_stall() {
+  const unsigned kTaskId = 42;
+  {
+    og3::App app({});
+    og3::StallWatchdog watchdog(options(), &app.tasks());
+    app.setup();
+    app.tasks().runIn(
+        10,
+        [&watchdog]() {
+          for (int i = 0; i < 8; i++) {
+            watchdog.check(100);
+          }
+        },
+        kTaskId);
+    s_msec = 20;
+    app.loop();
+  }
+  og3::App app({});
+  og3::StallWatchdog watchdog(options(), &app.tasks());
+  TEST_ASSERT_TRUE(watchdog.resetByStall());
+  TEST_ASSERT_EQUAL(static_cast<uint8_t>(og3::DispatchTrace::Kind::kTask),
+                    watchdog.resetRecord().kind);
+  TEST_ASSERT_EQUAL(kTaskId, watchdog.resetRecord().id);
+  // The first check sees the task start, so the stall is timed from the second.
+  TEST_ASSERT_EQUAL(700, watchdog.resetRecord().stall_msec);
+  // The record is only reported once.
+  og3::StallWatchdog again(options(), &app.tasks());
+  TEST_ASSERT_FALSE(again.resetByStall());
+}
+
+// The monitor thread notices a real stall.
+void test_monitor_thread() {
+  og3::App app({});
+  og3::StallWatchdog watchdog(options().withWarnMsec(20).withCheckMsec(5), &app.tasks());
+  og3::Module slow("slow", &app.module_system());
+  slow.add_update_fn([]() { std::this_thread::sleep_for(std::chrono::milliseconds(100)); });
+  app.setup();
+  app.loop();
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  TEST_ASSERT_EQUAL(1, watchdog.nearMisses());
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_near_miss);
+  RUN_TEST(test_reset_during_stall);
+  RUN_TEST(test_monitor_thread);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
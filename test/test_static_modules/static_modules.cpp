@@ -0,0 +1,172 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/static_module_system.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "og3/logger.h"
+#include "og3/module.h"
+#include "og3/module_system.h"
+#include "unity.h"
+
+namespace {
+
+// Counts allocations through the global operator new.
+std::size_t s_num_allocs = 0;
+
+std::vector<const char*> s_calls;
+
+struct Counter {
+  void start() { s_calls.push_back("counter.start"); }
+  void update() { count += 1; }
+  int count = 0;
+};
+
+struct Reader {
+  using Requires = og3::Requires<Counter>;
+  void init(Counter& counter) {
+    s_calls.push_back("reader.init");
+    m_counter = &counter;
+  }
+  void update() { last = m_counter->count; }
+  int last = -1;
+
+ private:
+  Counter* m_counter = nullptr;
+};
+
+// No lifecycle methods.
+struct Config {
+  int value = 7;
+};
+
+struct Reporter {
+  using Requires = og3::Requires<Config, Reader>;
+  void init(Config& config, Reader& reader) {
+    s_calls.push_back("reporter.init");
+    value = config.value;
+    m_reader = &reader;
+  }
+  void start() { s_calls.push_back("reporter.start"); }
+  int value = 0;
+
+ private:
+  Reader* m_reader = nullptr;
+};
+
+using Modules = og3::StaticModuleSystem<Counter, Config, Reader, Reporter>;
+
+// Tables only hold the modules which have each method.
+static_assert(Modules::kInitFns.size() == 2);
+static_assert(Modules::kStartFns.size() == 2);
+static_assert(Modules::kUpdateFns.size() == 2);
+
+class NullLogger : public og3::Logger {
+ public:
+  void log(const char*) final {}
+};
+
+// The same modules as dynamic og3::Modules.
+class DynamicModule : public og3::Module {
+ public:
+  DynamicModule(const char* name, const char* required, og3::ModuleSystem* module_system)
+      : og3::Module(name, module_system) {
+    if (required) {
+      require(required, &m_required);
+    }
+    add_init_fn([this]() { m_count = 0; });
+    add_update_fn([this]() { m_count += 1; });
+  }
+
+ private:
+  og3::Module* m_required = nullptr;
+  int m_count = 0;
+};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  s_num_allocs += 1;
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void setUp() { s_calls.reserve(16); }
+
+void tearDown() { s_calls.clear(); }
+
+void test_lifecycle() {
+  Modules modules;
+  modules.setup();
+  // Init in list order, then start in list order.
+  TEST_ASSERT_EQUAL(4, s_calls.size());
+  TEST_ASSERT_EQUAL_STRING("reader.init", s_calls[0]);
+  TEST_ASSERT_EQUAL_STRING("reporter.init", s_calls[1]);
+  TEST_ASSERT_EQUAL_STRING("counter.start", s_calls[2]);
+  TEST_ASSERT_EQUAL_STRING("reporter.start", s_calls[3]);
+  TEST_ASSERT_EQUAL(7, modules.get<Reporter>().value);
+
+  modules.update();
+  modules.update();
+  TEST_ASSERT_EQUAL(2, modules.get<Counter>().count);
+  // Reader updates after Counter.
+  TEST_ASSERT_EQUAL(2, modules.get<Reader>().last);
+}
+
+void test_no_boot_allocations() {
+  const std::size_t static_before = s_num_allocs;
+  {
+    Modules modules;
+    modules.setup();
+    for (int i = 0; i < 10; i++) {
+      modules.update();
+    }
+  }
+  const std::size_t static_allocs = s_num_allocs - static_before;
+
+  const std::size_t dynamic_before = s_num_allocs;
+  {
+    NullLogger logger;
+    og3::Logger* plog = &logger;
+    og3::ModuleSystem module_system(&plog);
+    DynamicModule counter("counter", nullptr, &module_system);
+    DynamicModule config("config", nullptr, &module_system);
+    DynamicModule reader("reader", "counter", &module_system);
+    DynamicModule reporter("reporter", "reader", &module_system);
+    module_system.setup();
+    for (int i = 0; i < 10; i++) {
+      module_system.update();
+    }
+  }
+  const std::size_t dynamic_allocs = s_num_allocs - dynamic_before;
+  printf("Boot of 4 modules: %zu allocations static, %zu dynamic\n", static_allocs,
+         dynamic_allocs);
+  TEST_ASSERT_EQUAL(0, static_allocs);
+  TEST_ASSERT_TRUE(dynamic_allocs > 0);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_lifecycle);
+  RUN_TEST(test_no_boot_allocations);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
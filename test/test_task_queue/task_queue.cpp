@@ -4,6 +4,8 @@
 #include "og3/task_queue.h"
 
 #include <array>
+#include <chrono>
+#include <map>
 #include <queue>
 #include <random>
 
@@ -273,6 +275,235 @@ void test_eq20() {
   }
 }
 
+// Randomly schedule, replace and remove tasks by ID, checking against a reference map.
+void test_eq_ids() {
+  constexpr unsigned kNumIds = 300;
+  og3::TaskQueue eq(kNumIds);
+  std::map<unsigned, unsigned long> expected;  // id -> msec
+  std::mt19937 gen32;
+
+  for (unsigned i = 0; i < 20000; i++) {
+    const unsigned id = 1 + gen32() % kNumIds;
+    const unsigned long msec = gen32() % 100000;
+    switch (gen32() % 3) {
+      case 0:
+        TEST_ASSERT_EQUAL(expected.count(id) > 0, eq.remove(id));
+        expected.erase(id);
+        break;
+      default:
+        eq.insertReplace(msec, nullptr, id);
+        expected[id] = msec;
+        break;
+    }
+    TEST_ASSERT_EQUAL(expected.size(), eq.size());
+    TEST_ASSERT_EQUAL(expected.count(id) > 0, eq.contains(id));
+  }
+
+  std::multimap<unsigned long, unsigned> by_time;
+  for (const auto& it : expected) {
+    by_time.insert({it.second, it.first});
+  }
+  for (const auto& it : by_time) {
+    TEST_ASSERT_EQUAL(it.first, eq.first().msec);
+    TEST_ASSERT_TRUE(eq.contains(eq.first().id));
+    eq.popFirst();
+  }
+  TEST_ASSERT_TRUE(eq.empty());
+}
+
+// Tasks scheduled for the same time run in the order they were added.
+void test_eq_fifo() {
+  og3::TaskQueue eq(8);
+  int ti = -1;
+  auto fn = [&ti](int i) { ti = i; };
+  for (int i = 0; i < 8; i++) {
+    TEST_ASSERT_TRUE(eq.insert(100, std::bind(fn, i)));
+  }
+  for (int i = 0; i < 8; i++) {
+    TEST_ASSERT_TRUE(eq.runNext());
+    TEST_ASSERT_EQUAL(i, ti);
+  }
+}
+
+// Runs the first task the way Tasks::loop() does, at time now.
+unsigned runFirst(og3::TaskQueue* eq, unsigned long now) {
+  og3::TimedThunk task;
+  og3::TaskQueue::Loan loan;
+  eq->takeFirst(now, &task, &loan);
+  if (task.thunk) {
+    task.thunk();
+  }
+  eq->giveBack(loan, &task.thunk);
+  return task.ticks;
+}
+
+void test_eq_periodic() {
+  og3::TaskQueue eq(4);
+  int runs = 0;
+  TEST_ASSERT_TRUE(eq.insertPeriodic(100, 10, [&runs]() { runs++; }, 1));
+  TEST_ASSERT_TRUE(eq.insert(125, nullptr, 2));
+
+  // On time: the task stays in the queue and moves one period ahead.
+  TEST_ASSERT_EQUAL(1, runFirst(&eq, 100));
+  TEST_ASSERT_EQUAL(1, runs);
+  TEST_ASSERT_EQUAL(2, eq.size());
+  TEST_ASSERT_EQUAL(110, eq.first().msec);
+  TEST_ASSERT_EQUAL(1, eq.first().id);
+  TEST_ASSERT_EQUAL(1, runFirst(&eq, 112));
+  TEST_ASSERT_EQUAL(120, eq.first().msec);
+  TEST_ASSERT_EQUAL(1, runFirst(&eq, 120));
+
+  // The one-shot task at 125 runs between periods.
+  TEST_ASSERT_EQUAL(125, eq.first().msec);
+  TEST_ASSERT_EQUAL(1, runFirst(&eq, 125));
+  TEST_ASSERT_EQUAL(1, eq.size());
+
+  // kSkip: after a stall, run once and continue on the period grid.
+  TEST_ASSERT_EQUAL(130, eq.first().msec);
+  TEST_ASSERT_EQUAL(1, runFirst(&eq, 10055));
+  TEST_ASSERT_EQUAL(4, runs);
+  TEST_ASSERT_EQUAL(10060, eq.first().msec);
+
+  // kCount: same schedule, reporting the elapsed periods.
+  TEST_ASSERT_TRUE(eq.insertPeriodic(200, 10, [&runs]() { runs++; }, 1, og3::MissedTicks::kCount));
+  TEST_ASSERT_EQUAL(1, eq.size());
+  TEST_ASSERT_EQUAL(6, runFirst(&eq, 250));
+  TEST_ASSERT_EQUAL(260, eq.first().msec);
+  TEST_ASSERT_EQUAL(1, runFirst(&eq, 260));
+
+  // kBurst: one run per period until caught up.
+  TEST_ASSERT_TRUE(eq.insertPeriodic(300, 10, [&runs]() { runs++; }, 1, og3::MissedTicks::kBurst));
+  runs = 0;
+  while (og3::isBefore(eq.first().msec, 335)) {
+    TEST_ASSERT_EQUAL(1, runFirst(&eq, 335));
+  }
+  TEST_ASSERT_EQUAL(4, runs);
+  TEST_ASSERT_EQUAL(340, eq.first().msec);
+
+  // A period of 0 is a one-shot task.
+  TEST_ASSERT_TRUE(eq.insertPeriodic(400, 0, [&runs]() { runs++; }, 1));
+  runFirst(&eq, 400);
+  TEST_ASSERT_TRUE(eq.empty());
+}
+
+void test_eq_periodic_changed_in_callback() {
+  og3::TaskQueue eq(4);
+  int runs = 0;
+  og3::TaskQueue* peq = &eq;
+
+  // A periodic task which cancels itself is not rearmed.
+  TEST_ASSERT_TRUE(eq.insertPeriodic(100, 10, [peq, &runs]() { runs += peq->remove(1); }, 1));
+  runFirst(&eq, 100);
+  TEST_ASSERT_EQUAL(1, runs);
+  TEST_ASSERT_TRUE(eq.empty());
+
+  // A periodic task which replaces itself keeps the replacement.
+  TEST_ASSERT_TRUE(eq.insertPeriodic(100, 10, [peq, &runs]() {
+    runs += 10;
+    peq->insertPeriodic(1000, 100, [&runs]() { runs += 100; }, 1);
+  }, 1));
+  runFirst(&eq, 100);
+  TEST_ASSERT_EQUAL(11, runs);
+  TEST_ASSERT_EQUAL(1, eq.size());
+  TEST_ASSERT_EQUAL(1000, eq.first().msec);
+  runFirst(&eq, 1000);
+  TEST_ASSERT_EQUAL(111, runs);
+  TEST_ASSERT_EQUAL(1100, eq.first().msec);
+  TEST_ASSERT_TRUE(eq.thunk(0).thunk);
+}
+
+void test_eq_handles() {
+  og3::TaskQueue eq(2);
+  int runs = 0;
+  const og3::TaskHandle first = eq.insert(100, [&runs]() { runs += 1; });
+  const og3::TaskHandle second = eq.insert(200, [&runs]() { runs += 10; });
+  TEST_ASSERT_TRUE(first);
+  TEST_ASSERT_TRUE(eq.pending(first));
+  TEST_ASSERT_FALSE(eq.pending(og3::TaskHandle()));
+  TEST_ASSERT_FALSE(eq.insert(300, nullptr));
+
+  // Moving the first task after the second changes the order, keeping the handle.
+  TEST_ASSERT_TRUE(eq.reschedule(first, 250));
+  TEST_ASSERT_EQUAL(200, eq.first().msec);
+  runFirst(&eq, 200);
+  TEST_ASSERT_EQUAL(10, runs);
+  TEST_ASSERT_FALSE(eq.pending(second));
+  TEST_ASSERT_TRUE(eq.pending(first));
+
+  // A handle to a task which ran matches nothing, even after its node is reused.
+  const og3::TaskHandle third = eq.insert(300, [&runs]() { runs += 100; });
+  TEST_ASSERT_EQUAL(second.index, third.index);
+  TEST_ASSERT_FALSE(eq.cancel(second));
+  TEST_ASSERT_FALSE(eq.reschedule(second, 50));
+  TEST_ASSERT_TRUE(eq.pending(third));
+
+  TEST_ASSERT_TRUE(eq.cancel(first));
+  TEST_ASSERT_FALSE(eq.cancel(first));
+  TEST_ASSERT_EQUAL(1, eq.size());
+  TEST_ASSERT_TRUE(eq.runNext());
+  TEST_ASSERT_EQUAL(110, runs);
+
+  // A periodic task's handle stays valid across runs.
+  const og3::TaskHandle periodic = eq.insertPeriodic(1000, 10, [&runs]() { runs += 1000; });
+  runFirst(&eq, 1000);
+  runFirst(&eq, 1010);
+  TEST_ASSERT_EQUAL(2110, runs);
+  TEST_ASSERT_TRUE(eq.cancel(periodic));
+  TEST_ASSERT_TRUE(eq.empty());
+
+  // A stale handle still matches nothing after its node is reused 2^16 times.
+  const og3::TaskHandle stale = eq.insert(100, nullptr);
+  TEST_ASSERT_TRUE(eq.cancel(stale));
+  og3::TaskHandle reused;
+  for (unsigned i = 0; i < 0x10000; i++) {
+    reused = eq.insert(100, nullptr);
+    TEST_ASSERT_TRUE(eq.cancel(reused));
+  }
+  reused = eq.insert(100, nullptr);
+  TEST_ASSERT_EQUAL(stale.index, reused.index);
+  TEST_ASSERT_FALSE(eq.cancel(stale));
+  TEST_ASSERT_TRUE(eq.pending(reused));
+}
+
+// Average time of rescheduling a task (by ID) in a queue holding num_tasks tasks.
+double rescheduleNsec(unsigned num_tasks) {
+  constexpr unsigned kNumOps = 200000;
+  og3::TaskQueue eq(num_tasks);
+  std::mt19937 gen32;
+  for (unsigned id = 1; id <= num_tasks; id++) {
+    eq.insertReplace(gen32() % 100000, nullptr, id);
+  }
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < kNumOps; i++) {
+    eq.insertReplace(gen32() % 100000, nullptr, 1 + gen32() % num_tasks);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / kNumOps;
+}
+
+// Rescheduling with 1024 tasks queued should cost O(log N), not O(N): Tasks does this with
+//  interrupts disabled, so the critical section must stay short as the queue grows.
+void test_eq1024() {
+  // A linear walk would be ~32x slower with 1024 tasks; the heap should be ~2x
+  //  (log2(1024) / log2(32)). The times depend on the load of the machine running the
+  //  test, so they are printed rather than checked.
+  const double small_nsec = rescheduleNsec(32);
+  const double large_nsec = rescheduleNsec(1024);
+  printf("reschedule: %.1f nsec with 32 tasks, %.1f nsec with 1024 tasks\n", small_nsec,
+         large_nsec);
+
+  og3::TaskQueue eq(1024);
+  for (unsigned id = 1; id <= 1024; id++) {
+    eq.insertReplace((id * 7919) % 1024, nullptr, id);
+  }
+  TEST_ASSERT_TRUE(eq.full());
+  for (unsigned long msec = 0; msec < 1024; msec++) {
+    TEST_ASSERT_EQUAL(msec, eq.first().msec);
+    eq.popFirst();
+  }
+  TEST_ASSERT_TRUE(eq.empty());
+}
+
 int runUnityTests() {
   UNITY_BEGIN();
   RUN_TEST(test_eq1);
@@ -280,6 +511,12 @@ int runUnityTests() {
   RUN_TEST(test_eq3);
   RUN_TEST(test_eq4);
   RUN_TEST(test_eq20);
+  RUN_TEST(test_eq_ids);
+  RUN_TEST(test_eq_fifo);
+  RUN_TEST(test_eq_periodic);
+  RUN_TEST(test_eq_periodic_changed_in_callback);
+  RUN_TEST(test_eq_handles);
+  RUN_TEST(test_eq1024);
   return UNITY_END();
 }
 
@@ -0,0 +1,170 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include "og3/task_stats.h"
+
+#include <cstring>
+
+#include "og3/app.h"
+#include "og3/log_histogram.h"
+#include "unity.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+
+unsigned valueOf(const og3::VariableGroup& vg, const char* name) {
+  for (const og3::VariableBase* var : vg.variables()) {
+    if (0 == strcmp(var->name(), name)) {
+      return static_cast<unsigned>(var->string().toInt());
+    }
+  }
+  TEST_FAIL_MESSAGE(name);
+  return 0;
+}
+
+}  // namespace
+
+void test_buckets() {
+  TEST_ASSERT_EQUAL(0, og3::LogHistogram::bucketFor(0));
+  TEST_ASSERT_EQUAL(1, og3::LogHistogram::bucketFor(1));
+  TEST_ASSERT_EQUAL(2, og3::LogHistogram::bucketFor(2));
+  TEST_ASSERT_EQUAL(2, og3::LogHistogram::bucketFor(3));
+  TEST_ASSERT_EQUAL(3, og3::LogHistogram::bucketFor(4));
+  TEST_ASSERT_EQUAL(10, og3::LogHistogram::bucketFor(1000));
+  TEST_ASSERT_EQUAL(og3::LogHistogram::kNumBuckets - 1, og3::LogHistogram::bucketFor(UINT32_MAX));
+  TEST_ASSERT_EQUAL(0, og3::LogHistogram::bucketMax(0));
+  TEST_ASSERT_EQUAL(1, og3::LogHistogram::bucketMax(1));
+  TEST_ASSERT_EQUAL(1023, og3::LogHistogram::bucketMax(10));
+}
+
+void test_percentiles() {
+  og3::LogHistogram hist;
+  TEST_ASSERT_EQUAL(0, hist.percentile(50));
+
+  // 98 fast values, and 2 slow outliers.
+  for (int i = 0; i < 98; i++) {
+    hist.add(100);
+  }
+  hist.add(5000);
+  hist.add(20000);
+  TEST_ASSERT_EQUAL(100, hist.count());
+  TEST_ASSERT_EQUAL(20000, hist.max());
+  // 100 is in the bucket [64, 127].
+  TEST_ASSERT_EQUAL(127, hist.percentile(50));
+  TEST_ASSERT_EQUAL(127, hist.percentile(98));
+  // 5000 is in the bucket [4096, 8191].
+  TEST_ASSERT_EQUAL(8191, hist.percentile(99));
+  // The top bucket bound is clamped to the largest value seen.
+  TEST_ASSERT_EQUAL(20000, hist.percentile(100));
+
+  hist.reset();
+  TEST_ASSERT_EQUAL(0, hist.count());
+  TEST_ASSERT_EQUAL(0, hist.max());
+  hist.add(0);
+  TEST_ASSERT_EQUAL(0, hist.percentile(99));
+}
+
+void test_saturation() {
+  og3::LogHistogram hist;
+  for (unsigned i = 0; i < 100000; i++) {
+    hist.add(i % 4 == 0 ? 1000 : 10);
+  }
+  // Counts were halved rather than overflowing, keeping the 3:1 ratio.
+  TEST_ASSERT_LESS_THAN(100000, hist.count());
+  const unsigned slow = hist.bucketCount(og3::LogHistogram::bucketFor(1000));
+  const unsigned fast = hist.bucketCount(og3::LogHistogram::bucketFor(10));
+  TEST_ASSERT_EQUAL(hist.count(), slow + fast);
+  TEST_ASSERT_UINT_WITHIN(fast / 50, 3 * slow, fast);
+  TEST_ASSERT_EQUAL(15, hist.percentile(50));
+  TEST_ASSERT_EQUAL(1000, hist.percentile(99));
+}
+
+void test_task_stats() {
+  og3::TaskStats stats;
+  for (int i = 0; i < 100; i++) {
+    stats.record(201, 0, 40);
+    stats.record(202, i < 90 ? 1 : 30, 2000);
+  }
+  stats.record(0, 5, 100000);
+
+  TEST_ASSERT_EQUAL(3, stats.numEntries());
+  TEST_ASSERT_EQUAL(201, stats.runtime().count());
+  const og3::TaskStats::Entry* entry = stats.find(202);
+  TEST_ASSERT_NOT_NULL(entry);
+  TEST_ASSERT_EQUAL(100, entry->run_usec.count());
+  TEST_ASSERT_EQUAL(1, entry->lateness_msec.percentile(50));
+  TEST_ASSERT_EQUAL(30, entry->lateness_msec.percentile(99));
+  TEST_ASSERT_NULL(stats.find(203));
+
+  stats.update();
+  const og3::VariableGroup& vg = stats.variables();
+  TEST_ASSERT_EQUAL(1, valueOf(vg, "lateP50"));
+  TEST_ASSERT_EQUAL(30, valueOf(vg, "lateMax"));
+  TEST_ASSERT_EQUAL(2047, valueOf(vg, "runP99"));
+  TEST_ASSERT_EQUAL(100000, valueOf(vg, "runMax"));
+  TEST_ASSERT_EQUAL(0, valueOf(vg, "slowestTaskId"));
+  TEST_ASSERT_EQUAL(100000, valueOf(vg, "slowestTaskMax"));
+
+  // IDs beyond the table are only counted overall.
+  constexpr unsigned kMax = og3::TaskStats::kDefaultMaxTaskIds;
+  for (unsigned id = 1000; id < 1000 + kMax; id++) {
+    stats.record(id, 0, 1);
+  }
+  TEST_ASSERT_EQUAL(kMax, stats.numEntries());
+  TEST_ASSERT_EQUAL(201 + kMax, stats.runtime().count());
+  TEST_ASSERT_NOT_NULL(stats.find(1000 + kMax - 4));
+  TEST_ASSERT_NULL(stats.find(1000 + kMax - 3));
+
+  stats.reset();
+  TEST_ASSERT_EQUAL(0, stats.numEntries());
+  TEST_ASSERT_EQUAL(0, valueOf(vg, "runMax"));
+}
+
+void test_many_tasks() {
+  // Tasks sizes its statistics to track every task it can hold.
+  constexpr unsigned kNumTasks = 200;
+  og3::TaskStats stats("tasks", kNumTasks + 1);
+  TEST_ASSERT_EQUAL(kNumTasks + 1, stats.maxTaskIds());
+  for (int round = 0; round < 3; round++) {
+    for (unsigned id = 1; id <= kNumTasks; id++) {
+      stats.record(id, 0, id);
+    }
+  }
+  TEST_ASSERT_EQUAL(kNumTasks, stats.numEntries());
+  for (unsigned id = 1; id <= kNumTasks; id++) {
+    const og3::TaskStats::Entry* entry = stats.find(id);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(id, entry->id);
+    TEST_ASSERT_EQUAL(3, entry->run_usec.count());
+  }
+  stats.update();
+  TEST_ASSERT_EQUAL(kNumTasks, valueOf(stats.variables(), "slowestTaskId"));
+
+#ifdef OG3_TASK_STATS
+  og3::App app(og3::App::Options().withReserveTasks(kNumTasks));
+  TEST_ASSERT_EQUAL(kNumTasks + 1, app.tasks().stats().maxTaskIds());
+#endif
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_buckets);
+  RUN_TEST(test_percentiles);
+  RUN_TEST(test_saturation);
+  RUN_TEST(test_task_stats);
+  RUN_TEST(test_many_tasks);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
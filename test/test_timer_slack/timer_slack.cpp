@@ -0,0 +1,191 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include <cstdio>
+
+#include "og3/constants.h"
+#include "og3/task_queue.h"
+#include "unity.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+
+using og3::kMsecInMin;
+using og3::kMsecInSec;
+
+// Runs all tasks due at or before now, as Tasks::loop() does.
+void runDue(og3::TaskQueue* queue, unsigned long now) {
+  while (!queue->empty() && og3::isBefore(queue->first().msec, now)) {
+    og3::TimedThunk task;
+    og3::TaskQueue::Loan loan;
+    queue->takeFirst(now, &task, &loan);
+    if (task.thunk) {
+      task.thunk();
+    }
+    queue->giveBack(loan, &task.thunk);
+  }
+}
+
+// Simulates the scheduling of a typical HAApp for an hour on a simulated clock,
+// and counts the loop wakeups.
+class HAAppSim {
+ public:
+  explicit HAAppSim(bool use_slack) : m_queue(32), m_slack(use_slack) {
+    // AppStatus: reads every 2 s and publishes every 10 min, rescheduling itself each time.
+    m_queue.insert(1, [this]() { read(); }, m_read_id);
+    m_queue.insert(20 * kMsecInSec, [this]() { mqttSend(); }, m_send_id);
+    // WifiMonitor: polls RSSI every minute.
+    periodic(10 * kMsecInSec, kMsecInMin, 5 * kMsecInSec);
+    // Sensors read every 1 to 5 s, and a watchdog.
+    periodic(137, 1 * kMsecInSec, 100);
+    periodic(411, 3 * kMsecInSec, 300);
+    periodic(873, 5 * kMsecInSec, 500);
+    periodic(2500, 30 * kMsecInSec, 3 * kMsecInSec);
+  }
+
+  unsigned long wakeupsPerHour() {
+    unsigned long wakeups = 0;
+    while (og3::isBefore(m_queue.first().msec, og3::kMsecInHour)) {
+      m_now = m_queue.first().msec;
+      runDue(&m_queue, m_now);
+      wakeups += 1;
+    }
+    return wakeups;
+  }
+  unsigned long runs() const { return m_runs; }
+
+ private:
+  void periodic(unsigned long msec, unsigned long period, unsigned long slack) {
+    m_queue.insertPeriodic(msec, period, [this]() { m_runs += 1; }, m_queue.getId(),
+                           og3::MissedTicks::kSkip, m_slack ? slack : 0);
+  }
+  void read() {
+    m_runs += 1;
+    m_queue.insert(m_now + 2 * kMsecInSec, [this]() { read(); }, m_read_id, m_slack ? 250 : 0);
+  }
+  void mqttSend() {
+    m_runs += 1;
+    m_queue.insert(m_now + 10 * kMsecInMin, [this]() { mqttSend(); }, m_send_id,
+                   m_slack ? 5 * kMsecInSec : 0);
+  }
+
+  og3::TaskQueue m_queue;
+  const bool m_slack;
+  const unsigned m_read_id = m_queue.getId();
+  const unsigned m_send_id = m_queue.getId();
+  unsigned long m_now = 0;
+  unsigned long m_runs = 0;
+};
+
+}  // namespace
+
+void test_no_slack() {
+  og3::TaskQueue queue(4);
+  TEST_ASSERT_EQUAL(1003, queue.coalesce(1003, 0));
+  queue.insert(1003, nullptr);
+  TEST_ASSERT_EQUAL(1003, queue.first().msec);
+}
+
+void test_keep_time() {
+  og3::TaskQueue queue(4);
+  // With nothing else in the window, a task keeps its own time.
+  TEST_ASSERT_EQUAL(1003, queue.coalesce(1003, 100));
+  queue.insert(1003, nullptr, 0, 100);
+  TEST_ASSERT_EQUAL(1003, queue.first().msec);
+  // A second task whose window covers the first one joins it.
+  queue.insert(990, nullptr, 0, 50);
+  TEST_ASSERT_EQUAL(1003, queue.thunk(0).msec);
+  TEST_ASSERT_EQUAL(1003, queue.thunk(1).msec);
+  // Across a wrap of millis().
+  const unsigned long near_wrap = static_cast<unsigned long>(-10);
+  queue.insert(near_wrap + 5, nullptr);
+  TEST_ASSERT_EQUAL(near_wrap + 5, queue.coalesce(near_wrap, 20));
+}
+
+void test_join_queued() {
+  og3::TaskQueue queue(8);
+  queue.insert(500, nullptr);
+  queue.insert(1100, nullptr);
+  queue.insert(1050, nullptr);
+  // A queued task in the window is joined.
+  TEST_ASSERT_EQUAL(1050, queue.coalesce(1000, 200));
+  // A task outside the window is not.
+  TEST_ASSERT_EQUAL(1000, queue.coalesce(1000, 40));
+  TEST_ASSERT_EQUAL(470, queue.coalesce(470, 20));
+  // Nor is a task before the window.
+  TEST_ASSERT_EQUAL(510, queue.coalesce(510, 30));
+}
+
+void test_bounded_search() {
+  constexpr unsigned kNumTasks = 1000;
+  og3::TaskQueue queue(kNumTasks + 1);
+  // Many tasks which are already due, and many far in the future.
+  for (unsigned i = 0; i < kNumTasks / 2; i++) {
+    queue.insert(i, nullptr);
+    queue.insert(100000 + i, nullptr);
+  }
+  // The search gives up after a bounded number of steps, keeping the task's time.
+  TEST_ASSERT_EQUAL(5000, queue.coalesce(5000, 50000));
+  TEST_ASSERT_EQUAL(og3::TaskQueue::kMaxCoalesceSteps, queue.coalesceSteps());
+  // Inserting with slack into the full-sized queue is bounded the same way.
+  queue.insert(5000, nullptr, 0, 50000);
+  TEST_ASSERT_TRUE(queue.coalesceSteps() <= og3::TaskQueue::kMaxCoalesceSteps);
+
+  // Once the due tasks have run, a task in the window is found in a few steps.
+  for (unsigned i = 0; i < kNumTasks / 2 + 1; i++) {
+    queue.popFirst();
+  }
+  queue.insert(20000, nullptr);
+  TEST_ASSERT_EQUAL(20000, queue.coalesce(10000, 50000));
+  TEST_ASSERT_TRUE(queue.coalesceSteps() <= 3);
+}
+
+void test_periodic_no_drift() {
+  og3::TaskQueue queue(4);
+  int count = 0;
+  queue.insertPeriodic(1003, 1000, [&count]() { count++; }, 0, og3::MissedTicks::kSkip, 100);
+  for (int i = 0; i < 5; i++) {
+    const unsigned long msec = queue.first().msec;
+    // Each run is within the slack of its nominal time.
+    TEST_ASSERT_TRUE(og3::isBefore(1003 + 1000 * i, msec));
+    TEST_ASSERT_TRUE(og3::isBefore(msec, 1003 + 1000 * i + 100));
+    runDue(&queue, msec);
+  }
+  TEST_ASSERT_EQUAL(5, count);
+}
+
+void test_wakeups_per_hour() {
+  HAAppSim exact(false);
+  const unsigned long exact_wakeups = exact.wakeupsPerHour();
+  HAAppSim slack(true);
+  const unsigned long slack_wakeups = slack.wakeupsPerHour();
+  printf("HAApp task mix: %lu wakeups/hour without slack (%lu runs), %lu with slack (%lu runs)\n",
+         exact_wakeups, exact.runs(), slack_wakeups, slack.runs());
+  // Roughly the same work is done in fewer wakeups.
+  TEST_ASSERT_UINT_WITHIN(exact.runs() / 50, exact.runs(), slack.runs());
+  TEST_ASSERT_LESS_THAN(exact_wakeups * 3 / 4, slack_wakeups);
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_no_slack);
+  RUN_TEST(test_keep_time);
+  RUN_TEST(test_join_queued);
+  RUN_TEST(test_bounded_search);
+  RUN_TEST(test_periodic_no_drift);
+  RUN_TEST(test_wakeups_per_hour);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -0,0 +1,150 @@
+// Copyright (c) 2026 Chris Lee and contibuters.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+
+#include <ArduinoFake.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include "og3/html_table.h"
+#include "og3/loop_stats.h"
+#include "og3/module_profile.h"
+#include "og3/task_stats.h"
+#include "og3/text_buffer.h"
+#include "og3/variable.h"
+#include "unity.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+
+enum class Mode { kOff, kOn };
+const char* s_mode_names[] = {"off", "on"};
+
+enum Descriptor : uint16_t { kTemperature, kCount, kEnabled, kMode, kNumDescriptors };
+
+const og3::VariableDescriptor s_descriptors[] PROGMEM = {
+    {"temp", "°C", "temperature", 0, 1},
+    {"count", nullptr, "event count", og3::VariableBase::kConfig | og3::VariableBase::kSettable,
+     0},
+    {"enabled", nullptr, nullptr, og3::VariableBase::kNoPublish, 0},
+    {"mode", nullptr, "operating mode", 0, 0},
+};
+static_assert(std::size(s_descriptors) == kNumDescriptors, "one descriptor per index");
+
+// The layout of a variable before descriptors: metadata pointers and flags in each object.
+struct OldVariableBase {
+  virtual ~OldVariableBase() = default;
+  const char* name;
+  const char* units;
+  const char* description;
+  unsigned flags;
+  const og3::VariableGroup* group;
+  bool failed;
+  uint16_t index;
+  uint16_t version;
+};
+struct OldFloatVariableBase : public OldVariableBase {
+  unsigned decimals;
+};
+template <typename T, typename Base = OldVariableBase>
+struct OldVariable : public Base {
+  T value;
+};
+
+}  // namespace
+
+void test_table() {
+  og3::VariableGroup vg("table", s_descriptors);
+  og3::FloatVariable temp(kTemperature, 21.46f, vg);
+  og3::Variable<unsigned> count(kCount, 3, vg);
+  og3::BoolVariable enabled(kEnabled, true, vg);
+  og3::EnumStrVariable<Mode> mode(kMode, Mode::kOn, Mode::kOn, s_mode_names, vg);
+  // A variable constructed the usual way joins the same group.
+  og3::Variable<int> extra("extra", -1, "", "", 0, vg);
+
+  TEST_ASSERT_EQUAL(kNumDescriptors, vg.table_size());
+  // Indices past the end of the table are caught when a variable is constructed.
+  TEST_ASSERT_TRUE(vg.hasDescriptor(kMode));
+  TEST_ASSERT_FALSE(vg.hasDescriptor(kNumDescriptors));
+  TEST_ASSERT_EQUAL_STRING("temp", temp.name());
+  TEST_ASSERT_EQUAL_STRING("°C", temp.units());
+  TEST_ASSERT_EQUAL(1, temp.decimals());
+  TEST_ASSERT_EQUAL_STRING("21.5", temp.string().c_str());
+  TEST_ASSERT_EQUAL_STRING("event count", count.human_str());
+  TEST_ASSERT_TRUE(count.config());
+  TEST_ASSERT_TRUE(count.settable());
+  TEST_ASSERT_EQUAL_STRING("enabled", enabled.human_str());
+  TEST_ASSERT_TRUE(enabled.noPublish());
+  TEST_ASSERT_EQUAL_STRING("extra", extra.name());
+  TEST_ASSERT_EQUAL(1, vg.num_config());
+
+  TEST_ASSERT_EQUAL_PTR(&mode, vg.find("mode"));
+  TEST_ASSERT_EQUAL_PTR(&extra, vg.find("extra"));
+  TEST_ASSERT_TRUE(mode.fromString("off"));
+  TEST_ASSERT_EQUAL(Mode::kOff, mode.value());
+
+  og3::TextBuffer<128> text;
+  TEST_ASSERT_TRUE(vg.writeJson(&text, og3::VariableBase::kNoPublish));
+  // count is a config variable, so it is left out without kConfig.
+  TEST_ASSERT_EQUAL_STRING("{\"temp\":21.5,\"mode\":\"off\",\"extra\":-1}", text.text());
+
+  String html;
+  og3::html::writeTableInto(&html, vg);
+  TEST_ASSERT_NOT_NULL(strstr(html.c_str(), "temperature"));
+  TEST_ASSERT_NOT_NULL(strstr(html.c_str(), "21.5"));
+}
+
+// The library's own statistics groups are described by flash tables.
+void test_library_groups() {
+  og3::LoopStats loop_stats("loop");
+  og3::TaskStats task_stats("tasks");
+  og3::ModuleProfile module_profile("modules");
+  for (const og3::VariableGroup* vg :
+       {&loop_stats.variables(), &task_stats.variables(), &module_profile.variables()}) {
+    TEST_ASSERT_EQUAL(vg->table_size(), vg->variables().size());
+  }
+  TEST_ASSERT_EQUAL_STRING("loopRate", loop_stats.variables().variables()[0]->name());
+  TEST_ASSERT_EQUAL(1, static_cast<const og3::FloatVariable*>(
+                           loop_stats.variables().variables()[0])->decimals());
+}
+
+// Reports the RAM used for each variable, including its descriptor, before descriptors,
+//  when constructed with strings, and when described by a flash table.
+void test_size_report() {
+  // Without a table, each variable adds a descriptor to its group's RAM table.
+  constexpr size_t kRamDescriptor = sizeof(og3::VariableDescriptor);
+  printf("%-16s %8s %8s %8s\n", "bytes/variable", "before", "strings", "table");
+  const auto report = [](const char* type, size_t before, size_t object) {
+    printf("%-16s %8zu %8zu %8zu\n", type, before, object + kRamDescriptor, object);
+    TEST_ASSERT_TRUE(object + kRamDescriptor <= before);
+    TEST_ASSERT_LESS_THAN(before, object);
+  };
+  report("Variable<int>", sizeof(OldVariable<int>), sizeof(og3::Variable<int>));
+  report("Variable<bool>", sizeof(OldVariable<bool>), sizeof(og3::BoolVariable));
+  report("FloatVariable", sizeof(OldVariable<float, OldFloatVariableBase>),
+         sizeof(og3::FloatVariable));
+  report("DoubleVariable", sizeof(OldVariable<double, OldFloatVariableBase>),
+         sizeof(og3::DoubleVariable));
+}
+
+int runUnityTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_table);
+  RUN_TEST(test_library_groups);
+  RUN_TEST(test_size_report);
+  return UNITY_END();
+}
+
+// For native platform.
+int main() { return runUnityTests(); }
+
+// For arduion framework
+void setup() {}
+void loop() {}
+
+// For ESP-IDF framework
+void app_main() { runUnityTests(); }
@@ -123,6 +123,127 @@ void test_html_table() {
 #endif
 }
 
+void test_changed() {
+  og3::VariableGroup vg("changes");
+  og3::Variable<int> ival("ival", 1, "", "integer", 0, vg);
+  og3::FloatVariable fval("fval", 1.0, "", "float", 0, 2, vg);
+  og3::BoolVariable bval("bval", false, "bool", 0, vg);
+  TEST_ASSERT_EQUAL(1, fval.index());
+  // New variables are marked as changed, so they get published once.
+  TEST_ASSERT_TRUE(vg.changed());
+  TEST_ASSERT_TRUE(vg.changed(1));
+  vg.clearChanged();
+  TEST_ASSERT_FALSE(vg.changed());
+
+  // Assigning the same value is not a change.
+  ival = 1;
+  fval = 1.0;
+  bval = false;
+  TEST_ASSERT_EQUAL(0, ival.version());
+  TEST_ASSERT_FALSE(vg.changed());
+
+  fval = 2.5;
+  TEST_ASSERT_EQUAL(1, fval.version());
+  TEST_ASSERT_TRUE(vg.changed());
+  TEST_ASSERT_FALSE(vg.changed(0));
+  TEST_ASSERT_TRUE(vg.changed(1));
+  TEST_ASSERT_FALSE(vg.changed(2));
+
+  JsonDocument doc;
+  vg.toJson(doc.to<JsonObject>(), 0, true);
+  TEST_ASSERT_EQUAL(1, doc.size());
+  TEST_ASSERT_FALSE(doc["fval"].isNull());
+  TEST_ASSERT_TRUE(doc["ival"].isNull());
+
+  vg.clearChanged();
+  ival.setFailed();
+  TEST_ASSERT_TRUE(vg.changed(0));
+  vg.clearChanged();
+  ival.setFailed();
+  TEST_ASSERT_FALSE(vg.changed());
+  ival.fromString("3");
+  TEST_ASSERT_TRUE(vg.changed(0));
+  TEST_ASSERT_EQUAL(3, ival.version());  // Healthy again, and a new value.
+
+  // Parsing or reading JSON for the current values is not a change either, so a config
+  // reload or a repeated command does not republish the group.
+  enum class Mode { kOff, kOn };
+  const char* mode_names[] = {"off", "on"};
+  og3::Variable<String> sval("sval", String("a"), "", "string", 0, vg);
+  og3::EnumStrVariable<Mode> mode("mode", Mode::kOn, "", Mode::kOn, mode_names, 0, vg);
+  vg.clearChanged();
+  TEST_ASSERT_TRUE(ival.fromString("3"));
+  TEST_ASSERT_TRUE(fval.fromString("2.5"));
+  TEST_ASSERT_TRUE(bval.fromString("off"));
+  TEST_ASSERT_TRUE(sval.fromString("a"));
+  TEST_ASSERT_TRUE(mode.fromString("on"));
+  JsonDocument same;
+  TEST_ASSERT_FALSE(
+      deserializeJson(same, "{\"ival\":3,\"fval\":2.5,\"bval\":false,\"sval\":\"a\",\"mode\":1}"));
+  for (og3::VariableBase* var : vg.variables()) {
+    TEST_ASSERT_TRUE(var->fromJson(same[var->name()]));
+  }
+  TEST_ASSERT_FALSE(vg.changed());
+  TEST_ASSERT_TRUE(bval.fromString("on"));
+  TEST_ASSERT_TRUE(vg.changed(2));
+  TEST_ASSERT_EQUAL(1, bval.version());
+}
+
+void test_changed_to_publish() {
+  constexpr unsigned kFlags = og3::VariableBase::kNoPublish;
+  og3::VariableGroup vg("publish");
+  og3::Variable<int> ival("ival", 1, "", "integer", 0, vg);
+  og3::Variable<int> hidden("hidden", 1, "", "integer", og3::VariableBase::kNoPublish, vg);
+  og3::Variable<int> cval("cval", 1, "", "config", og3::VariableBase::kConfig, vg);
+  vg.clearChanged();
+
+  // Changes to variables which the flags leave out are not published, and stay marked.
+  hidden = 2;
+  cval = 2;
+  TEST_ASSERT_FALSE(vg.changedToPublish(kFlags));
+  TEST_ASSERT_TRUE(vg.changedToPublish(0));
+  TEST_ASSERT_TRUE(vg.changedToPublish(og3::VariableBase::kConfig));
+  ival = 2;
+  TEST_ASSERT_TRUE(vg.changedToPublish(kFlags));
+  vg.clearChanged(kFlags);
+  TEST_ASSERT_FALSE(vg.changed(0));
+  TEST_ASSERT_TRUE(vg.changed(1));
+  TEST_ASSERT_TRUE(vg.changed(2));
+
+  // A failed variable is not written, so its failure alone is not published.
+  vg.clearChanged();
+  ival.setFailed();
+  TEST_ASSERT_TRUE(vg.changed());
+  TEST_ASSERT_FALSE(vg.changedToPublish(kFlags));
+}
+
+void test_find() {
+  og3::VariableGroup vg("lookup");
+  og3::Variable<int> ival("ival", 1, "", "integer", og3::VariableBase::kSettable, vg);
+  og3::FloatVariable fval("fval", 1.0, "", "float", og3::VariableBase::kSettable, 2, vg);
+  og3::Variable<String> sval("sval", String("a"), "", "string", 0, vg);
+  TEST_ASSERT_EQUAL_PTR(&ival, vg.find("ival"));
+  TEST_ASSERT_EQUAL_PTR(&sval, vg.find("sval"));
+  TEST_ASSERT_NULL(vg.find("bval"));
+  TEST_ASSERT_NULL(vg.find(""));
+  TEST_ASSERT_EQUAL(2, vg.num_settable());
+
+  // Variables added after a lookup are found too.
+  og3::BoolVariable bval("bval", false, "bool", og3::VariableBase::kSettable, vg);
+  TEST_ASSERT_EQUAL_PTR(&bval, vg.find("bval"));
+  TEST_ASSERT_EQUAL_PTR(&fval, vg.find("fval"));
+
+  // Only keys naming settable variables are applied.
+  JsonDocument doc;
+  doc["fval"] = 2.5;
+  doc["sval"] = "b";
+  doc["other"] = 3;
+  TEST_ASSERT_EQUAL(1, vg.updateFromJson(doc.as<JsonObjectConst>()));
+  TEST_ASSERT_EQUAL_FLOAT(2.5, fval.value());
+  TEST_ASSERT_EQUAL_STRING("a", sval.value().c_str());
+  TEST_ASSERT_EQUAL(1, ival.value());
+}
+
 int runUnityTests() {
   UNITY_BEGIN();
   RUN_TEST(test_int_vars);
@@ -132,6 +253,9 @@ int runUnityTests() {
   RUN_TEST(test_string_vars);
   RUN_TEST(test_bool_vars);
   RUN_TEST(test_html_table);
+  RUN_TEST(test_changed);
+  RUN_TEST(test_changed_to_publish);
+  RUN_TEST(test_find);
   return UNITY_END();
 }
 